@@ -0,0 +1,569 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+
+#include <TBS/TBS.hpp>
+
+using namespace TBS;
+
+/*
+	Every benchmark reports bytes_per_second, run with
+	--benchmark_out=<file>.json --benchmark_out_format=json
+	& compare runs through compare.py
+*/
+
+constexpr size_t DATA_SIZE = 16 * 1024 * 1024;
+
+enum class Distribution {
+	Random,
+	Zeros,	// Zero pages, a few scattered bytes
+	Code	// x86 code, our own executable when readable
+};
+
+static const char* DistributionName(Distribution distribution)
+{
+	switch (distribution)
+	{
+	case Distribution::Zeros: return "Zeros";
+	case Distribution::Code: return "Code";
+	default: return "Random";
+	}
+}
+
+static Vector<UByte> MakeData(Distribution distribution)
+{
+	Vector<UByte> data(DATA_SIZE, 0);
+	std::mt19937 gen(0x7B5);
+
+	switch (distribution)
+	{
+	case Distribution::Random:
+		for (auto& byte : data)
+			byte = UByte(gen());
+		break;
+
+	case Distribution::Zeros:
+		for (size_t i = 0; i < DATA_SIZE; i += 4096)
+			data[i + gen() % 4096] = UByte(gen());
+		break;
+
+	case Distribution::Code:
+	{
+		std::ifstream self("/proc/self/exe", std::ios::binary);
+		Vector<UByte> code((std::istreambuf_iterator<char>(self)), std::istreambuf_iterator<char>());
+
+		if (code.size() < 4096)
+		{
+			// At this point, no executable to read, typical prologues & epilogues with random immediates
+
+			static const UByte snippets[] = {
+				0x48, 0x89, 0x5C, 0x24, 0x08, 0x57, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xF9,
+				0x48, 0x8B, 0x05, 0x00, 0x00, 0x00, 0x00, 0x48, 0x85, 0xC0, 0x74, 0x00,
+				0xE8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x83, 0xC4, 0x20, 0x5F, 0xC3, 0xCC, 0xCC,
+			};
+
+			code.assign(snippets, snippets + sizeof(snippets));
+
+			for (size_t i = 0; i < 4096; i++)
+			{
+				code.push_back(snippets[gen() % sizeof(snippets)]);
+				code.push_back(UByte(gen()));
+			}
+		}
+
+		for (size_t i = 0; i < DATA_SIZE; i++)
+			data[i] = code[i % code.size()];
+		break;
+	}
+	}
+
+	return data;
+}
+
+static const Vector<UByte>& Data(Distribution distribution)
+{
+	static const Vector<UByte> datas[] = {
+		MakeData(Distribution::Random),
+		MakeData(Distribution::Zeros),
+		MakeData(Distribution::Code),
+	};
+
+	return datas[(size_t)distribution];
+}
+
+struct Shape {
+	const char* mName;
+	const char* mPattern;
+};
+
+static const Shape SHAPES[] = {
+	{ "Short", "48 8B 05" },
+	{ "Long", "48 89 5C 24 08 48 89 74 24 10 57 48 83 EC 20 48 8B F9 48 8B 0D ?? ?? ?? ?? 48 85 C9 74 ?? E8" },
+	{ "LeadingWildcards", "?? ?? ?? ?? 48 8D 0D ?? ?? ?? ??" },
+	{ "Nibbles", "4? 8B ?D ?? ?? ?? ?? E8" },
+	{ "CommonAnchors", "00 00 00 00 00 00 00 01" },
+};
+
+static const Kernel KERNELS[] = { Kernel::Scalar, Kernel::Platform, Kernel::SSE2, Kernel::AVX2 };
+
+/*
+	Forces `kernel` for the benchmark scope, patterns must be parsed within it
+*/
+struct ScopedKernel {
+	inline ScopedKernel(Kernel kernel)
+	{
+		SetKernel(kernel);
+	}
+
+	inline ~ScopedKernel()
+	{
+		SetKernel(Kernel::Auto);
+	}
+};
+
+/*
+	`count` 12 byte signatures cut out of code, some bytes wildcarded, all present.
+	Padding & tables are skipped, real signatures are rarely that repetitive
+*/
+static Vector<String<>> MakeSignatures(size_t count)
+{
+	const Vector<UByte>& code = Data(Distribution::Code);
+	std::mt19937 gen(0x51C);
+	Vector<String<>> signatures;
+
+	while (signatures.size() < count)
+	{
+		const size_t at = gen() % (DATA_SIZE - 12);
+		std::unordered_set<UByte> distinct(code.begin() + at, code.begin() + at + 12);
+
+		if (distinct.size() < 8)
+			continue;
+
+		String<> signature;
+
+		for (size_t k = 0; k < 12; k++)
+		{
+			char byteStr[4];
+			snprintf(byteStr, sizeof(byteStr), "%02X", code[at + k]);
+
+			if (k)
+				signature += " ";
+
+			signature += (k % 5 == 3) ? "??" : byteStr;
+		}
+
+		signatures.push_back(signature);
+	}
+
+	return signatures;
+}
+
+static void BM_Compare(benchmark::State& bench, Kernel kernel, size_t len)
+{
+	ScopedKernel scoped(kernel);
+
+	const Vector<UByte>& data = Data(Distribution::Random);
+	Vector<UByte> mask(len, 0xFF);
+
+	for (size_t i = 0; i < len; i += 7)
+		mask[i] = 0x00;
+
+	for (auto _ : bench)
+		benchmark::DoNotOptimize(Compare(data.data(), data.data(), len, mask.data()));
+
+	bench.SetBytesProcessed(bench.iterations() * len);
+}
+
+static void BM_SearchFirst(benchmark::State& bench, Kernel kernel, Distribution distribution)
+{
+	ScopedKernel scoped(kernel);
+
+	const Vector<UByte>& data = Data(distribution);
+	const UByte* end = data.data() + data.size();
+	size_t found = 0;
+
+	// 0xF4 (hlt) is rare everywhere, so this mostly measures the sweep
+
+	for (auto _ : bench)
+	{
+		for (const UByte* at = data.data(); (at = SearchFirst(at, end, 0xF4)) != nullptr; at++)
+			found++;
+	}
+
+	benchmark::DoNotOptimize(found);
+	bench.SetBytesProcessed(bench.iterations() * data.size());
+}
+
+static void BM_LightScan(benchmark::State& bench, Kernel kernel, Distribution distribution, const Shape& shape)
+{
+	ScopedKernel scoped(kernel);
+
+	const Vector<UByte>& data = Data(distribution);
+	Pattern::ParseResult parsed;
+	Pattern::Parse(shape.mPattern, parsed);
+
+	for (auto _ : bench)
+	{
+		Pattern::Results results;
+		Light::Scan(data.data(), data.data() + data.size(), results, parsed);
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * data.size());
+}
+
+/*
+	`count` signatures through a State, one multi-pattern pass or one pass each
+*/
+static void BM_StateScan(benchmark::State& bench, size_t count, bool bMultiPattern)
+{
+	const Vector<UByte>& data = Data(Distribution::Code);
+	const Vector<String<>> signatures = MakeSignatures(count);
+
+	for (auto _ : bench)
+	{
+		TBS::State<> state(data.data(), data.data() + data.size());
+		state.setMultiPattern(bMultiPattern);
+
+		for (const auto& signature : signatures)
+			state.AddPattern(state.PatternBuilder().setUID(signature).setPattern(signature).Build());
+
+		benchmark::DoNotOptimize(Scan(state));
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * data.size());
+}
+
+constexpr size_t PARSE_SIGNATURES = 20000;
+
+/*
+	Signatures parsed per second, into a single reused result
+*/
+static void BM_Parse(benchmark::State& bench)
+{
+	const Vector<String<>> signatures = MakeSignatures(PARSE_SIGNATURES);
+	Pattern::ParseResult parsed;
+
+	for (auto _ : bench)
+	{
+		for (const auto& signature : signatures)
+			benchmark::DoNotOptimize(Pattern::Parse(signature, parsed));
+	}
+
+	bench.SetItemsProcessed(bench.iterations() * signatures.size());
+}
+
+/*
+	A whole signature database into a State, one builder per pattern or in bulk
+*/
+static void BM_LoadSignatures(benchmark::State& bench, bool bBulk)
+{
+	const Vector<String<>> signatures = MakeSignatures(PARSE_SIGNATURES);
+	const Vector<UByte>& data = Data(Distribution::Code);
+	Vector<Pattern::Source> sources;
+
+	for (const auto& signature : signatures)
+		sources.push_back(Pattern::Source{ StringView(), signature });
+
+	for (auto _ : bench)
+	{
+		TBS::State<> state(data.data(), data.data() + data.size());
+
+		if (bBulk)
+			state.AddPatterns(sources);
+		else for (const auto& signature : signatures)
+			state.AddPattern(state.PatternBuilder().setPattern(signature).Build());
+
+		benchmark::DoNotOptimize(state.mDescriptionts.data());
+	}
+
+	bench.SetItemsProcessed(bench.iterations() * signatures.size());
+}
+
+/*
+	Database image of `signatures`, ALIGNMENT aligned within `storage`
+*/
+static const UByte* MakeDatabase(const Vector<String<>>& signatures, Vector<UByte>& storage, size_t& size)
+{
+	Database::Writer writer;
+	Vector<UByte> image;
+
+	for (size_t i = 0; i < signatures.size(); i++)
+		writer.Add(std::to_string(i), signatures[i]);
+
+	writer.Serialize(image);
+
+	// Vector storage is only guaranteed 16 aligned
+
+	storage.assign(image.size() + Database::ALIGNMENT, 0);
+	UByte* at = (UByte*)(((uintptr_t)storage.data() + Database::ALIGNMENT - 1) & ~(uintptr_t)(Database::ALIGNMENT - 1));
+	memcpy(at, image.data(), image.size());
+
+	size = image.size();
+	return at;
+}
+
+/*
+	The same signatures precompiled, image opened in place, ready to Scan() as is
+	or copied into a State
+*/
+static void BM_LoadDatabase(benchmark::State& bench, bool bIntoState)
+{
+	const Vector<String<>> signatures = MakeSignatures(PARSE_SIGNATURES);
+	const Vector<UByte>& data = Data(Distribution::Code);
+	Vector<UByte> storage;
+	size_t size = 0;
+	const UByte* image = MakeDatabase(signatures, storage, size);
+
+	for (auto _ : bench)
+	{
+		Database::Reader reader;
+		benchmark::DoNotOptimize(reader.Open(image, size));
+
+		if (!bIntoState)
+			continue;
+
+		TBS::State<> state(data.data(), data.data() + data.size());
+		reader.AddTo(state);
+
+		benchmark::DoNotOptimize(state.mDescriptionts.data());
+	}
+
+	bench.SetItemsProcessed(bench.iterations() * signatures.size());
+}
+
+/*
+	`count` precompiled signatures scanned straight from the image
+*/
+static void BM_DatabaseScan(benchmark::State& bench, size_t count)
+{
+	const Vector<UByte>& data = Data(Distribution::Code);
+	Vector<UByte> storage;
+	size_t size = 0;
+	const UByte* image = MakeDatabase(MakeSignatures(count), storage, size);
+
+	Database::Reader reader;
+	reader.Open(image, size);
+
+	for (auto _ : bench)
+	{
+		size_t matches = 0;
+
+		reader.Scan(data.data(), data.data() + data.size(), [&matches](size_t, Pattern::Result) {
+			matches++;
+			return true;
+			});
+
+		benchmark::DoNotOptimize(matches);
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * data.size());
+}
+
+constexpr size_t REUSED_SIGNATURES = 1000;
+constexpr size_t REUSED_SCAN_SIZE = 64 * 1024;	// Small, so building weighs
+
+/*
+	A signature set scanned again & again, built once into a reusable State,
+	multi-pattern groups compiled once too
+*/
+static void BM_ReusableScan(benchmark::State& bench, bool bMultiPattern)
+{
+	const Vector<String<>> signatures = MakeSignatures(REUSED_SIGNATURES);
+	const Vector<UByte>& data = Data(Distribution::Random);
+	const size_t scanSize = REUSED_SCAN_SIZE;
+
+	TBS::State<> state(data.data(), data.data() + scanSize);
+	state.setReusable().setMultiPattern(bMultiPattern);
+
+	for (const auto& signature : signatures)
+		state.AddPattern(state.PatternBuilder().setUID(signature).setPattern(signature).Build());
+
+	TBS::State<>::ScanResults results(state);
+
+	for (auto _ : bench)
+		benchmark::DoNotOptimize(Scan(state, results.Reset()));
+
+	bench.SetBytesProcessed(bench.iterations() * scanSize);
+}
+
+/*
+	Same, rebuilding the State every time
+*/
+static void BM_RebuiltScan(benchmark::State& bench)
+{
+	const Vector<String<>> signatures = MakeSignatures(REUSED_SIGNATURES);
+	const Vector<UByte>& data = Data(Distribution::Random);
+	const size_t scanSize = REUSED_SCAN_SIZE;
+
+	for (auto _ : bench)
+	{
+		TBS::State<> state(data.data(), data.data() + scanSize);
+
+		for (const auto& signature : signatures)
+			state.AddPattern(state.PatternBuilder().setUID(signature).setPattern(signature).Build());
+
+		benchmark::DoNotOptimize(Scan(state));
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * scanSize);
+}
+
+/*
+	Repeated scans of mostly unchanged memory, `dirtyPages` pages patched before each,
+	incremental or from scratch
+*/
+static void BM_Rescan(benchmark::State& bench, size_t dirtyPages, bool bIncremental)
+{
+	Vector<UByte> data = Data(Distribution::Code);
+	const Vector<String<>> signatures = MakeSignatures(64);
+	std::mt19937 gen(0x2E5);
+
+	// From scratch, a fresh State per scan so results never pile up
+
+	std::unique_ptr<TBS::State<>> state;
+
+	auto rebuild = [&] {
+		state.reset(new TBS::State<>(data.data(), data.data() + data.size()));
+		state->setIncremental(bIncremental);
+
+		for (const auto& signature : signatures)
+			state->AddPattern(state->PatternBuilder().setUID(signature).setPattern(signature).Build());
+		};
+
+	rebuild();
+	Scan(*state);
+
+	for (auto _ : bench)
+	{
+		bench.PauseTiming();
+
+		for (size_t i = 0; i < dirtyPages; i++)
+			data[gen() % data.size()] ^= 0x01;
+
+		if (!bIncremental)
+			rebuild();
+
+		bench.ResumeTiming();
+
+		benchmark::DoNotOptimize(Scan(*state));
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * data.size());
+}
+
+/*
+	Data split evenly across the benchmark threads, aggregate throughput
+*/
+static void BM_ThreadScaling(benchmark::State& bench)
+{
+	const Vector<UByte>& data = Data(Distribution::Code);
+	const size_t sliceSize = data.size() / bench.threads();
+	const UByte* slice = data.data() + bench.thread_index() * sliceSize;
+
+	Pattern::ParseResult parsed;
+	Pattern::Parse(SHAPES[2].mPattern, parsed);
+
+	for (auto _ : bench)
+	{
+		Pattern::Results results;
+		Light::Scan(slice, slice + sliceSize, results, parsed);
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	bench.SetBytesProcessed(bench.iterations() * sliceSize);
+}
+
+static void RegisterAll()
+{
+	const Distribution distributions[] = { Distribution::Random, Distribution::Zeros, Distribution::Code };
+
+	for (Kernel kernel : KERNELS)
+	{
+		if (!KernelAvailable(kernel))
+			continue;
+
+		const String<> kernelName = KernelName(kernel);
+
+		for (size_t len : { 16, 64, 4096 })
+			benchmark::RegisterBenchmark(("Compare/" + kernelName + "/" + std::to_string(len)).c_str(), BM_Compare, kernel, len);
+
+		for (Distribution distribution : distributions)
+		{
+			const String<> distributionName = DistributionName(distribution);
+
+			benchmark::RegisterBenchmark(("SearchFirst/" + kernelName + "/" + distributionName).c_str(), BM_SearchFirst, kernel, distribution)
+				->Unit(benchmark::kMillisecond);
+
+			for (const Shape& shape : SHAPES)
+			{
+				benchmark::RegisterBenchmark(("LightScan/" + kernelName + "/" + distributionName + "/" + shape.mName).c_str(), BM_LightScan, kernel, distribution, shape)
+					->Unit(benchmark::kMillisecond);
+			}
+		}
+	}
+
+	for (size_t count : { 1, 8, 64, 256, 1000 })
+	{
+		benchmark::RegisterBenchmark(("StateScan/Single/" + std::to_string(count)).c_str(), BM_StateScan, count, false)
+			->Unit(benchmark::kMillisecond)->UseRealTime();
+		benchmark::RegisterBenchmark(("StateScan/Multi/" + std::to_string(count)).c_str(), BM_StateScan, count, true)
+			->Unit(benchmark::kMillisecond)->UseRealTime();
+	}
+
+	benchmark::RegisterBenchmark("Parse", BM_Parse)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("LoadSignatures/Builder", BM_LoadSignatures, false)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("LoadSignatures/Bulk", BM_LoadSignatures, true)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("LoadSignatures/Database", BM_LoadDatabase, false)->Unit(benchmark::kMillisecond);
+	benchmark::RegisterBenchmark("LoadSignatures/DatabaseIntoState", BM_LoadDatabase, true)->Unit(benchmark::kMillisecond);
+
+	for (size_t count : { 64, 2000, 20000 })
+	{
+		benchmark::RegisterBenchmark(("DatabaseScan/" + std::to_string(count)).c_str(), BM_DatabaseScan, count)
+			->Unit(benchmark::kMillisecond)->UseRealTime();
+	}
+
+	benchmark::RegisterBenchmark("StateScan/Rebuilt", BM_RebuiltScan)->Unit(benchmark::kMillisecond)->UseRealTime();
+	benchmark::RegisterBenchmark("StateScan/Reusable", BM_ReusableScan, false)->Unit(benchmark::kMillisecond)->UseRealTime();
+	benchmark::RegisterBenchmark("StateScan/ReusableMultiPattern", BM_ReusableScan, true)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+	for (size_t dirtyPages : { 0, 16 })
+	{
+		benchmark::RegisterBenchmark(("Rescan/Full/" + std::to_string(dirtyPages)).c_str(), BM_Rescan, dirtyPages, false)
+			->Unit(benchmark::kMillisecond)->UseRealTime();
+		benchmark::RegisterBenchmark(("Rescan/Incremental/" + std::to_string(dirtyPages)).c_str(), BM_Rescan, dirtyPages, true)
+			->Unit(benchmark::kMillisecond)->UseRealTime();
+	}
+
+	const int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+
+	benchmark::RegisterBenchmark("ThreadScaling/Code/LeadingWildcards", BM_ThreadScaling)
+		->ThreadRange(1, cores)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+int main(int argc, char** argv)
+{
+	benchmark::Initialize(&argc, argv);
+
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	RegisterAll();
+
+	benchmark::AddCustomContext("tbs_mt",
+#ifdef TBS_MT
+		"on"
+#else
+		"off"
+#endif
+	);
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Compares two Google Benchmark JSON outputs of TBSBenchmarks, flags regressions.
+
+    TBSBenchmarks --benchmark_out=baseline.json --benchmark_out_format=json
+    ... changes ...
+    TBSBenchmarks --benchmark_out=contender.json --benchmark_out_format=json
+    compare.py baseline.json contender.json --threshold 0.05
+
+Throughput (bytes_per_second) is compared when present, real time otherwise.
+With --benchmark_repetitions the median aggregate is used. Exits 1 when any
+benchmark got slower by more than the threshold.
+"""
+
+import argparse
+import json
+import sys
+
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+
+def load(path):
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    medians = {b["run_name"]: b for b in benchmarks
+               if b.get("run_type") == "aggregate" and b.get("aggregate_name") == "median"}
+    runs = {}
+
+    for b in benchmarks:
+        name = b.get("run_name", b["name"])
+
+        if name in medians:
+            runs[name] = medians[name]
+        elif b.get("run_type", "iteration") == "iteration":
+            runs.setdefault(name, b)
+
+    return runs
+
+
+def speed(bench):
+    """Higher is better"""
+    if "bytes_per_second" in bench:
+        return bench["bytes_per_second"]
+
+    return 1.0 / (bench["real_time"] * TIME_UNITS[bench.get("time_unit", "ns")])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown flagged (default 0.05)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    contender = load(args.contender)
+    regressions = 0
+
+    width = max([len(name) for name in baseline] + [9])
+    print(f"{'benchmark':<{width}} {'change':>9}")
+
+    for name, base in baseline.items():
+        if name not in contender:
+            print(f"{name:<{width}} {'missing':>9}")
+            continue
+
+        change = speed(contender[name]) / speed(base) - 1.0
+        flag = ""
+
+        if change < -args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change > args.threshold:
+            flag = "  improved"
+
+        print(f"{name:<{width}} {change * 100:>+8.1f}%{flag}")
+
+    for name in contender:
+        if name not in baseline:
+            print(f"{name:<{width}} {'new':>9}")
+
+    print(f"\n{regressions} regression(s) over {args.threshold * 100:.1f}%")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
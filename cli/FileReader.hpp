@@ -0,0 +1,429 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef TBSCLI_IO_URING
+#include <liburing.h>
+#endif
+#endif
+
+/*
+    Reads whole files front to back through a ring of `depth` page aligned
+    buffers of `bufferSize` bytes, keeping several reads in flight while the
+    filled buffers are handed, in file order, to `onData(data, len)`.
+
+    IoUring submits every free buffer at once to the kernel, PRead is the
+    portable fallback, a thread reading ahead with plain pread(2).
+*/
+class FileReader {
+public:
+    enum class Backend {
+        IoUring,
+        PRead
+    };
+
+    using OnDataFn = std::function<bool(const void* data, size_t len)>;
+
+    static constexpr size_t ALIGNMENT = 4096;
+
+    inline FileReader(Backend backend, size_t bufferSize = 1 << 20, size_t depth = 8)
+        : backend(backend)
+        , bufferSize((bufferSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1))
+        , depth(depth < 2 ? 2 : depth)
+        , buffers(nullptr)
+#ifdef TBSCLI_IO_URING
+        , ringReady(false)
+#endif
+    {
+        buffers = (unsigned char*)AlignedAlloc(this->bufferSize * this->depth);
+
+#ifdef TBSCLI_IO_URING
+        if (backend == Backend::IoUring)
+            ringReady = io_uring_queue_init((unsigned)this->depth, &ring, 0) == 0;
+#endif
+    }
+
+    inline ~FileReader()
+    {
+#ifdef TBSCLI_IO_URING
+        if (ringReady)
+            io_uring_queue_exit(&ring);
+#endif
+
+        AlignedFree(buffers);
+    }
+
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    /*
+        Built with liburing & the kernel lets us set up a ring
+    */
+    static inline bool IoUringAvailable()
+    {
+#ifdef TBSCLI_IO_URING
+        struct io_uring probe;
+
+        if (io_uring_queue_init(2, &probe, 0) != 0)
+            return false;
+
+        io_uring_queue_exit(&probe);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /*
+        False when the file couldnt be opened or read, `onData` returning false
+        stops reading early & is not an error. `bytesRead` gets the bytes handed over.
+    */
+    inline bool Read(const char* path, const OnDataFn& onData, size_t& bytesRead)
+    {
+        bytesRead = 0;
+
+#ifdef __linux__
+        if (buffers == nullptr)
+            return false;
+
+        const int fd = open(path, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        bool bSuccess = fstat(fd, &st) == 0;
+
+        if (bSuccess)
+        {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+#ifdef TBSCLI_IO_URING
+            if (backend == Backend::IoUring && ringReady)
+                bSuccess = ReadIoUring(fd, (size_t)st.st_size, onData, bytesRead);
+            else
+#endif
+                bSuccess = ReadPRead(fd, (size_t)st.st_size, onData, bytesRead);
+        }
+
+        close(fd);
+        return bSuccess;
+#else
+        (void)path;
+        (void)onData;
+        return false;
+#endif
+    }
+
+    /*
+        Drops the file clean pages from the page cache, next read is a cold one
+    */
+    static inline void Evict(const char* path)
+    {
+#ifdef __linux__
+        const int fd = open(path, O_RDONLY);
+
+        if (fd < 0)
+            return;
+
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    Backend GetBackend() const
+    {
+#ifdef TBSCLI_IO_URING
+        if (backend == Backend::IoUring && ringReady)
+            return Backend::IoUring;
+#endif
+
+        return Backend::PRead;
+    }
+
+private:
+    static inline void* AlignedAlloc(size_t size)
+    {
+        void* ptr = nullptr;
+
+#ifdef __linux__
+        if (posix_memalign(&ptr, ALIGNMENT, size) != 0)
+            return nullptr;
+#endif
+
+        return ptr;
+    }
+
+    static inline void AlignedFree(void* ptr)
+    {
+        free(ptr);
+    }
+
+    inline unsigned char* Buffer(size_t slot) const
+    {
+        return buffers + slot * bufferSize;
+    }
+
+#ifdef __linux__
+    /*
+        Reader thread fills slots ahead, the calling thread consumes them in order
+    */
+    inline bool ReadPRead(int fd, size_t fileSize, const OnDataFn& onData, size_t& bytesRead)
+    {
+        struct Slot {
+            size_t len = 0;
+            bool filled = false;
+        };
+
+        std::vector<Slot> slots(depth);
+        std::mutex mtx;
+        std::condition_variable condVar;
+        bool stop = false;
+        bool failed = false;
+        size_t readSlots = 0;
+
+        const size_t slotCount = (fileSize + bufferSize - 1) / bufferSize;
+
+        std::thread reader([&] {
+            for (size_t seq = 0; seq < slotCount; seq++)
+            {
+                Slot& slot = slots[seq % depth];
+
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    condVar.wait(lock, [&] { return !slot.filled || stop; });
+
+                    if (stop)
+                        return;
+                }
+
+                const size_t want = std::min(bufferSize, fileSize - seq * bufferSize);
+                size_t got = 0;
+
+                while (got < want)
+                {
+                    const ssize_t res = pread(fd, Buffer(seq % depth) + got, want - got, (off_t)(seq * bufferSize + got));
+
+                    if (res <= 0)
+                        break;
+
+                    got += (size_t)res;
+                }
+
+                std::lock_guard<std::mutex> lock(mtx);
+
+                slot.len = got;
+                slot.filled = true;
+                readSlots++;
+
+                if (got != want)
+                    failed = true;
+
+                condVar.notify_all();
+
+                if (failed)
+                    return;
+            }
+            });
+
+        bool bSuccess = true;
+
+        for (size_t seq = 0; seq < slotCount; seq++)
+        {
+            Slot& slot = slots[seq % depth];
+            size_t len;
+
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                condVar.wait(lock, [&] { return slot.filled || (failed && readSlots <= seq); });
+
+                if (!slot.filled)
+                {
+                    bSuccess = false;
+                    break;
+                }
+
+                len = slot.len;
+            }
+
+            // At this point, the reader is already filling the next slots
+
+            const bool bContinue = len != 0 && onData(Buffer(seq % depth), len);
+            bytesRead += len;
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                slot.filled = false;
+
+                if (!bContinue)
+                    stop = true;
+
+                condVar.notify_all();
+            }
+
+            if (!bContinue)
+            {
+                bSuccess = len != 0;
+                break;
+            }
+        }
+
+        reader.join();
+
+        return bSuccess && !failed;
+    }
+#endif
+
+#ifdef TBSCLI_IO_URING
+    /*
+        Every free slot has a read queued, completions come in any order
+        but are consumed in file order, finished slots get the next read
+    */
+    inline bool ReadIoUring(int fd, size_t fileSize, const OnDataFn& onData, size_t& bytesRead)
+    {
+        struct Slot {
+            size_t seq = 0;
+            size_t want = 0;
+            size_t got = 0;
+            bool inFlight = false;
+        };
+
+        std::vector<Slot> slots(depth);
+        const size_t slotCount = (fileSize + bufferSize - 1) / bufferSize;
+        size_t submitted = 0;
+        size_t inFlight = 0;
+        bool bFailed = false;
+
+        const auto queueRead = [&](size_t idx) {
+            Slot& slot = slots[idx];
+            struct io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+
+            if (sqe == nullptr)
+                return false;
+
+            io_uring_prep_read(sqe, fd, Buffer(idx) + slot.got, (unsigned)(slot.want - slot.got), (__u64)(slot.seq * bufferSize + slot.got));
+            io_uring_sqe_set_data(sqe, (void*)idx);
+
+            slot.inFlight = true;
+            inFlight++;
+            return true;
+            };
+
+        const auto queueNext = [&](size_t idx) {
+            if (submitted == slotCount)
+                return true;
+
+            Slot& slot = slots[idx];
+            slot.seq = submitted++;
+            slot.want = std::min(bufferSize, fileSize - slot.seq * bufferSize);
+            slot.got = 0;
+
+            return queueRead(idx);
+            };
+
+        for (size_t idx = 0; idx < depth && submitted < slotCount; idx++)
+            queueNext(idx);
+
+        io_uring_submit(&ring);
+
+        bool bStopped = false;
+
+        for (size_t seq = 0; seq < slotCount && !bFailed && !bStopped; seq++)
+        {
+            const size_t idx = seq % depth;
+            Slot& slot = slots[idx];
+
+            // Reaping until our slot, in order, is completely filled
+
+            while (slot.inFlight || slot.got < slot.want)
+            {
+                if (!slot.inFlight)
+                {
+                    queueRead(idx);
+                    io_uring_submit(&ring);
+                }
+
+                struct io_uring_cqe* cqe;
+
+                if (io_uring_wait_cqe(&ring, &cqe) != 0)
+                {
+                    bFailed = true;
+                    break;
+                }
+
+                Slot& done = slots[(size_t)io_uring_cqe_get_data(cqe)];
+                const int res = cqe->res;
+
+                io_uring_cqe_seen(&ring, cqe);
+
+                done.inFlight = false;
+                inFlight--;
+
+                if (res <= 0)
+                {
+                    // At this point, error or file shrunk underneath us
+
+                    bFailed = true;
+                    break;
+                }
+
+                done.got += (size_t)res;
+
+                if (&done != &slot && done.got < done.want)
+                {
+                    queueRead((size_t)(&done - slots.data()));
+                    io_uring_submit(&ring);
+                }
+            }
+
+            if (bFailed)
+                break;
+
+            bStopped = !onData(Buffer(idx), slot.got);
+            bytesRead += slot.got;
+
+            if (!bStopped && queueNext(idx))
+                io_uring_submit(&ring);
+        }
+
+        // Buffers are reused by the next file, no read may still target them
+
+        while (inFlight)
+        {
+            struct io_uring_cqe* cqe;
+
+            if (io_uring_wait_cqe(&ring, &cqe) != 0)
+                break;
+
+            slots[(size_t)io_uring_cqe_get_data(cqe)].inFlight = false;
+            io_uring_cqe_seen(&ring, cqe);
+            inFlight--;
+        }
+
+        return !bFailed;
+    }
+
+    struct io_uring ring;
+#endif
+
+    Backend backend;
+    size_t bufferSize;
+    size_t depth;
+    unsigned char* buffers;
+#ifdef TBSCLI_IO_URING
+    bool ringReady;
+#endif
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <TBS/TBS.hpp>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+    Signature loaded from a patterns file, either spaced ("48 8B ?? ??")
+    or raw bytes + mask ("488B0000 xx??")
+*/
+struct PatternEntry {
+    std::string uid;
+    std::string pattern;
+    std::vector<unsigned char> raw;
+    std::string mask;
+};
+
+inline bool IsRawAndMask(const std::string& bytes, const std::string& mask)
+{
+    if (mask.find('x') == std::string::npos || mask.find_first_not_of("x?") != std::string::npos)
+        return false;
+
+    if (bytes.size() != mask.size() * 2)
+        return false;
+
+    for (char c : bytes)
+    {
+        if (!isxdigit((unsigned char)c))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+    One "uid pattern" per line, blank lines & lines starting with '#' are skipped
+*/
+inline bool LoadPatternsFile(const std::string& path, std::vector<PatternEntry>& entries)
+{
+    std::ifstream in(path);
+
+    if (!in)
+    {
+        printf("Patterns file '%s' could not be opened\n", path.c_str());
+        return false;
+    }
+
+    std::string line;
+
+    for (size_t lineNumber = 1; std::getline(in, line); lineNumber++)
+    {
+        std::istringstream tokens(line);
+        PatternEntry entry;
+
+        if (!(tokens >> entry.uid) || entry.uid[0] == '#')
+            continue;
+
+        std::vector<std::string> rest;
+
+        for (std::string token; tokens >> token; )
+            rest.push_back(token);
+
+        if (rest.size() == 2 && IsRawAndMask(rest[0], rest[1]))
+        {
+            for (size_t i = 0; i < rest[0].size(); i += 2)
+                entry.raw.push_back(TBS::Memory::ByteFromString(rest[0].c_str() + i));
+
+            entry.mask = rest[1];
+            entries.push_back(entry);
+            continue;
+        }
+
+        for (const std::string& token : rest)
+            entry.pattern += (entry.pattern.empty() ? "" : " ") + token;
+
+        if (entry.pattern.empty() || !TBS::Pattern::Valid(entry.pattern))
+        {
+            printf("%s:%zu pattern '%s' invalid\n", path.c_str(), lineNumber, entry.pattern.c_str());
+            return false;
+        }
+
+        entries.push_back(entry);
+    }
+
+    return true;
+}
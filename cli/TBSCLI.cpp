@@ -1,7 +1,23 @@
 #include <TBS/TBS.hpp>
 #include <cxxopts.hpp>
+#include "FileReader.hpp"
+#include "PatternsFile.hpp"
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -78,9 +94,15 @@ private:
         if (mapViewI == -1)
         {
             close(fileHandleI);
+            fileHandleI = -1;
             hasError = true;
             return;
         }
+
+        // Sequential scan ahead, lets the kernel read while the previous pages are scanned
+
+        madvise(mapView, fileSize, MADV_SEQUENTIAL);
+        madvise(mapView, fileSize, MADV_WILLNEED);
     }
 
     inline void Release()
@@ -142,6 +164,716 @@ private:
 #endif
 };
 
+static std::string JsonEscape(const std::string& str)
+{
+    std::string escaped;
+
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            escaped.push_back('\\');
+
+        escaped.push_back(c);
+    }
+
+    return escaped;
+}
+
+static bool WildcardMatch(const char* glob, const char* str)
+{
+    if (*glob == '\0')
+        return *str == '\0';
+
+    if (*glob == '*')
+        return WildcardMatch(glob + 1, str) || (*str != '\0' && WildcardMatch(glob, str + 1));
+
+    if (*str == '\0')
+        return false;
+
+    return (*glob == '?' || *glob == *str) && WildcardMatch(glob + 1, str + 1);
+}
+
+/*
+    Non empty regular files under `root` whose name matches `glob`, sorted so output order is stable
+*/
+static void CollectFiles(const std::filesystem::path& root, const std::string& glob, bool bRecursive, std::vector<std::string>& files)
+{
+    namespace fs = std::filesystem;
+
+    const auto consider = [&](const fs::directory_entry& entry) {
+        std::error_code ec;
+
+        if (!entry.is_regular_file(ec) || ec || entry.file_size(ec) == 0 || ec)
+            return;
+
+        if (!glob.empty() && !WildcardMatch(glob.c_str(), entry.path().filename().string().c_str()))
+            return;
+
+        files.push_back(entry.path().string());
+        };
+
+    std::error_code ec;
+
+    if (bRecursive)
+    {
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+            consider(*it);
+    }
+    else
+    {
+        for (fs::directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+            consider(*it);
+    }
+
+    std::sort(files.begin(), files.end());
+}
+
+/*
+    Blocking FIFO of at most `capacity` items, Pop fails once closed & drained.
+    Abort drops whatever is queued & every later Push, unblocking both sides
+*/
+template<typename T>
+class BoundedQueue {
+public:
+    inline BoundedQueue(size_t capacity)
+        : capacity(capacity)
+        , closed(false)
+        , aborted(false)
+    {}
+
+    inline void Push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        notFull.wait(lock, [this] { return items.size() < capacity || aborted; });
+
+        if (aborted)
+            return;
+
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    inline bool Pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        notEmpty.wait(lock, [this] { return !items.empty() || closed; });
+
+        if (items.empty())
+            return false;
+
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    inline void Close()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+    inline void Abort()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = aborted = true;
+        items.clear();
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    std::mutex mtx;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+    bool aborted;
+};
+
+/*
+    How file contents get to the scanner, mapped & demand paged
+    or read in chunks through FileReader
+*/
+enum class InputBackend {
+    Mmap,
+    IoUring,
+    PRead
+};
+
+static const char* InputBackendName(InputBackend io)
+{
+    switch (io)
+    {
+    case InputBackend::IoUring: return "io_uring";
+    case InputBackend::PRead: return "pread";
+    default: return "mmap";
+    }
+}
+
+static bool ParseEntry(const PatternEntry& entry, TBS::Pattern::ParseResult& parsed)
+{
+    if (entry.raw.empty())
+        return TBS::Pattern::Parse(entry.pattern, parsed);
+
+    return TBS::Pattern::Parse(entry.raw.data(), entry.mask.c_str(), parsed);
+}
+
+/*
+    Scans `files` through a bounded pipeline, one thread opening & mapping,
+    `workers` scanning each file in a single multi-pattern pass & the calling
+    thread printing reports in `files` order. At most `window` files are
+    in flight (mapped, scanned or waiting to be printed) at any time.
+
+    With a FileReader backend the first stage only hands out files, every
+    worker streams them through its own buffer ring into its scanner.
+    `bCold` evicts each file from the page cache right before it is read.
+*/
+static int ScanFiles(const std::vector<std::string>& files, const std::vector<PatternEntry>& entries, size_t workers, bool bSingleRes, bool bJson,
+    InputBackend io = InputBackend::Mmap, bool bCold = false)
+{
+    struct Mapped {
+        size_t index;
+        std::unique_ptr<FileView> view;
+    };
+
+    struct Report {
+        size_t index;
+        size_t bytes;
+        bool bMapped;
+        std::vector<std::vector<unsigned long long>> matches; // per uid
+    };
+
+    // Patterns parsed once, every worker compiles its own scanner out of them
+
+    std::vector<std::string> uids;
+    std::vector<size_t> uidOf;
+    std::vector<TBS::Pattern::ParseResult> parsed(entries.size());
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (!ParseEntry(entries[i], parsed[i]))
+        {
+            printf("Pattern '%s' invalid\n", entries[i].pattern.c_str());
+            return 1;
+        }
+
+        const auto uid = std::find(uids.begin(), uids.end(), entries[i].uid);
+        uidOf.push_back(uid - uids.begin());
+
+        if (uid == uids.end())
+            uids.push_back(entries[i].uid);
+    }
+
+    workers = std::max<size_t>(workers, 1);
+
+    const size_t window = workers * 4;
+    BoundedQueue<Mapped> mappedQueue(workers * 2);
+    BoundedQueue<Report> reportQueue(window);
+
+    std::mutex windowMtx;
+    std::condition_variable windowCondVar;
+    size_t printed = 0;
+    bool bStopped = false;
+
+    // Every way out joins the threads, leaving early unblocks them first
+
+    std::thread mapper;
+    std::vector<std::thread> scanners;
+    std::atomic<size_t> scanning(workers);
+    bool bDone = false;
+
+    struct Joiner {
+        std::function<void()> onExit;
+
+        inline ~Joiner()
+        {
+            onExit();
+        }
+    } joiner{ [&] {
+        if (!bDone)
+        {
+            {
+                std::lock_guard<std::mutex> lock(windowMtx);
+                bStopped = true;
+            }
+
+            windowCondVar.notify_all();
+            mappedQueue.Abort();
+            reportQueue.Abort();
+        }
+
+        if (mapper.joinable())
+            mapper.join();
+
+        for (std::thread& scanner : scanners)
+        {
+            if (scanner.joinable())
+                scanner.join();
+        }
+        } };
+
+    const auto started = std::chrono::steady_clock::now();
+
+    mapper = std::thread([&] {
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            {
+                std::unique_lock<std::mutex> lock(windowMtx);
+                windowCondVar.wait(lock, [&] { return bStopped || i < printed + window; });
+
+                if (bStopped)
+                    break;
+            }
+
+            Mapped mapped{ i, nullptr };
+
+            if (bCold)
+                FileReader::Evict(files[i].c_str());
+
+            try {
+                if (io == InputBackend::Mmap)
+                    mapped.view.reset(new FileView(files[i].c_str()));
+            }
+            catch (const std::exception&) {
+                // At this point, file vanished or is unreadable, reported as unmapped
+            }
+
+            mappedQueue.Push(std::move(mapped));
+        }
+
+        mappedQueue.Close();
+        });
+
+    for (size_t w = 0; w < workers; w++)
+    {
+        scanners.emplace_back([&] {
+            TBS::StreamScanner scanner;
+            std::unique_ptr<FileReader> reader;
+
+            for (const auto& pattern : parsed)
+                scanner.AddPattern(pattern);
+
+            if (io != InputBackend::Mmap)
+                reader.reset(new FileReader(io == InputBackend::IoUring ? FileReader::Backend::IoUring : FileReader::Backend::PRead));
+
+            for (Mapped mapped; mappedQueue.Pop(mapped); )
+            {
+                Report report{ mapped.index, 0, false, std::vector<std::vector<unsigned long long>>(uids.size()) };
+                size_t found = 0;
+
+                const auto onMatch = [&](size_t idx, TBS::U64 offset) {
+                    auto& matches = report.matches[uidOf[idx]];
+
+                    if (bSingleRes && !matches.empty())
+                        return true;
+
+                    found += matches.empty();
+                    matches.push_back(offset);
+
+                    return !bSingleRes || found < uids.size();
+                    };
+
+                scanner.Reset();
+
+                if (reader)
+                {
+                    // Chunks are scanned as they land, seams carried by the scanner
+
+                    report.bMapped = reader->Read(files[mapped.index].c_str(), [&](const void* data, size_t len) {
+                        return scanner.Feed(data, len, onMatch);
+                        }, report.bytes);
+                }
+                else if (mapped.view && !mapped.view->has_error())
+                {
+                    report.bMapped = true;
+                    report.bytes = mapped.view->size();
+
+                    scanner.Feed((const void*)*mapped.view, mapped.view->size(), onMatch);
+                }
+
+                // At this point, done with the mapping, released before queuing the report
+
+                mapped.view.reset();
+                reportQueue.Push(std::move(report));
+            }
+
+            // At this point, the last scanner out closes the reports
+
+            if (--scanning == 0)
+                reportQueue.Close();
+            });
+    }
+
+    // Ordered output, reports arriving early wait for their predecessors
+
+    std::map<size_t, Report> pending;
+    size_t bytes = 0;
+    size_t unmapped = 0;
+    size_t matchingFiles = 0;
+    bool bFirstJson = true;
+
+    if (bJson)
+        printf("{\n");
+
+    for (Report report; reportQueue.Pop(report); )
+    {
+        pending.emplace(report.index, std::move(report));
+
+        for (auto next = pending.find(printed); next != pending.end(); next = pending.find(printed))
+        {
+            const Report& ready = next->second;
+            const std::string& path = files[ready.index];
+            const bool bMatched = std::any_of(ready.matches.begin(), ready.matches.end(), [](const auto& m) { return !m.empty(); });
+
+            bytes += ready.bytes;
+
+            if (!ready.bMapped)
+            {
+                unmapped++;
+                fprintf(stderr, "Failed to open/%s file '%s'\n", io == InputBackend::Mmap ? "map" : "read", path.c_str());
+            }
+
+            if (bMatched)
+            {
+                matchingFiles++;
+
+                if (bJson)
+                {
+                    printf("%s    \"%s\" : {\n", bFirstJson ? "" : ",\n", JsonEscape(path).c_str());
+                    bFirstJson = false;
+                }
+
+                bool bFirstUid = true;
+
+                for (size_t u = 0; u < uids.size(); u++)
+                {
+                    const auto& matches = ready.matches[u];
+
+                    if (!bJson)
+                    {
+                        for (auto offset : matches)
+                            printf("%s %s 0x%016llX\n", path.c_str(), uids[u].c_str(), offset);
+
+                        continue;
+                    }
+
+                    if (matches.empty())
+                        continue;
+
+                    printf("%s        \"%s\" : [", bFirstUid ? "" : ",\n", JsonEscape(uids[u]).c_str());
+                    bFirstUid = false;
+
+                    for (size_t k = 0; k < matches.size(); k++)
+                        printf("%s%llu", k ? ", " : "", matches[k]);
+
+                    printf("]");
+                }
+
+                if (bJson)
+                    printf("\n    }");
+            }
+
+            pending.erase(next);
+
+            {
+                std::lock_guard<std::mutex> lock(windowMtx);
+                printed++;
+            }
+
+            windowCondVar.notify_one();
+        }
+    }
+
+    if (bJson)
+        printf("%s}\n", bFirstJson ? "" : "\n");
+
+    bDone = true;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const double gigabytes = bytes / (1024.0 * 1024.0 * 1024.0);
+
+    fprintf(stderr, "%s: %zu files (%zu matching, %zu unreadable), %.3f GB in %.3f s: %.1f files/s, %.3f GB/s\n",
+        InputBackendName(io), files.size(), matchingFiles, unmapped, gigabytes, seconds,
+        seconds > 0 ? files.size() / seconds : 0.0, seconds > 0 ? gigabytes / seconds : 0.0);
+
+    return matchingFiles ? 0 : 3;
+}
+
+/*
+    Offsets found per UID, "uid 0x..." lines or a JSON object of arrays
+*/
+static void PrintUIDResults(const std::vector<std::string>& uids, const std::vector<std::vector<unsigned long long>>& offsets, bool bJson)
+{
+    if (bJson)
+        printf("{\n");
+
+    for (size_t i = 0; i < uids.size(); i++)
+    {
+        if (bJson)
+        {
+            printf("    \"%s\" : [", JsonEscape(uids[i]).c_str());
+
+            for (size_t k = 0; k < offsets[i].size(); k++)
+                printf("%s%llu", k ? ", " : "", offsets[i][k]);
+
+            printf("]%s\n", i + 1 < uids.size() ? "," : "");
+            continue;
+        }
+
+        if (offsets[i].empty())
+            printf("%s not found\n", uids[i].c_str());
+
+        for (auto offset : offsets[i])
+            printf("%s 0x%016llX\n", uids[i].c_str(), offset);
+    }
+
+    if (bJson)
+        printf("}\n");
+}
+
+/*
+    Every signature of a tbs-compile database in one pass over the mapped file,
+    scanned straight from the mapped database, nothing parsed
+*/
+static int ScanDatabase(const std::string& dbPath, const std::string& file, bool bSingleRes, bool bJson)
+{
+    TBS::Database::Reader reader;
+
+    if (!reader.Open(dbPath))
+    {
+        printf("Database '%s' could not be opened or is invalid\n", dbPath.c_str());
+        return 1;
+    }
+
+    FileView view(file.c_str());
+
+    if (view.has_error()) {
+        printf("Failed to open/map file '%s'\n", file.c_str());
+        return 2;
+    }
+
+    const unsigned char* begin = (const unsigned char*)(const void*)view;
+
+    // Entries sharing a UID are adjacent, results are kept per UID
+
+    std::vector<std::string> uids;
+    std::vector<size_t> uidOfEntry(reader.size());
+
+    for (size_t i = 0; i < reader.size(); i++)
+    {
+        const std::string uid(reader.UID(i));
+
+        if (uids.empty() || uids.back() != uid)
+            uids.push_back(uid);
+
+        uidOfEntry[i] = uids.size() - 1;
+    }
+
+    std::vector<std::vector<unsigned long long>> offsets(uids.size());
+
+    reader.Scan(begin, begin + view.size(), [&](size_t entry, TBS::Pattern::Result res) {
+        offsets[uidOfEntry[entry]].push_back((unsigned long long)(res - (size_t)begin));
+        return true;
+        });
+
+    bool bAllFound = true;
+
+    for (auto& found : offsets)
+    {
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+
+        if (bSingleRes && found.size() > 1)
+            found.resize(1);
+
+        bAllFound = bAllFound && !found.empty();
+    }
+
+    PrintUIDResults(uids, offsets, bJson);
+
+    return bAllFound ? 0 : 3;
+}
+
+/*
+    Scans [begin, begin + size) `runs` times per available kernel & per thread
+    count, slicing the range evenly across the threads. Patterns are parsed
+    again per kernel since their plan depends on it. Candidates per MB & the
+    share of them being matches need a TBS_STATS build.
+*/
+static int RunBench(const char* path, const unsigned char* begin, size_t size, const std::vector<PatternEntry>& entries,
+    size_t runs, const std::vector<size_t>& threadCounts, bool bJson)
+{
+    const TBS::Kernel kernels[] = { TBS::Kernel::Scalar, TBS::Kernel::Platform, TBS::Kernel::SSE2, TBS::Kernel::AVX2 };
+    const unsigned char* end = begin + size;
+    const double megabytes = size / (1024.0 * 1024.0);
+    bool bFirstJson = true;
+
+    runs = std::max<size_t>(runs, 1);
+
+    if (bJson)
+        printf("{\n    \"file\" : \"%s\",\n    \"bytes\" : %zu,\n    \"patterns\" : %zu,\n    \"runs\" : %zu,\n    \"results\" : [",
+            JsonEscape(path).c_str(), size, entries.size(), runs);
+    else
+    {
+        printf("Bench '%s' %.2f MB, %zu patterns, %zu runs\n", path, megabytes, entries.size(), runs);
+        printf("%-9s %7s %9s %9s %9s %11s %11s %10s\n", "kernel", "threads", "GB/s", "p50 ms", "p99 ms", "cand/MB", "verify hit", "matches");
+    }
+
+    for (TBS::Kernel kernel : kernels)
+    {
+        if (!TBS::SetKernel(kernel))
+            continue;
+
+        std::vector<TBS::Pattern::ParseResult> parsed(entries.size());
+
+        for (size_t i = 0; i < entries.size(); i++)
+            ParseEntry(entries[i], parsed[i]);
+
+        TBS::Pattern::MultiMatcher matcher;
+
+        for (const auto& pattern : parsed)
+            matcher.Add(pattern);
+
+        matcher.Compile();
+
+        // Trimmed starts in [from, to), matches may run up to `end`
+
+        const auto scanSlice = [&](const unsigned char* from, const unsigned char* to) {
+            size_t matches = 0;
+
+            if (parsed.size() != 1)
+            {
+                matcher.Scan(from, to, end, [&](size_t, const unsigned char*) {
+                    matches++;
+                    return true;
+                    });
+
+                return matches;
+            }
+
+            const size_t reach = parsed[0].getTrimmedSize() ? parsed[0].getTrimmedSize() - 1 : 0;
+            const unsigned char* windowEnd = (size_t)(end - to) > reach ? to + reach : end;
+
+            TBS::Pattern::Find(parsed[0], from, windowEnd, [&](const unsigned char*) {
+                matches++;
+                return true;
+                });
+
+            return matches;
+            };
+
+        for (size_t threads : threadCounts)
+        {
+            std::vector<double> latencies;
+            size_t matches = 0;
+
+            const auto runOnce = [&] {
+                std::vector<size_t> sliceMatches(threads, 0);
+                std::vector<std::thread> pool;
+                const size_t sliceSize = (size + threads - 1) / threads;
+
+                for (size_t t = 1; t < threads; t++)
+                {
+                    const unsigned char* from = begin + std::min(size, t * sliceSize);
+                    const unsigned char* to = begin + std::min(size, (t + 1) * sliceSize);
+
+                    pool.emplace_back([&, t, from, to] { sliceMatches[t] = scanSlice(from, to); });
+                }
+
+                sliceMatches[0] = scanSlice(begin, begin + std::min(size, sliceSize));
+
+                for (std::thread& thread : pool)
+                    thread.join();
+
+                size_t total = 0;
+
+                for (size_t count : sliceMatches)
+                    total += count;
+
+                return total;
+                };
+
+            // Warm up, pages faulted in & caches primed
+
+            runOnce();
+
+#ifdef TBS_STATS
+            TBS::Stats::Reset();
+#endif
+
+            for (size_t run = 0; run < runs; run++)
+            {
+                const auto started = std::chrono::steady_clock::now();
+
+                matches = runOnce();
+                latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+            }
+
+            std::sort(latencies.begin(), latencies.end());
+
+            double totalMs = 0;
+
+            for (double latency : latencies)
+                totalMs += latency;
+
+            const auto percentile = [&](double q) {
+                const size_t rank = (size_t)(q * latencies.size() + 0.999999);
+                return latencies[std::min(latencies.size() - 1, rank ? rank - 1 : 0)];
+                };
+
+            const double gbps = totalMs > 0 ? (size * (double)runs / (1024.0 * 1024.0 * 1024.0)) / (totalMs / 1000.0) : 0.0;
+            double candidatesPerMB = -1.0;
+            double verifyHit = -1.0;
+
+#ifdef TBS_STATS
+            const TBS::Stats::Counters stats = TBS::Stats::Get();
+
+            candidatesPerMB = stats.mCandidates / (megabytes * runs);
+            verifyHit = stats.mCandidates ? (double)stats.mMatches / stats.mCandidates : 0.0;
+#endif
+
+            if (bJson)
+            {
+                printf("%s\n        { \"kernel\" : \"%s\", \"threads\" : %zu, \"gbps\" : %.4f, \"p50_ms\" : %.4f, \"p99_ms\" : %.4f, \"matches\" : %zu",
+                    bFirstJson ? "" : ",", TBS::KernelName(kernel), threads, gbps, percentile(0.5), percentile(0.99), matches);
+
+                if (candidatesPerMB >= 0)
+                    printf(", \"candidates_per_mb\" : %.2f, \"verify_hit_ratio\" : %.6f", candidatesPerMB, verifyHit);
+
+                printf(" }");
+                bFirstJson = false;
+                continue;
+            }
+
+            char candidatesStr[32] = "-";
+            char verifyHitStr[32] = "-";
+
+            if (candidatesPerMB >= 0)
+            {
+                snprintf(candidatesStr, sizeof(candidatesStr), "%.1f", candidatesPerMB);
+                snprintf(verifyHitStr, sizeof(verifyHitStr), "%.3f%%", verifyHit * 100.0);
+            }
+
+            printf("%-9s %7zu %9.3f %9.3f %9.3f %11s %11s %10zu\n", TBS::KernelName(kernel), threads, gbps, percentile(0.5), percentile(0.99),
+                candidatesStr, verifyHitStr, matches);
+        }
+    }
+
+    TBS::SetKernel(TBS::Kernel::Auto);
+
+    if (bJson)
+        printf("\n    ]\n}\n");
+#ifndef TBS_STATS
+    else
+        printf("(cand/MB & verify hit need a TBS_STATS build)\n");
+#endif
+
+    return 0;
+}
+
 using namespace cxxopts;
 
 int TBSCLI(int argc, const char* argv[])
@@ -151,47 +883,198 @@ int TBSCLI(int argc, const char* argv[])
     bool bSingleRes = false;
     bool bNaked = false;
     bool bJson = false;
+    bool bRecursive = false;
+    std::string glob;
+    size_t threads = 0;
+    InputBackend io = InputBackend::Mmap;
+    bool bCold = false;
 
     cxxopts::Options options("TBSCLI", "Command Line Interface for TBS");
 
     options.allow_unrecognised_options();
 
     options.add_options()
-        ("f,file", "File to perform the scan at", cxxopts::value<std::string>()) // a bool parameter
+        ("f,file", "File to perform the scan at, a directory or a '*'/'?' wildcard scans every file in it", cxxopts::value<std::string>()) // a bool parameter
         ("p,pattern", "Pattern to scan for", cxxopts::value<std::string>())
         ("s,single", "show first result", cxxopts::value<bool>()->default_value("false"))
         ("n,naked", "to keep neat output raw naked output", cxxopts::value<bool>()->default_value("false"))
         ("j,json", "to output as JSON", cxxopts::value<bool>()->default_value("false"))
+        ("r,recursive", "to scan directories recursively", cxxopts::value<bool>()->default_value("false"))
+        ("g,glob", "only scan files whose name matches, e.g. '*.so*'", cxxopts::value<std::string>())
+        ("t,threads", "scan workers for directory scans, 0 for one per core", cxxopts::value<size_t>()->default_value("0"))
+        ("io", "input backend: mmap, uring (io_uring, falls back to pread when unavailable) or pread", cxxopts::value<std::string>()->default_value("mmap"))
+        ("cold", "evict every file from the page cache before scanning it, for cold cache benchmarks", cxxopts::value<bool>()->default_value("false"))
+        ("bench", "benchmark the scan of the file, every available kernel & thread count", cxxopts::value<bool>()->default_value("false"))
+        ("bench-runs", "timed runs per kernel & thread count", cxxopts::value<size_t>()->default_value("10"))
+        ("bench-threads", "comma separated thread counts to bench, default 1 & one per core", cxxopts::value<std::string>())
+        ("patterns-file", "File with one 'uid pattern' per line ('uid 488B05 xxx' for raw+mask), all scanned in a single pass", cxxopts::value<std::string>())
+        ("db", "Precompiled signature database (tbs-compile), all signatures scanned in place in a single pass", cxxopts::value<std::string>())
         ;
 
     auto result = options.parse(argc, argv);
 
     if (!result.count("file") ||
-        !result.count("pattern"))
+        (!result.count("pattern") && !result.count("patterns-file") && !result.count("db")))
     {
         std::cout << options.help() << std::endl;
         return 0;
     }
 
-    pattern = result["pattern"].as<std::string>();
+    std::vector<PatternEntry> entries;
 
-    if (!TBS::Pattern::Valid(pattern))
+    if (result.count("patterns-file"))
     {
-        printf("Pattern '%s' invalid\n", pattern.c_str());
-        return 1;
+        if (!LoadPatternsFile(result["patterns-file"].as<std::string>(), entries))
+            return 1;
+    }
+    else if (!result.count("db"))
+    {
+        pattern = result["pattern"].as<std::string>();
+
+        if (!TBS::Pattern::Valid(pattern))
+        {
+            printf("Pattern '%s' invalid\n", pattern.c_str());
+            return 1;
+        }
     }
 
     file = result["file"].as<std::string>();
 
+    bSingleRes = result["single"].as<bool>();
+    bNaked = result["naked"].as<bool>();
+    bJson = result["json"].as<bool>();
+    bRecursive = result["recursive"].as<bool>();
+    threads = result["threads"].as<size_t>();
+
+    if (result.count("glob"))
+        glob = result["glob"].as<std::string>();
+
+    bCold = result["cold"].as<bool>();
+
+    const std::string ioName = result["io"].as<std::string>();
+
+    if (ioName == "uring")
+        io = InputBackend::IoUring;
+    else if (ioName == "pread")
+        io = InputBackend::PRead;
+    else if (ioName != "mmap")
+    {
+        printf("Input backend '%s' unknown\n", ioName.c_str());
+        return 1;
+    }
+
+    if (io == InputBackend::IoUring && !FileReader::IoUringAvailable())
+    {
+        fprintf(stderr, "io_uring unavailable, falling back to pread\n");
+        io = InputBackend::PRead;
+    }
+
+    const std::filesystem::path filePath(file);
+    const bool bWildcard = filePath.filename().string().find_first_of("*?") != std::string::npos;
+
+    if (result.count("db") && (bWildcard || std::filesystem::is_directory(filePath)))
+    {
+        printf("--db scans a single file\n");
+        return 1;
+    }
+
+    if (bWildcard || std::filesystem::is_directory(filePath))
+    {
+        // Multiple files, "dir/*.so" is "dir" filtered by "*.so"
+
+        std::filesystem::path root = filePath;
+
+        if (bWildcard)
+        {
+            glob = filePath.filename().string();
+            root = filePath.has_parent_path() ? filePath.parent_path() : ".";
+        }
+
+        if (!std::filesystem::is_directory(root))
+        {
+            printf("Directory '%s' Does not exist\n", root.string().c_str());
+            return 2;
+        }
+
+        std::vector<std::string> files;
+        CollectFiles(root, glob, bRecursive, files);
+
+        if (entries.empty())
+            entries.push_back({ pattern, pattern, {}, {} });
+
+        return ScanFiles(files, entries, threads ? threads : std::thread::hardware_concurrency(), bSingleRes, bJson, io, bCold);
+    }
+
     if (!std::filesystem::exists(file))
     {
         printf("File '%s' Does not exist\n", file.c_str());
         return 2;
     }
 
-    bSingleRes = result["single"].as<bool>();
-    bNaked = result["naked"].as<bool>();
-    bJson = result["json"].as<bool>();
+    if (result.count("db"))
+        return ScanDatabase(result["db"].as<std::string>(), file, bSingleRes, bJson);
+
+    if (result["bench"].as<bool>())
+    {
+        std::vector<size_t> threadCounts;
+
+        if (result.count("bench-threads"))
+        {
+            std::istringstream list(result["bench-threads"].as<std::string>());
+
+            for (std::string count; std::getline(list, count, ','); )
+            {
+                if (std::atoi(count.c_str()) > 0)
+                    threadCounts.push_back((size_t)std::atoi(count.c_str()));
+            }
+        }
+        else
+        {
+            threadCounts.push_back(1);
+
+            if (std::thread::hardware_concurrency() > 1)
+                threadCounts.push_back(std::thread::hardware_concurrency());
+        }
+
+        if (threadCounts.empty())
+        {
+            printf("No valid thread count in '%s'\n", result["bench-threads"].as<std::string>().c_str());
+            return 1;
+        }
+
+#if defined(TBS_STATS) && !defined(TBS_MT)
+        // Counters are shared without TBS_MT, more than one scanning thread would race on them
+
+        if (std::any_of(threadCounts.begin(), threadCounts.end(), [](size_t count) { return count > 1; }))
+        {
+            fprintf(stderr, "TBS_STATS without TBS_MT, benching a single thread\n");
+            threadCounts.assign(1, 1);
+        }
+#endif
+
+        FileView benchView(file.c_str());
+
+        if (benchView.has_error()) {
+            printf("Failed to open/map file '%s'\n", file.c_str());
+            return 2;
+        }
+
+        if (entries.empty())
+            entries.push_back({ pattern, pattern, {}, {} });
+
+        return RunBench(file.c_str(), (const unsigned char*)(const void*)benchView, benchView.size(), entries,
+            result["bench-runs"].as<size_t>(), threadCounts, bJson);
+    }
+
+    if (io != InputBackend::Mmap || bCold)
+    {
+        // Single file through the reader pipeline, reported like a directory scan
+
+        if (entries.empty())
+            entries.push_back({ pattern, pattern, {}, {} });
+
+        return ScanFiles({ file }, entries, 1, bSingleRes, bJson, io, bCold);
+    }
 
     FileView fileView(file.c_str());
     
@@ -259,5 +1142,49 @@ int TBSCLI(int argc, const char* argv[])
         return 0;
         };
 
+    const auto handlePatternsFile = [&] {
+        // Every signature in a single State, scanned in one multi-pattern pass
+
+        TBS::State<> state(fileBegin, fileEnd);
+        state.setMultiPattern();
+
+        std::vector<std::string> uids;
+
+        for (const PatternEntry& entry : entries)
+        {
+            auto builder = state.PatternBuilder().setUID(entry.uid);
+
+            if (entry.raw.empty())
+                builder.setPattern(entry.pattern);
+            else
+                builder.setPatternRaw(entry.raw.data()).setMask(entry.mask.c_str());
+
+            if (bSingleRes)
+                builder.stopOnFirstMatch();
+
+            state.AddPattern(builder.Build());
+
+            if (std::find(uids.begin(), uids.end(), entry.uid) == uids.end())
+                uids.push_back(entry.uid);
+        }
+
+        const bool bAllFound = TBS::Scan(state);
+
+        std::vector<std::vector<unsigned long long>> offsets(uids.size());
+
+        for (size_t i = 0; i < uids.size(); i++)
+        {
+            for (auto res : state[uids[i]].ResultsGet())
+                offsets[i].push_back((unsigned long long)(res - (size_t)fileBegin));
+        }
+
+        PrintUIDResults(uids, offsets, bJson);
+
+        return bAllFound ? 0 : 3;
+        };
+
+    if (!entries.empty())
+        return handlePatternsFile();
+
     return (bSingleRes ? handleSingleResult() : handleMultiResult());
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <TBS/TBS.hpp>
+#include <cxxopts.hpp>
+#include "PatternsFile.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+    Compiles a patterns file (TBSCLI --patterns-file format) into a signature
+    database, parsed & planned once here, mapped & used in place by
+    TBS::Database::Reader or TBSCLI --db afterwards
+*/
+int main(int argc, const char* argv[])
+{
+    cxxopts::Options options("tbs-compile", "Precompiles TBS signatures into a mappable database");
+
+    options.add_options()
+        ("i,input", "Patterns file, one 'uid pattern' per line ('uid 488B05 xxx' for raw+mask)", cxxopts::value<std::string>())
+        ("o,output", "Database file to write", cxxopts::value<std::string>())
+        ;
+
+    options.parse_positional({ "input" });
+
+    auto result = options.parse(argc, argv);
+
+    if (!result.count("input") || !result.count("output"))
+    {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    const std::string input = result["input"].as<std::string>();
+    const std::string output = result["output"].as<std::string>();
+
+    std::vector<PatternEntry> entries;
+
+    if (!LoadPatternsFile(input, entries))
+        return 1;
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    TBS::Database::Writer writer;
+
+    for (const PatternEntry& entry : entries)
+    {
+        const bool bAdded = entry.raw.empty()
+            ? writer.Add(entry.uid, entry.pattern)
+            : writer.Add(entry.uid, entry.raw.data(), entry.mask.c_str());
+
+        if (!bAdded)
+        {
+            printf("Signature '%s' has no bytes to match\n", entry.uid.c_str());
+            return 1;
+        }
+    }
+
+    if (!writer.Write(output))
+    {
+        printf("Database '%s' could not be written\n", output.c_str());
+        return 2;
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    printf("%zu signatures compiled into '%s' in %.2f ms\n", writer.size(), output.c_str(), ms);
+
+    return 0;
+}
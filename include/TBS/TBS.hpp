@@ -24,11 +24,15 @@
 #endif
 
 #include TBS_STL_INC(string)
+#include TBS_STL_INC(string_view)
 #include TBS_STL_INC(unordered_map)
 #include TBS_STL_INC(unordered_set)
 #include TBS_STL_INC(memory)
 #include TBS_STL_INC(vector)
+#include TBS_STL_INC(algorithm)
+#include TBS_STL_INC(array)
 #include STL_ETL(<functional>, <etl/delegate.h>)
+#include <atomic>
 
 #ifdef TBS_MT
 #include <thread>
@@ -37,6 +41,27 @@
 #include <queue>
 #endif
 
+#ifdef TBS_STATS
+#include <chrono>
+#endif
+
+#ifdef TBS_TRACE
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+#if defined(__linux__)
+#include <errno.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 #ifdef TBS_USE_SSE2
 #ifndef TBS_IMPL_SSE2
 #define TBS_IMPL_SSE2
@@ -67,6 +92,7 @@
 #define TBS_IMPL_ARCH_WORD_SIMD
 #endif
 #include <emmintrin.h>
+#include <tmmintrin.h>
 #endif
 
 #ifdef TBS_IMPL_AVX
@@ -86,20 +112,20 @@
 #endif
 
 namespace TBS {
-#if defined(TBS_USE_AVX) || defined(TBS_USE_SSE2)
+#if defined(TBS_IMPL_AVX) || defined(TBS_IMPL_SSE2)
 #pragma pack(push, 1)
 	struct CPUIDData {
 		int EAX, EBX, ECX, EDX;
 	};
 #pragma pack(pop)
 
-	CPUIDData CPUID(int type)
+	inline CPUIDData CPUID(int type)
 	{
 		CPUIDData data{};
 #if defined(_MSC_VER)
-		__cpuid((int*)&data, type);
+		__cpuidex((int*)&data, type, 0);
 #elif defined(__GNUC__) || defined(__clang__) && defined(__i386__) || defined(__x86_64__)
-		__get_cpuid(type, &data.EAX, &data.EBX, &data.ECX, &data.EDX);
+		__cpuid_count(type, 0, data.EAX, data.EBX, data.ECX, data.EDX);
 #endif
 		return data;
 	}
@@ -113,6 +139,17 @@ namespace TBS {
 #define CTZ(x) __builtin_ctz(x)
 #endif
 
+/*
+	MSVC allows any intrinsic once the header is included,
+	GCC/Clang require the ISA to be enabled per function
+	so runtime dispatched kernels dont leak AVX into the rest of the TU
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define TBS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define TBS_TARGET(isa)
+#endif
+
 namespace TBS {
 	using U64 = unsigned long long;
 	using U32 = unsigned int;
@@ -137,8 +174,13 @@ namespace TBS {
 	template<U64 CAPACITY = TBS_STRING_MAX_SIZE>
 	using String = etl::string<CAPACITY>;
 
+	using StringView = etl::string_view;
+
 	template<typename T>
 	using Function = etl::delegate<T>;
+
+	template<typename T, size_t SIZE>
+	using Array = etl::array<T, SIZE>;
 #else
 	template<typename T, typename K, U64 CAPACITY = TBS_CONTAINER_MAX_SIZE>
 	using UMap = std::unordered_map<T, K>;
@@ -155,8 +197,13 @@ namespace TBS {
 	template<U64 CAPACITY = TBS_STRING_MAX_SIZE>
 	using String = std::string;
 
+	using StringView = std::string_view;
+
 	template<typename T>
 	using Function = std::function<T>;
+
+	template<typename T, size_t SIZE>
+	using Array = std::array<T, SIZE>;
 #endif
 
 	/*
@@ -169,1073 +216,7064 @@ namespace TBS {
 	*/
 	constexpr U64 PATTERN_SEARCH_SLICE_SIZE = PG_SIZE * 10;
 
-#ifdef TBS_MT
-	namespace Thread {
-		class Pool {
-		public:
-			inline Pool(size_t threads = std::thread::hardware_concurrency()) : mbStopped(false)
-			{
-				auto workerTask = [this] {
-					for (;;)
-					{
-						std::function<void()> task;
-						{
-							std::unique_lock<std::mutex> lock(mTasksMtx);
-							mWorkersCondVar.wait(lock, [this] { return mbStopped || !mTasks.empty(); });
-							if (mbStopped && mTasks.empty())
-								return;
-							task = std::move(mTasks.front());
-							mTasks.pop();
-						}
-						task();
-					}
-					};
+	/*
+		Widest enabled vector, parsed patterns are stored zero padded
+		& aligned to it, so verifying never needs a tail
+	*/
+#ifdef TBS_IMPL_AVX
+	constexpr size_t PATTERN_PADDING = 32;
+#else
+	constexpr size_t PATTERN_PADDING = 16;
+#endif
+
+#ifdef TBS_TRACE
+#ifndef TBS_TRACE_CAPACITY
+#define TBS_TRACE_CAPACITY 16384
+#endif
+
+	/*
+		Timeline of scans in the Chrome trace event format, open it in
+		chrome://tracing or ui.perfetto.dev. Each thread records complete
+		events in its own ring of TBS_TRACE_CAPACITY, the oldest get overwritten
+		once full. Scan() flushes every ring to GetOutput(), by default the
+		TBS_TRACE_FILE environment variable or "tbs_trace.json"
+	*/
+	namespace Trace {
+		constexpr size_t NAME_SIZE = 64;
+
+		struct Event {
+			char mName[NAME_SIZE];
+			const char* mCategory;
+			U64 mBeginNs;
+			U64 mEndNs;
+			UPtr mStart;	// Slice range, both 0 when the event has none
+			UPtr mEnd;
+			U64 mCount;		// Descriptions in a group, 0 when none
+		};
+
+		inline U64 NowNs()
+		{
+			return (U64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
 
-				for (size_t i = 0; i < threads; ++i)
-					mWorkers.emplace_back(workerTask);
+		struct Ring {
+			inline Ring(U32 tid)
+				: mEvents(TBS_TRACE_CAPACITY)
+				, mHead(0)
+				, mSize(0)
+				, mDropped(0)
+				, mTid(tid)
+				, mbRetired(false)
+			{
+				snprintf(mThreadName, sizeof(mThreadName), "thread %u", tid);
 			}
 
-			template<class F, class... Args>
-			inline void enqueue(F&& f, Args&&... args) {
+			inline void Push(const Event& event)
+			{
+#ifdef TBS_MT
+				std::lock_guard<std::mutex> lock(mMtx);
+#endif
+
+				mEvents[(mHead + mSize) % mEvents.size()] = event;
+
+				if (mSize < mEvents.size())
+					mSize++;
+				else
 				{
-					std::unique_lock<std::mutex> lock(mTasksMtx);
-					mTasks.emplace(std::bind(std::forward<F>(f), std::forward<Args&&>(args)...));
+					mHead = (mHead + 1) % mEvents.size();
+					mDropped++;
 				}
-				mWorkersCondVar.notify_one();
 			}
 
-			inline ~Pool() {
-				{
-					std::unique_lock<std::mutex> lock(mTasksMtx);
-					mbStopped = true;
-				}
-				mWorkersCondVar.notify_all();
-				for (std::thread& worker : mWorkers)
-					worker.join();
+			Vector<Event> mEvents;
+			size_t mHead;
+			size_t mSize;
+			U64 mDropped;
+			U32 mTid;
+			char mThreadName[NAME_SIZE];
+			bool mbRetired;
+#ifdef TBS_MT
+			std::mutex mMtx;
+#endif
+		};
+
+		/*
+			Never destroyed, pool workers outlive function statics at exit.
+			Rings of exited threads stay until their events got flushed
+		*/
+		struct Registry {
+			inline Registry()
+				: mEpochNs(NowNs())
+				, mNextTid(0)
+			{
+				const char* path = getenv("TBS_TRACE_FILE");
+
+				mOutput = path && *path ? path : "tbs_trace.json";
 			}
 
-		private:
-			Vector<std::thread> mWorkers;
-			std::queue<std::function<void()>> mTasks;
-			std::mutex mTasksMtx;
-			std::condition_variable mWorkersCondVar;
-			bool mbStopped;
+#ifdef TBS_MT
+			std::mutex mMtx;
+#endif
+			Vector<Ring*> mRings;
+			String<> mOutput;
+			U64 mEpochNs;
+			U32 mNextTid;
 		};
-	}
+
+		inline Registry& GetRegistry()
+		{
+			static Registry* registry = new Registry();
+			return *registry;
+		}
+
+		struct ThreadRing {
+			inline ThreadRing()
+			{
+				Registry& registry = GetRegistry();
+#ifdef TBS_MT
+				std::lock_guard<std::mutex> lock(registry.mMtx);
 #endif
 
-	static U64 StringLength(const char* s)
-	{
-		for (const char* i = s; ; i++)
+				mRing = new Ring(registry.mNextTid++);
+				registry.mRings.push_back(mRing);
+			}
+
+			inline ~ThreadRing()
+			{
+#ifdef TBS_MT
+				std::lock_guard<std::mutex> lock(GetRegistry().mMtx);
+#endif
+
+				mRing->mbRetired = true;
+			}
+
+			Ring* mRing;
+		};
+
+		inline Ring& Local()
 		{
-			if (!*i)
-				return (U64)(i - s);
+			thread_local ThreadRing ring;
+			return *ring.mRing;
 		}
 
-		return 0; // Should Never Get Here
-	}
+		/*
+			Row label of the calling thread in the timeline
+		*/
+		inline void NameThread(const char* name)
+		{
+			Ring& ring = Local();
+#ifdef TBS_MT
+			std::lock_guard<std::mutex> lock(ring.mMtx);
+#endif
 
-	template<typename ValueT, typename AlignementK>
-	ValueT NumberAlignToFloor(ValueT num, AlignementK alignment) {
-		return num - num % alignment;
-	}
+			snprintf(ring.mThreadName, sizeof(ring.mThreadName), "%s", name);
+		}
 
-	namespace Memory {
-		static UByte Bits4FromChar(char hex)
+		inline void SetOutput(const String<>& path)
 		{
-			if ('0' <= hex && hex <= '9') {
-				return hex - '0';
-			}
-			else if ('A' <= hex && hex <= 'F') {
-				return hex - 'A' + 10;
-			}
-			else if ('a' <= hex && hex <= 'f') {
-				return hex - 'a' + 10;
-			}
+			Registry& registry = GetRegistry();
+#ifdef TBS_MT
+			std::lock_guard<std::mutex> lock(registry.mMtx);
+#endif
 
-			return 0;
+			registry.mOutput = path;
 		}
 
-		static UByte ByteFromString(const char* byteStr)
+		inline String<> GetOutput()
 		{
-			UByte high = Bits4FromChar(byteStr[0]);
-			UByte low = Bits4FromChar(byteStr[1]);
+			Registry& registry = GetRegistry();
+#ifdef TBS_MT
+			std::lock_guard<std::mutex> lock(registry.mMtx);
+#endif
 
-			return (high << 4) | low;
+			return registry.mOutput;
 		}
 
-		inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+		/*
+			Records [begin, end) of the enclosing scope on the calling thread
+		*/
+		struct Scope {
+			inline Scope(const char* name, const char* category, const void* start = nullptr, const void* end = nullptr, U64 count = 0)
+			{
+				snprintf(mEvent.mName, sizeof(mEvent.mName), "%s", name);
+				mEvent.mCategory = category;
+				mEvent.mStart = (UPtr)start;
+				mEvent.mEnd = (UPtr)end;
+				mEvent.mCount = count;
+				mEvent.mBeginNs = NowNs();
+			}
+
+			inline ~Scope()
+			{
+				mEvent.mEndNs = NowNs();
+				Local().Push(mEvent);
+			}
+
+			Event mEvent;
+		};
+
+		static void WriteString(FILE* file, const char* str)
 		{
-			for (const UByte* i = start; i != end; ++i) {
-				if (*i != byte)
-					continue;
+			fputc('"', file);
 
-				return i;
+			for (const char* c = str; *c; c++)
+			{
+				if (*c == '"' || *c == '\\')
+					fprintf(file, "\\%c", *c);
+				else if ((unsigned char)*c < 0x20)
+					fprintf(file, "\\u%04x", (unsigned char)*c);
+				else
+					fputc(*c, file);
 			}
 
-			return nullptr; // Byte not found
+			fputc('"', file);
 		}
 
-		inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
+		/*
+			Writes the events recorded so far to `path` & empties the rings,
+			false when the file couldnt be written
+		*/
+		inline bool Flush(const String<>& path)
 		{
-			for (size_t i = 0; i < len; i++)
+			Registry& registry = GetRegistry();
+#ifdef TBS_MT
+			std::lock_guard<std::mutex> registryLock(registry.mMtx);
+#endif
+
+			FILE* file = fopen(path.c_str(), "wb");
+			U64 dropped = 0;
+			bool bFirst = true;
+
+			if (file)
+				fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+
+			for (size_t i = 0; i < registry.mRings.size(); )
 			{
-				UByte b1 = chunk1[i] & mask[i];
-				UByte b2 = chunk2[i] & mask[i];
+				Ring& ring = *registry.mRings[i];
 
-				if (b1 != b2)
-					return false;
-			}
+				{
+#ifdef TBS_MT
+					std::lock_guard<std::mutex> lock(ring.mMtx);
+#endif
 
-			return true;
-		}
+					if (file)
+					{
+						fprintf(file, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",", ring.mTid);
+						WriteString(file, ring.mThreadName);
+						fputs("}}", file);
+						bFirst = false;
 
-		namespace SIMD {
+						for (size_t k = 0; k < ring.mSize; k++)
+						{
+							const Event& event = ring.mEvents[(ring.mHead + k) % ring.mEvents.size()];
 
-			namespace Platform {
-#ifdef TBS_IMPL_ARCH_WORD_SIMD
-				inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask) {
-					// UPtr ==> Platform Word Length
-					size_t wordLen = len / sizeof(UPtr); // Calculate length in words
+							// Timestamps are in microseconds, relative to the first traced thread
 
-					for (size_t i = 0; i < wordLen; i++) {
-						// Convert byte index to word index
-						const UPtr bmask = *((const UPtr*)mask + i);
-						const UPtr maskedChunk1 = *((const UPtr*)chunk1 + i) & bmask;
-						const UPtr maskedChunk2 = *((const UPtr*)chunk2 + i) & bmask;
-						if (maskedChunk1 != maskedChunk2)
-							return false;
-					}
+							fputs(",\n{\"ph\":\"X\",\"name\":", file);
+							WriteString(file, event.mName);
+							fprintf(file, ",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+								event.mCategory, ring.mTid,
+								(double)(event.mBeginNs - registry.mEpochNs) / 1000.0,
+								(double)(event.mEndNs - event.mBeginNs) / 1000.0);
 
-					size_t remainingBytes = len % sizeof(UPtr);
+							if (event.mStart != event.mEnd || event.mCount)
+							{
+								fprintf(file, ",\"args\":{\"start\":\"0x%llx\",\"end\":\"0x%llx\",\"bytes\":%llu",
+									(U64)event.mStart, (U64)event.mEnd, (U64)(event.mEnd - event.mStart));
 
-					if (remainingBytes == 0)
-						return true;
+								if (event.mCount)
+									fprintf(file, ",\"descriptions\":%llu", event.mCount);
 
-					// Calculate the starting index of the last incomplete word
-					size_t lastWordIndex = wordLen * sizeof(UPtr);
-					return Memory::Compare(
-						chunk1 + lastWordIndex,
-						chunk2 + lastWordIndex,
-						len - lastWordIndex,
-						mask + lastWordIndex);
+								fputc('}', file);
+							}
+
+							fputc('}', file);
+						}
+					}
+
+					dropped += ring.mDropped;
+					ring.mHead = ring.mSize = 0;
+					ring.mDropped = 0;
 				}
-#endif
-			}
 
-#ifdef TBS_IMPL_SSE2
-			namespace SSE2 {
-				inline bool Supported()
+				if (ring.mbRetired)
 				{
-					auto data = TBS::CPUID(1);
-					return (data.EDX & (1 << 26)) != 0;
+					delete &ring;
+					registry.mRings.erase(registry.mRings.begin() + i);
 				}
+				else
+					i++;
+			}
 
-				static int FirstMatchingByteIndex(__m128i a, __m128i b) {
-					__m128i cmp_result = _mm_cmpeq_epi8(a, b);
+			if (!file)
+				return false;
 
-					// Convert comparison result to mask
-					int mask = _mm_movemask_epi8(cmp_result);
+			fprintf(file, "\n],\"otherData\":{\"droppedEvents\":%llu}}\n", dropped);
 
-					if (mask == 0)
-						return -1;
+			return fclose(file) == 0;
+		}
 
-					return CTZ(mask);
-				}
+		inline bool Flush()
+		{
+			return Flush(GetOutput());
+		}
+	}
 
-				inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
-				{
-					const size_t searchLen = (size_t)(end - start);
-					const size_t wordLen = searchLen / sizeof(__m128i); // Calculate length in words
+#define TBS_TRACE_SCOPE(...) TBS::Trace::Scope TBS_TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
+#define TBS_TRACE_CONCAT(a, b) TBS_TRACE_CONCAT_IMPL(a, b)
+#define TBS_TRACE_CONCAT_IMPL(a, b) a##b
+#else
+#define TBS_TRACE_SCOPE(...) ((void)0)
+#endif
 
-					__m128i searching = _mm_set1_epi8(byte);
+	namespace Thread {
+		/*
+			Intrusive unit of work, storage is owned by the submitter
+			so queuing & running tasks never allocates
+		*/
+		struct Task {
+			using RunFn = void(*)(Task&);
+
+			inline Task(RunFn run)
+				: mRun(run)
+#ifdef TBS_MT
+				, mPending(nullptr)
+#endif
+			{}
 
-					for (size_t i = 0; i < wordLen; i++) {
-						const __m128i currScanning = _mm_loadu_si128((const __m128i*) start + i);
+			RunFn mRun;
+#ifdef TBS_MT
+			std::atomic<size_t>* mPending;
+#endif
+		};
 
-						int foundIndex = FirstMatchingByteIndex(currScanning, searching);
+		/*
+			CRTP helper, DerivedT only needs a Run() member
+		*/
+		template<typename DerivedT>
+		struct TaskOf : Task {
+			inline TaskOf()
+				: Task([](Task& task) { static_cast<DerivedT&>(task).Run(); })
+			{}
+		};
 
-						if (foundIndex < 0)
-							continue;
+#ifdef TBS_MT
+		/*
+			Fixed capacity Chase-Lev deque, the owner pushes & pops at the bottom,
+			any thread steals from the top (oldest first)
+		*/
+		template<typename T, size_t CAPACITY = 1024>
+		class WorkStealingDeque {
+			static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
 
-						return (UByte*)((const __m128i*)start + i) + foundIndex;
-					}
+		public:
+			inline WorkStealingDeque()
+				: mTop(0)
+				, mBottom(0)
+			{
+				for (auto& item : mItems)
+					item.store(T(), std::memory_order_relaxed);
+			}
 
-					if (searchLen % sizeof(__m128i) == 0)
-						return nullptr;
+			// Owner only
+			inline bool Push(T item)
+			{
+				const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+				const int64_t top = mTop.load(std::memory_order_acquire);
 
-					return Memory::SearchFirst(
-						start + wordLen * sizeof(__m128i),
-						end,
-						byte); // Nothing Matched
-				}
+				if (bottom - top >= (int64_t)CAPACITY)
+					return false;
 
-				inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask) {
-					const size_t wordLen = len / sizeof(__m128i); // Calculate length in words
+				mItems[bottom & (CAPACITY - 1)].store(item, std::memory_order_relaxed);
+				mBottom.store(bottom + 1, std::memory_order_release);
+				return true;
+			}
 
-					for (size_t i = 0; i < wordLen; i++) {
-						// Convert byte index to word index
-						const __m128i wordMask = _mm_loadu_si128((const __m128i*) mask + i);
-						const __m128i maskedChunk1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)chunk1 + i), wordMask);
-						const __m128i maskedChunk2 = _mm_and_si128(_mm_loadu_si128((const __m128i*)chunk2 + i), wordMask);
+			// Owner only
+			inline bool Pop(T& item)
+			{
+				const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+				mBottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = mTop.load(std::memory_order_relaxed);
 
-						if (_mm_movemask_epi8(_mm_cmpeq_epi32(maskedChunk1, maskedChunk2)) != 0xFFFF)
-							return false;
-					}
+				if (top > bottom)
+				{
+					mBottom.store(bottom + 1, std::memory_order_relaxed);
+					return false;
+				}
 
-					size_t remainingBytes = len % sizeof(__m128i);
+				item = mItems[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
 
-					if (remainingBytes == 0)
-						return true;
+				if (top != bottom)
+					return true;
 
-					const size_t lastWordIndex = wordLen * sizeof(__m128i);
+				// At this point, last item, racing against thieves
 
-					return Platform::Compare(
-						chunk1 + lastWordIndex,
-						chunk2 + lastWordIndex,
-						len % sizeof(__m128i),
-						mask + lastWordIndex);
-				}
+				const bool bWon = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				mBottom.store(bottom + 1, std::memory_order_relaxed);
+				return bWon;
 			}
-#endif
 
+			// Any thread
+			inline bool Steal(T& item)
+			{
+				int64_t top = mTop.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = mBottom.load(std::memory_order_acquire);
 
-#ifdef TBS_IMPL_AVX
-			namespace AVX
+				if (top >= bottom)
+					return false;
+
+				item = mItems[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+
+				return mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			}
+
+			inline bool Empty() const
 			{
-				inline bool Supported()
-				{
-					auto data = TBS::CPUID(1);
-					return ((data.ECX & (1 << 27)) != 0) &&
-						((data.ECX & (1 << 28)) != 0);
-				}
+				return mTop.load(std::memory_order_acquire) >= mBottom.load(std::memory_order_acquire);
+			}
 
-				inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
-				{
-					/*Unimplemented Falling back to SSE2*/
-					return SSE2::SearchFirst(
-						start,
-						end,
-						byte);
-				}
+		private:
+			alignas(64) std::atomic<int64_t> mTop;
+			alignas(64) std::atomic<int64_t> mBottom;
+			alignas(64) std::atomic<T> mItems[CAPACITY];
+		};
 
-				inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
-				{
-					/*Unimplemented Falling back to SSE2*/
-					return SSE2::Compare(
-						chunk1,
-						chunk2,
-						len,
-						mask);
-				}
-			} // namespace AVX
+		/*
+			Long lived work stealing pool, every worker owns a deque & steals
+			from the others when its own runs dry. Threads calling Run() claim
+			one of the submitter deques, push their tasks there & help executing
+			them in submission order until all of them completed.
+		*/
+		class Pool {
+		public:
+			static constexpr size_t SUBMITTER_SLOTS = 8;
+			static constexpr U32 IDLE_SPINS = 64;
 
-			namespace AVX2 {
-				inline bool Supported()
+			static Pool& Instance()
+			{
+				static Pool pool;
+				return pool;
+			}
+
+			/*
+				The calling thread always helps, so one worker less than cores
+			*/
+			static size_t DefaultWorkerCount()
+			{
+#ifdef TBS_MT_WORKERS
+				return TBS_MT_WORKERS;
+#else
+				const size_t cores = std::thread::hardware_concurrency();
+
+				return cores > 1 ? cores - 1 : 0;
+#endif
+			}
+
+			inline Pool(size_t threads = DefaultWorkerCount())
+				: mEpoch(0)
+				, mbStopped(false)
+			{
+				TBS_TRACE_SCOPE("Pool startup", "pool");
+
+				for (size_t i = 0; i < threads + SUBMITTER_SLOTS; i++)
+					mDeques.emplace_back(new DequeT());
+
+				for (auto& claimed : mSubmitterClaimed)
+					claimed.store(false, std::memory_order_relaxed);
+
+				for (size_t i = 0; i < threads; i++)
+					mWorkers.emplace_back([this, i] { WorkerLoop(i); });
+			}
+
+			inline ~Pool()
+			{
 				{
-					return AVX::Supported()
-						&& (TBS::CPUID(7).ECX & (1 << 5)) != 0;
+					std::lock_guard<std::mutex> lock(mSleepMtx);
+					mbStopped = true;
 				}
 
-				static int FirstMatchingByteIndex(__m256i a, __m256i b) {
-					__m256i cmp_result = _mm256_cmpeq_epi8(a, b);
+				mWakeCondVar.notify_all();
 
-					// Convert comparison result to mask
-					int mask = _mm256_movemask_epi8(cmp_result);
+				for (std::thread& worker : mWorkers)
+					worker.join();
+			}
 
-					if (mask == 0)
-						return -1;
+			inline size_t WorkerCount() const
+			{
+				return mWorkers.size();
+			}
 
-					return CTZ(mask);
-				}
+			/*
+				Index of the calling worker, WorkerCount() for any other thread
+			*/
+			inline size_t CurrentWorker() const
+			{
+				const WorkerIdentity& self = tlsIdentity();
 
-				inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
-				{
-					const size_t searchLen = (size_t)(end - start);
-					const size_t wordLen = searchLen / sizeof(__m256i); // Calculate length in words
+				return self.mPool == this ? self.mIndex : mWorkers.size();
+			}
 
-					__m256i searching = _mm256_set1_epi8(byte);
+			/*
+				Runs tasks[0, count) to completion, TaskT must derive from Task
+			*/
+			template<typename TaskT>
+			inline void Run(TaskT* tasks, size_t count)
+			{
+				if (count == 0)
+					return;
 
-					for (size_t i = 0; i < wordLen; i++) {
-						const __m256i currScanning = _mm256_loadu_si256((const __m256i*) start + i);
+				// Workers submitting from inside a task use their own deque,
+				// any other thread claims a submitter one
 
-						int foundIndex = FirstMatchingByteIndex(currScanning, searching);
+				const WorkerIdentity& self = tlsIdentity();
+				size_t slot = SUBMITTER_SLOTS;
+				DequeT* ownDeque = nullptr;
 
-						if (foundIndex < 0)
-							continue;
+				if (self.mPool == this)
+					ownDeque = mDeques[self.mIndex].get();
+				else if ((slot = ClaimSubmitterSlot()) != SUBMITTER_SLOTS)
+					ownDeque = mDeques[mWorkers.size() + slot].get();
 
-						return (UByte*)((const __m256i*)start + i) + foundIndex;
-					}
+				if (ownDeque == nullptr || mWorkers.empty())
+				{
+					// At this point, nobody else could help, lets run inline
 
-					if (searchLen % sizeof(__m256i) == 0)
-						return nullptr;
+					for (size_t i = 0; i < count; i++)
+						tasks[i].mRun(tasks[i]);
 
-					return SSE2::SearchFirst(start + wordLen * sizeof(__m256i), end, byte); // Nothing Matched
+					if (slot != SUBMITTER_SLOTS)
+						mSubmitterClaimed[slot].store(false, std::memory_order_release);
+
+					return;
 				}
 
-				inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
+				DequeT& deque = *ownDeque;
+				std::atomic<size_t> pending(count);
+
+				for (size_t i = 0; i < count; )
 				{
-					const size_t wordLen = len / sizeof(__m256i); // Calculate length in words
+					Task* task = &tasks[i];
+					task->mPending = &pending;
 
-					for (size_t i = 0; i < wordLen; i++)
+					if (deque.Push(task))
 					{
-						// Convert byte index to word index
-						const __m256i wordMask = _mm256_loadu_si256((const __m256i*) mask + i);
-						const __m256i maskedChunk1 = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) chunk1 + i), wordMask);
-						const __m256i maskedChunk2 = _mm256_and_si256(_mm256_loadu_si256((const __m256i*) chunk2 + i), wordMask);
+						if (++i % DequeT::WAKE_BATCH == 1 || i == count)
+							Wake();
 
-						if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(maskedChunk1, maskedChunk2)) != 0xFFFFFFFF)
-							return false;
+						continue;
 					}
 
-					size_t remainingBytes = len % sizeof(__m256i);
+					// At this point, the deque is full, lets help draining it
 
-					if (remainingBytes == 0)
-						return true;
+					if (deque.Steal(task))
+						Execute(*task);
+				}
 
-					const size_t lastWordIndex = wordLen * sizeof(__m256i);
+				for (U32 spins = 0; pending.load(std::memory_order_acquire) != 0; )
+				{
+					Task* task = nullptr;
 
-					return SSE2::Compare(
-						chunk1 + lastWordIndex,
-						chunk2 + lastWordIndex,
-						len % sizeof(__m256i),
-						mask + lastWordIndex);
+					if (deque.Steal(task))
+					{
+						Execute(*task);
+						spins = 0;
+						continue;
+					}
+
+					// At this point, every task was taken, just waiting for thieves to finish
+
+					if (++spins > IDLE_SPINS)
+						std::this_thread::yield();
 				}
+
+				if (slot != SUBMITTER_SLOTS)
+					mSubmitterClaimed[slot].store(false, std::memory_order_release);
 			}
-#endif
-		}
 
-		template<typename T = UPtr>
-		struct Slice {
-			using PtrTypeT = T;
-			using SliceT = Slice<T>;
+		private:
+			struct DequeT : WorkStealingDeque<Task*> {
+				static constexpr size_t WAKE_BATCH = 16;
+			};
 
-			inline Slice(PtrTypeT start, PtrTypeT end)
-				: mStart(start)
-				, mEnd(end)
-			{}
+			struct WorkerIdentity {
+				const Pool* mPool;
+				size_t mIndex;
+			};
 
-			inline bool operator==(const SliceT& other) const
+			static inline WorkerIdentity& tlsIdentity()
 			{
-				return
-					mStart == other.mStart &&
-					mEnd == other.mEnd;
+				static thread_local WorkerIdentity identity{ nullptr, 0 };
+				return identity;
 			}
 
-			inline bool operator!=(const SliceT& other) const
+			static inline void Execute(Task& task)
 			{
-				return !(*this == other);
+				std::atomic<size_t>* pending = task.mPending;
+
+				task.mRun(task);
+				pending->fetch_sub(1, std::memory_order_release);
 			}
 
-			PtrTypeT mStart;
-			PtrTypeT mEnd;
+			inline size_t ClaimSubmitterSlot()
+			{
+				for (size_t slot = 0; slot < SUBMITTER_SLOTS; slot++)
+				{
+					bool expected = false;
 
-			struct Container {
-				inline Container(PtrTypeT start, PtrTypeT end, U64 step)
-					: mStart(start)
-					, mEnd(end < start ? start : end)
-					, mStep(step)
-				{}
+					if (mSubmitterClaimed[slot].compare_exchange_strong(expected, true, std::memory_order_acquire))
+						return slot;
+				}
 
-				struct Iterator {
-					inline Iterator(PtrTypeT start, U64 step, PtrTypeT end)
-						: mSlice(SliceT(start, (PtrTypeT)((UByte*)start + step)))
-						, mStep(step)
-						, mEnd(end)
+				return SUBMITTER_SLOTS;
+			}
+
+			inline void Wake()
+			{
+				{
+					// Under the lock, so sleepers cant miss it between checking & waiting
+					std::lock_guard<std::mutex> lock(mSleepMtx);
+					mEpoch.fetch_add(1, std::memory_order_release);
+				}
+
+				mWakeCondVar.notify_all();
+			}
+
+			inline bool StealAny(size_t self, Task*& task)
+			{
+				const size_t count = mDeques.size();
+
+				for (size_t i = 1; i <= count; i++)
+				{
+					if (mDeques[(self + i) % count]->Steal(task))
+						return true;
+				}
+
+				return false;
+			}
+
+			inline void WorkerLoop(size_t self)
+			{
+				tlsIdentity() = WorkerIdentity{ this, self };
+
+#ifdef TBS_TRACE
+				char threadName[Trace::NAME_SIZE];
+				snprintf(threadName, sizeof(threadName), "worker %zu", self);
+				Trace::NameThread(threadName);
+#endif
+
+				DequeT& deque = *mDeques[self];
+
+				for (U32 spins = 0; ; )
+				{
+					// Read before looking for work, any later submission changes it
+					const U64 epoch = mEpoch.load(std::memory_order_acquire);
+
+					Task* task = nullptr;
+
+					if (deque.Pop(task) || StealAny(self, task))
 					{
-						Normalize();
+						Execute(*task);
+						spins = 0;
+						continue;
 					}
 
-					inline SliceT operator*() const
+					if (++spins < IDLE_SPINS)
 					{
-						return mSlice;
+						std::this_thread::yield();
+						continue;
 					}
 
-					inline void Normalize()
-					{
-						if (mSlice.mStart > mEnd)
-							mSlice.mStart = mEnd;
+					// At this point, nothing to do for a while, lets sleep until next submission
 
-						if (mSlice.mEnd > mEnd)
-							mSlice.mEnd = mEnd;
-					}
+					std::unique_lock<std::mutex> lock(mSleepMtx);
+					mWakeCondVar.wait(lock, [this, epoch] { return mbStopped || mEpoch.load(std::memory_order_relaxed) != epoch; });
 
-					inline Iterator& operator++()
-					{
-						mSlice.mStart = (PtrTypeT)((UByte*)mSlice.mStart + mStep);
-						mSlice.mEnd = (PtrTypeT)((UByte*)mSlice.mEnd + mStep);
+					if (mbStopped)
+						return;
 
-						Normalize();
+					spins = 0;
+				}
+			}
 
-						return *this;
-					}
+			Vector<UniquePtr<DequeT>> mDeques;
+			std::atomic<bool> mSubmitterClaimed[SUBMITTER_SLOTS];
+			Vector<std::thread> mWorkers;
+			std::mutex mSleepMtx;
+			std::condition_variable mWakeCondVar;
+			std::atomic<U64> mEpoch;
+			bool mbStopped;
+		};
+#endif
 
-					inline bool operator==(const Iterator& other) const {
-						return mSlice == other.mSlice;
-					}
+		/*
+			Threads of the process wide pool, submitters not included
+		*/
+		inline size_t WorkerCount()
+		{
+#ifdef TBS_MT
+			return Pool::Instance().WorkerCount();
+#else
+			return 0;
+#endif
+		}
 
-					inline bool operator!=(const Iterator& other) const {
-						return !(*this == other);
-					}
+		/*
+			Pool worker index of the calling thread, WorkerCount() when it is none
+		*/
+		inline size_t CurrentWorker()
+		{
+#ifdef TBS_MT
+			return Pool::Instance().CurrentWorker();
+#else
+			return 0;
+#endif
+		}
 
-					SliceT mSlice;
-					PtrTypeT mEnd;
-					U64 mStep;
-				};
+		/*
+			Runs tasks[0, count) to completion, spread over the process wide pool under TBS_MT
+		*/
+		template<typename TaskT>
+		inline void Run(TaskT* tasks, size_t count)
+		{
+			TBS_TRACE_SCOPE("Run tasks", "pool");
+
+#ifdef TBS_MT
+			Pool::Instance().Run(tasks, count);
+#else
+			for (size_t i = 0; i < count; i++)
+				tasks[i].mRun(tasks[i]);
+#endif
+		}
+	}
+
+	static U64 StringLength(const char* s)
+	{
+		for (const char* i = s; ; i++)
+		{
+			if (!*i)
+				return (U64)(i - s);
+		}
+
+		return 0; // Should Never Get Here
+	}
+
+	template<typename ValueT, typename AlignementK>
+	ValueT NumberAlignToFloor(ValueT num, AlignementK alignment) {
+		return num - num % alignment;
+	}
+
+	namespace Memory {
+		static constexpr bool IsHex(char c)
+		{
+			return ('0' <= c && c <= '9') || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f');
+		}
+
+		static UByte Bits4FromChar(char hex)
+		{
+			if ('0' <= hex && hex <= '9') {
+				return hex - '0';
+			}
+			else if ('A' <= hex && hex <= 'F') {
+				return hex - 'A' + 10;
+			}
+			else if ('a' <= hex && hex <= 'f') {
+				return hex - 'a' + 10;
+			}
+
+			return 0;
+		}
+
+		inline UByte ByteFromString(const char* byteStr)
+		{
+			UByte high = Bits4FromChar(byteStr[0]);
+			UByte low = Bits4FromChar(byteStr[1]);
+
+			return (high << 4) | low;
+		}
+
+		inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+		{
+			for (const UByte* i = start; i != end; ++i) {
+				if (*i != byte)
+					continue;
+
+				return i;
+			}
+
+			return nullptr; // Byte not found
+		}
+
+		inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
+		{
+			for (size_t i = 0; i < len; i++)
+			{
+				UByte b1 = chunk1[i] & mask[i];
+				UByte b2 = chunk2[i] & mask[i];
+
+				if (b1 != b2)
+					return false;
+			}
+
+			return true;
+		}
+
+		/*
+			Reports through `onCandidate(i)` every i in [start, end) where
+			i[off1] == byte1 && i[off2] == byte2, reads up to end - 1 + max(off1, off2).
+			Returns false if `onCandidate` aborted.
+		*/
+		template<typename OnCandidateT>
+		inline bool SearchAnchors(const UByte* start, const UByte* end, size_t off1, UByte byte1, size_t off2, UByte byte2, OnCandidateT&& onCandidate)
+		{
+			for (const UByte* i = start; i < end; i++)
+			{
+				if (i[off1] != byte1 || i[off2] != byte2)
+					continue;
+
+				if (!onCandidate(i))
+					return false;
+			}
+
+			return true;
+		}
+
+		/*
+			Change detection fingerprint, not meant to resist adversaries. Four 64 bit lanes
+			each accumulate (w ^ key).low * (w ^ key).high + w over the words of every
+			32 byte stripe, laid out so the SSE2 & AVX2 kernels produce the very same value.
+			Keys advance by HASH_STRIPE_STEP every stripe, so moving or swapping stripes
+			changes the value too
+		*/
+		constexpr U64 HASH_KEYS[4] = { 0xBE4BA423396CFEB8ull, 0x1CAD21F72C81017Cull, 0xDB979083E96DD4DEull, 0x1F67B3B7A4A44072ull };
+		constexpr U64 HASH_PRIME = 0x9E3779B97F4A7C15ull;
+		constexpr U64 HASH_STRIPE_STEP = 0xC2B2AE3D27D4EB4Full;
+		constexpr size_t HASH_STRIPE = 32;
+
+		/*
+			Folds the lanes, the trailing `tailLen` bytes past the last stripe & the length
+		*/
+		inline U64 HashFinish(const U64* lanes, const UByte* tail, size_t tailLen, size_t len)
+		{
+			U64 hash = len * HASH_PRIME;
+
+			for (size_t i = 0; i < 4; i++)
+			{
+				hash ^= lanes[i] + HASH_KEYS[i];
+				hash = ((hash << 31) | (hash >> 33)) * HASH_PRIME;
+			}
+
+			for (size_t i = 0; i < tailLen; i++)
+				hash = (hash ^ tail[i]) * HASH_PRIME;
+
+			// At this point, murmur3 fmix64 so every input bit reaches every output bit
+
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ull;
+			hash ^= hash >> 33;
+
+			return hash;
+		}
+
+		inline U64 Hash(const UByte* start, size_t len)
+		{
+			U64 lanes[4] = {};
+			U64 keys[4] = { HASH_KEYS[0], HASH_KEYS[1], HASH_KEYS[2], HASH_KEYS[3] };
+			const size_t stripes = len / HASH_STRIPE;
+
+			for (size_t i = 0; i < stripes; i++)
+			{
+				for (size_t k = 0; k < 4; k++)
+				{
+					U64 word;
+					memcpy(&word, start + i * HASH_STRIPE + k * sizeof(U64), sizeof(word));
+
+					const U64 mixed = word ^ keys[k];
+					lanes[k] += (mixed & 0xFFFFFFFFull) * (mixed >> 32) + word;
+					keys[k] += HASH_STRIPE_STEP;
+				}
+			}
+
+			return HashFinish(lanes, start + stripes * HASH_STRIPE, len % HASH_STRIPE, len);
+		}
+
+		namespace SIMD {
+
+			namespace Platform {
+#ifdef TBS_IMPL_ARCH_WORD_SIMD
+				inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask) {
+					// UPtr ==> Platform Word Length
+					size_t wordLen = len / sizeof(UPtr); // Calculate length in words
+
+					for (size_t i = 0; i < wordLen; i++) {
+						// Convert byte index to word index
+						const UPtr bmask = *((const UPtr*)mask + i);
+						const UPtr maskedChunk1 = *((const UPtr*)chunk1 + i) & bmask;
+						const UPtr maskedChunk2 = *((const UPtr*)chunk2 + i) & bmask;
+						if (maskedChunk1 != maskedChunk2)
+							return false;
+					}
+
+					size_t remainingBytes = len % sizeof(UPtr);
+
+					if (remainingBytes == 0)
+						return true;
+
+					// Calculate the starting index of the last incomplete word
+					size_t lastWordIndex = wordLen * sizeof(UPtr);
+					return Memory::Compare(
+						chunk1 + lastWordIndex,
+						chunk2 + lastWordIndex,
+						len - lastWordIndex,
+						mask + lastWordIndex);
+				}
+#endif
+			}
+
+#ifdef TBS_IMPL_SSE2
+			namespace SSE2 {
+				inline bool Supported()
+				{
+					auto data = TBS::CPUID(1);
+					return (data.EDX & (1 << 26)) != 0;
+				}
+
+				TBS_TARGET("sse2") static int FirstMatchingByteIndex(__m128i a, __m128i b) {
+					__m128i cmp_result = _mm_cmpeq_epi8(a, b);
+
+					// Convert comparison result to mask
+					int mask = _mm_movemask_epi8(cmp_result);
+
+					if (mask == 0)
+						return -1;
+
+					return CTZ(mask);
+				}
+
+				TBS_TARGET("sse2") inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+				{
+					const size_t searchLen = (size_t)(end - start);
+					const size_t wordLen = searchLen / sizeof(__m128i); // Calculate length in words
+
+					__m128i searching = _mm_set1_epi8(byte);
+
+					for (size_t i = 0; i < wordLen; i++) {
+						const __m128i currScanning = _mm_loadu_si128((const __m128i*) start + i);
+
+						int foundIndex = FirstMatchingByteIndex(currScanning, searching);
+
+						if (foundIndex < 0)
+							continue;
+
+						return (UByte*)((const __m128i*)start + i) + foundIndex;
+					}
+
+					if (searchLen % sizeof(__m128i) == 0)
+						return nullptr;
+
+					return Memory::SearchFirst(
+						start + wordLen * sizeof(__m128i),
+						end,
+						byte); // Nothing Matched
+				}
+
+				TBS_TARGET("sse2") inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask) {
+					const size_t wordLen = len / sizeof(__m128i); // Calculate length in words
+
+					for (size_t i = 0; i < wordLen; i++) {
+						// Convert byte index to word index
+						const __m128i wordMask = _mm_loadu_si128((const __m128i*) mask + i);
+						const __m128i maskedChunk1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)chunk1 + i), wordMask);
+						const __m128i maskedChunk2 = _mm_and_si128(_mm_loadu_si128((const __m128i*)chunk2 + i), wordMask);
+
+						if (_mm_movemask_epi8(_mm_cmpeq_epi32(maskedChunk1, maskedChunk2)) != 0xFFFF)
+							return false;
+					}
+
+					size_t remainingBytes = len % sizeof(__m128i);
+
+					if (remainingBytes == 0)
+						return true;
+
+					const size_t lastWordIndex = wordLen * sizeof(__m128i);
+
+					return Platform::Compare(
+						chunk1 + lastWordIndex,
+						chunk2 + lastWordIndex,
+						len % sizeof(__m128i),
+						mask + lastWordIndex);
+				}
+
+				/*
+					Whole vector masked compare, no tail handling, reads VECTORS * 16 bytes
+					of all three, so `pattern` & `mask` must be zero padded up to that
+				*/
+				template<size_t VECTORS>
+				TBS_TARGET("sse2") inline bool CompareVectors(const UByte* chunk, const UByte* pattern, const UByte* mask)
+				{
+					for (size_t i = 0; i < VECTORS; i++)
+					{
+						const __m128i masked = _mm_and_si128(_mm_loadu_si128((const __m128i*)chunk + i), _mm_loadu_si128((const __m128i*)mask + i));
+
+						if (_mm_movemask_epi8(_mm_cmpeq_epi8(masked, _mm_loadu_si128((const __m128i*)pattern + i))) != 0xFFFF)
+							return false;
+					}
+
+					return true;
+				}
+
+				/*
+					CompareVectors over the fewest vectors, at most MAX_VECTORS, covering `len` bytes
+				*/
+				template<size_t MAX_VECTORS>
+				TBS_TARGET("sse2") inline bool CompareVectorsUpTo(const UByte* chunk, const UByte* pattern, const UByte* mask, size_t len)
+				{
+					if constexpr (MAX_VECTORS > 1)
+					{
+						if (len <= (MAX_VECTORS - 1) * sizeof(__m128i))
+							return CompareVectorsUpTo<MAX_VECTORS - 1>(chunk, pattern, mask, len);
+					}
+
+					return CompareVectors<MAX_VECTORS>(chunk, pattern, mask);
+				}
+
+				/*
+					Masked compare of `len`, a multiple of 16, bytes, `pattern` & `mask` 16 bytes aligned.
+					Differences are accumulated, so there is a single movemask test at the end
+				*/
+				TBS_TARGET("sse2") inline bool ComparePadded(const UByte* chunk, const UByte* pattern, const UByte* mask, size_t len)
+				{
+					__m128i diff = _mm_setzero_si128();
+
+					for (size_t i = 0; i < len / sizeof(__m128i); i++)
+					{
+						const __m128i bytes = _mm_xor_si128(_mm_loadu_si128((const __m128i*)chunk + i), _mm_load_si128((const __m128i*)pattern + i));
+
+						diff = _mm_or_si128(diff, _mm_and_si128(bytes, _mm_load_si128((const __m128i*)mask + i)));
+					}
+
+					return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+				}
+
+				/*
+					Vectorized Memory::SearchAnchors, both anchors are tested per 16 bytes block
+					& the resulting candidate bitmask is walked with CTZ, no reloading per candidate
+				*/
+				template<typename OnCandidateT>
+				TBS_TARGET("sse2") inline bool SearchAnchors(const UByte* start, const UByte* end, size_t off1, UByte byte1, size_t off2, UByte byte2, OnCandidateT&& onCandidate)
+				{
+					const __m128i anchor1 = _mm_set1_epi8((char)byte1);
+					const __m128i anchor2 = _mm_set1_epi8((char)byte2);
+					const bool bDual = off1 != off2 || byte1 != byte2;
+
+					for (; end - start >= (ptrdiff_t)sizeof(__m128i); start += sizeof(__m128i))
+					{
+						U32 candidates = (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(start + off1)), anchor1));
+
+						if (candidates && bDual)
+							candidates &= (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(start + off2)), anchor2));
+
+						for (; candidates; candidates &= candidates - 1)
+						{
+							if (!onCandidate(start + CTZ(candidates)))
+								return false;
+						}
+					}
+
+					return Memory::SearchAnchors(start, end, off1, byte1, off2, byte2, onCandidate);
+				}
+
+				inline bool SupportedSSSE3()
+				{
+					return (TBS::CPUID(1).ECX & (1 << 9)) != 0;
+				}
+
+				/*
+					Nibble fingerprint sweep (Teddy style), for every position in [start, end)
+					ANDs the bucket bits of the `len` leading bytes looked up by low & high nibble,
+					non-zero lanes are reported to `onCandidate(position, buckets)`.
+					pshufb is SSSE3, dispatch only when SupportedSSSE3() holds.
+					Returns where the vector loop stopped, or nullptr if `onCandidate` aborted.
+				*/
+				template<typename OnCandidateT>
+				TBS_TARGET("ssse3") inline const UByte* Fingerprint(const UByte* start, const UByte* end, const UByte* limit,
+					const UByte(*lo)[16], const UByte(*hi)[16], size_t len, OnCandidateT&& onCandidate)
+				{
+					const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+					const __m128i zero = _mm_setzero_si128();
+
+					for (; end - start >= (ptrdiff_t)sizeof(__m128i) && limit - start >= (ptrdiff_t)(sizeof(__m128i) + len - 1); start += sizeof(__m128i))
+					{
+						__m128i buckets = _mm_set1_epi8(-1);
+
+						for (size_t k = 0; k < len; k++)
+						{
+							const __m128i data = _mm_loadu_si128((const __m128i*)(start + k));
+							const __m128i loNibbles = _mm_and_si128(data, nibbleMask);
+							const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi16(data, 4), nibbleMask);
+
+							buckets = _mm_and_si128(buckets, _mm_and_si128(
+								_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)lo[k]), loNibbles),
+								_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hi[k]), hiNibbles)));
+						}
+
+						U32 candidates = ~(U32)_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, zero)) & 0xFFFFu;
+
+						if (candidates == 0)
+							continue;
+
+						alignas(16) UByte lanes[sizeof(__m128i)];
+						_mm_store_si128((__m128i*)lanes, buckets);
+
+						for (; candidates; candidates &= candidates - 1)
+						{
+							const U32 lane = CTZ(candidates);
+
+							if (!onCandidate(start + lane, lanes[lane]))
+								return nullptr;
+						}
+					}
+
+					return start;
+				}
+
+				/*
+					Memory::Hash, two lanes per vector
+				*/
+				TBS_TARGET("sse2") inline U64 Hash(const UByte* start, size_t len)
+				{
+					const __m128i step = _mm_set1_epi64x((long long)HASH_STRIPE_STEP);
+					__m128i key0 = _mm_set_epi64x((long long)HASH_KEYS[1], (long long)HASH_KEYS[0]);
+					__m128i key1 = _mm_set_epi64x((long long)HASH_KEYS[3], (long long)HASH_KEYS[2]);
+					__m128i acc0 = _mm_setzero_si128();
+					__m128i acc1 = _mm_setzero_si128();
+					const size_t stripes = len / HASH_STRIPE;
+
+					for (size_t i = 0; i < stripes; i++)
+					{
+						const __m128i data0 = _mm_loadu_si128((const __m128i*)(start + i * HASH_STRIPE));
+						const __m128i data1 = _mm_loadu_si128((const __m128i*)(start + i * HASH_STRIPE + sizeof(__m128i)));
+						const __m128i mixed0 = _mm_xor_si128(data0, key0);
+						const __m128i mixed1 = _mm_xor_si128(data1, key1);
+
+						acc0 = _mm_add_epi64(acc0, _mm_add_epi64(_mm_mul_epu32(mixed0, _mm_srli_epi64(mixed0, 32)), data0));
+						acc1 = _mm_add_epi64(acc1, _mm_add_epi64(_mm_mul_epu32(mixed1, _mm_srli_epi64(mixed1, 32)), data1));
+						key0 = _mm_add_epi64(key0, step);
+						key1 = _mm_add_epi64(key1, step);
+					}
+
+					alignas(16) U64 lanes[4];
+					_mm_store_si128((__m128i*)lanes, acc0);
+					_mm_store_si128((__m128i*)(lanes + 2), acc1);
+
+					return HashFinish(lanes, start + stripes * HASH_STRIPE, len % HASH_STRIPE, len);
+				}
+			}
+#endif
+
+
+#ifdef TBS_IMPL_AVX
+			namespace AVX
+			{
+				inline bool Supported()
+				{
+					auto data = TBS::CPUID(1);
+					return ((data.ECX & (1 << 27)) != 0) &&
+						((data.ECX & (1 << 28)) != 0);
+				}
+
+				inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+				{
+					/*AVX has no 256 bit integer compares, 128 bit lanes are as wide as SSE2*/
+					return SSE2::SearchFirst(
+						start,
+						end,
+						byte);
+				}
+
+				/*
+					AVX does have 256 bit bitwise ops & vptest,
+					so the masked difference is tested in a single instruction
+				*/
+				TBS_TARGET("avx") inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
+				{
+					const size_t wordLen = len / sizeof(__m256i); // Calculate length in words
+
+					for (size_t i = 0; i < wordLen; i++)
+					{
+						const __m256 diff = _mm256_xor_ps(
+							_mm256_loadu_ps((const float*)((const __m256i*)chunk1 + i)),
+							_mm256_loadu_ps((const float*)((const __m256i*)chunk2 + i)));
+
+						if (!_mm256_testz_si256(_mm256_castps_si256(diff), _mm256_loadu_si256((const __m256i*)mask + i)))
+							return false;
+					}
+
+					const size_t lastWordIndex = wordLen * sizeof(__m256i);
+
+					if (lastWordIndex == len)
+						return true;
+
+					return SSE2::Compare(
+						chunk1 + lastWordIndex,
+						chunk2 + lastWordIndex,
+						len - lastWordIndex,
+						mask + lastWordIndex);
+				}
+			} // namespace AVX
+
+			namespace AVX2 {
+				inline bool Supported()
+				{
+					return AVX::Supported()
+						&& (TBS::CPUID(7).EBX & (1 << 5)) != 0;
+				}
+
+				TBS_TARGET("avx2") static int FirstMatchingByteIndex(__m256i a, __m256i b) {
+					__m256i cmp_result = _mm256_cmpeq_epi8(a, b);
+
+					// Convert comparison result to mask
+					int mask = _mm256_movemask_epi8(cmp_result);
+
+					if (mask == 0)
+						return -1;
+
+					return CTZ(mask);
+				}
+
+				TBS_TARGET("avx2") inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+				{
+					const size_t searchLen = (size_t)(end - start);
+					const size_t wordLen = searchLen / sizeof(__m256i); // Calculate length in words
+
+					__m256i searching = _mm256_set1_epi8(byte);
+
+					for (size_t i = 0; i < wordLen; i++) {
+						const __m256i currScanning = _mm256_loadu_si256((const __m256i*) start + i);
+
+						int foundIndex = FirstMatchingByteIndex(currScanning, searching);
+
+						if (foundIndex < 0)
+							continue;
+
+						return (UByte*)((const __m256i*)start + i) + foundIndex;
+					}
+
+					if (searchLen % sizeof(__m256i) == 0)
+						return nullptr;
+
+					return SSE2::SearchFirst(start + wordLen * sizeof(__m256i), end, byte); // Nothing Matched
+				}
+
+				TBS_TARGET("avx2") inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* mask)
+				{
+					const size_t wordLen = len / sizeof(__m256i); // Calculate length in words
+
+					for (size_t i = 0; i < wordLen; i++)
+					{
+						// Masked difference must be all zero
+						const __m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) chunk1 + i), _mm256_loadu_si256((const __m256i*) chunk2 + i));
+
+						if (!_mm256_testz_si256(diff, _mm256_loadu_si256((const __m256i*) mask + i)))
+							return false;
+					}
+
+					size_t remainingBytes = len % sizeof(__m256i);
+
+					if (remainingBytes == 0)
+						return true;
+
+					const size_t lastWordIndex = wordLen * sizeof(__m256i);
+
+					return SSE2::Compare(
+						chunk1 + lastWordIndex,
+						chunk2 + lastWordIndex,
+						len % sizeof(__m256i),
+						mask + lastWordIndex);
+				}
+
+				/*
+					32 bytes wide version of SSE2::ComparePadded, same contract
+				*/
+				TBS_TARGET("avx2") inline bool ComparePadded(const UByte* chunk, const UByte* pattern, const UByte* mask, size_t len)
+				{
+					__m256i diff = _mm256_setzero_si256();
+
+					for (size_t i = 0; i < len / sizeof(__m256i); i++)
+					{
+						const __m256i bytes = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)chunk + i), _mm256_load_si256((const __m256i*)pattern + i));
+
+						diff = _mm256_or_si256(diff, _mm256_and_si256(bytes, _mm256_load_si256((const __m256i*)mask + i)));
+					}
+
+					return _mm256_testz_si256(diff, diff);
+				}
+
+				/*
+					32 bytes wide version of SSE2::CompareVectors, same contract
+				*/
+				template<size_t VECTORS>
+				TBS_TARGET("avx2") inline bool CompareVectors(const UByte* chunk, const UByte* pattern, const UByte* mask)
+				{
+					for (size_t i = 0; i < VECTORS; i++)
+					{
+						const __m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)chunk + i), _mm256_loadu_si256((const __m256i*)pattern + i));
+
+						if (!_mm256_testz_si256(diff, _mm256_loadu_si256((const __m256i*)mask + i)))
+							return false;
+					}
+
+					return true;
+				}
+
+				/*
+					32 bytes wide version of SSE2::CompareVectorsUpTo, same contract
+				*/
+				template<size_t MAX_VECTORS>
+				TBS_TARGET("avx2") inline bool CompareVectorsUpTo(const UByte* chunk, const UByte* pattern, const UByte* mask, size_t len)
+				{
+					if constexpr (MAX_VECTORS > 1)
+					{
+						if (len <= (MAX_VECTORS - 1) * sizeof(__m256i))
+							return CompareVectorsUpTo<MAX_VECTORS - 1>(chunk, pattern, mask, len);
+					}
+
+					return CompareVectors<MAX_VECTORS>(chunk, pattern, mask);
+				}
+
+				/*
+					32 lanes wide version of SSE2::SearchAnchors, same contract
+				*/
+				template<typename OnCandidateT>
+				TBS_TARGET("avx2") inline bool SearchAnchors(const UByte* start, const UByte* end, size_t off1, UByte byte1, size_t off2, UByte byte2, OnCandidateT&& onCandidate)
+				{
+					const __m256i anchor1 = _mm256_set1_epi8((char)byte1);
+					const __m256i anchor2 = _mm256_set1_epi8((char)byte2);
+					const bool bDual = off1 != off2 || byte1 != byte2;
+
+					for (; end - start >= (ptrdiff_t)sizeof(__m256i); start += sizeof(__m256i))
+					{
+						U32 candidates = (U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(start + off1)), anchor1));
+
+						if (candidates && bDual)
+							candidates &= (U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(start + off2)), anchor2));
+
+						for (; candidates; candidates &= candidates - 1)
+						{
+							if (!onCandidate(start + CTZ(candidates)))
+								return false;
+						}
+					}
+
+					return SSE2::SearchAnchors(start, end, off1, byte1, off2, byte2, onCandidate);
+				}
+
+				/*
+					32 lanes wide version of SSE2::Fingerprint, same contract
+				*/
+				template<typename OnCandidateT>
+				TBS_TARGET("avx2") inline const UByte* Fingerprint(const UByte* start, const UByte* end, const UByte* limit,
+					const UByte(*lo)[16], const UByte(*hi)[16], size_t len, OnCandidateT&& onCandidate)
+				{
+					const __m256i nibbleMask = _mm256_set1_epi8(0x0F);
+					const __m256i zero = _mm256_setzero_si256();
+
+					for (; end - start >= (ptrdiff_t)sizeof(__m256i) && limit - start >= (ptrdiff_t)(sizeof(__m256i) + len - 1); start += sizeof(__m256i))
+					{
+						__m256i buckets = _mm256_set1_epi8(-1);
+
+						for (size_t k = 0; k < len; k++)
+						{
+							const __m256i data = _mm256_loadu_si256((const __m256i*)(start + k));
+							const __m256i loNibbles = _mm256_and_si256(data, nibbleMask);
+							const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi16(data, 4), nibbleMask);
+
+							buckets = _mm256_and_si256(buckets, _mm256_and_si256(
+								_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)lo[k])), loNibbles),
+								_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)hi[k])), hiNibbles)));
+						}
+
+						U32 candidates = ~(U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, zero));
+
+						if (candidates == 0)
+							continue;
+
+						alignas(32) UByte lanes[sizeof(__m256i)];
+						_mm256_store_si256((__m256i*)lanes, buckets);
+
+						for (; candidates; candidates &= candidates - 1)
+						{
+							const U32 lane = CTZ(candidates);
+
+							if (!onCandidate(start + lane, lanes[lane]))
+								return nullptr;
+						}
+					}
+
+					return start;
+				}
+
+				/*
+					Memory::Hash, a whole stripe per vector
+				*/
+				TBS_TARGET("avx2") inline U64 Hash(const UByte* start, size_t len)
+				{
+					const __m256i step = _mm256_set1_epi64x((long long)HASH_STRIPE_STEP);
+					__m256i key = _mm256_set_epi64x((long long)HASH_KEYS[3], (long long)HASH_KEYS[2], (long long)HASH_KEYS[1], (long long)HASH_KEYS[0]);
+					__m256i acc = _mm256_setzero_si256();
+					const size_t stripes = len / HASH_STRIPE;
+
+					for (size_t i = 0; i < stripes; i++)
+					{
+						const __m256i data = _mm256_loadu_si256((const __m256i*)(start + i * HASH_STRIPE));
+						const __m256i mixed = _mm256_xor_si256(data, key);
+
+						acc = _mm256_add_epi64(acc, _mm256_add_epi64(_mm256_mul_epu32(mixed, _mm256_srli_epi64(mixed, 32)), data));
+						key = _mm256_add_epi64(key, step);
+					}
+
+					alignas(32) U64 lanes[4];
+					_mm256_store_si256((__m256i*)lanes, acc);
+
+					return HashFinish(lanes, start + stripes * HASH_STRIPE, len % HASH_STRIPE, len);
+				}
+			}
+#endif
+		}
+
+		template<typename T = UPtr>
+		struct Slice {
+			using PtrTypeT = T;
+			using SliceT = Slice<T>;
+
+			inline Slice(PtrTypeT start, PtrTypeT end)
+				: mStart(start)
+				, mEnd(end)
+			{}
+
+			inline bool operator==(const SliceT& other) const
+			{
+				return
+					mStart == other.mStart &&
+					mEnd == other.mEnd;
+			}
+
+			inline bool operator!=(const SliceT& other) const
+			{
+				return !(*this == other);
+			}
+
+			PtrTypeT mStart;
+			PtrTypeT mEnd;
+
+			struct Container {
+				inline Container(PtrTypeT start, PtrTypeT end, U64 step)
+					: mStart(start)
+					, mEnd(end < start ? start : end)
+					, mStep(step)
+				{}
+
+				struct Iterator {
+					inline Iterator(PtrTypeT start, U64 step, PtrTypeT end)
+						: mSlice(SliceT(start, (PtrTypeT)((UByte*)start + step)))
+						, mStep(step)
+						, mEnd(end)
+					{
+						Normalize();
+					}
+
+					inline SliceT operator*() const
+					{
+						return mSlice;
+					}
+
+					inline void Normalize()
+					{
+						if (mSlice.mStart > mEnd)
+							mSlice.mStart = mEnd;
+
+						if (mSlice.mEnd > mEnd)
+							mSlice.mEnd = mEnd;
+					}
+
+					inline Iterator& operator++()
+					{
+						mSlice.mStart = (PtrTypeT)((UByte*)mSlice.mStart + mStep);
+						mSlice.mEnd = (PtrTypeT)((UByte*)mSlice.mEnd + mStep);
+
+						Normalize();
+
+						return *this;
+					}
+
+					inline bool operator==(const Iterator& other) const {
+						return mSlice == other.mSlice;
+					}
+
+					inline bool operator!=(const Iterator& other) const {
+						return !(*this == other);
+					}
+
+					SliceT mSlice;
+					PtrTypeT mEnd;
+					U64 mStep;
+				};
+
+				inline Iterator begin() const {
+					return Iterator(mStart, mStep, mEnd);
+				}
+
+				inline Iterator end() const {
+					return Iterator(mEnd, mStep, mEnd);
+				}
+
+				PtrTypeT mStart;
+				PtrTypeT mEnd;
+				U64 mStep;
+			};
+		};
+	}
+
+#ifdef TBS_STATS
+	/*
+		Search counters, kept per thread so the hot paths only ever bump
+		their own, Get() sums every thread, exited ones included.
+		Get() & Reset() while nothing is scanning. Without TBS_MT a single
+		set is shared, so only one thread may scan at a time.
+	*/
+	namespace Stats {
+		struct Counters {
+			U64 mBytes = 0;			// Bytes searched
+			U64 mCandidates = 0;	// Positions passing the anchor, skip or fingerprint search
+			U64 mCompares = 0;		// Full pattern compares
+			U64 mMatches = 0;
+			U64 mTransformNs = 0;	// Within result transformers
+			U64 mLockWaitNs = 0;	// Acquiring result locks
+
+			inline Counters& operator+=(const Counters& other)
+			{
+				mBytes += other.mBytes;
+				mCandidates += other.mCandidates;
+				mCompares += other.mCompares;
+				mMatches += other.mMatches;
+				mTransformNs += other.mTransformNs;
+				mLockWaitNs += other.mLockWaitNs;
+				return *this;
+			}
+
+			inline Counters& operator-=(const Counters& other)
+			{
+				mBytes -= other.mBytes;
+				mCandidates -= other.mCandidates;
+				mCompares -= other.mCompares;
+				mMatches -= other.mMatches;
+				mTransformNs -= other.mTransformNs;
+				mLockWaitNs -= other.mLockWaitNs;
+				return *this;
+			}
+		};
+
+		inline U64 NowNs()
+		{
+			return (U64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+#ifdef TBS_MT
+		struct Registry {
+			std::mutex mMtx;
+			Vector<Counters*> mLive;
+			Counters mRetired;
+		};
+
+		/*
+			Never destroyed, pool workers outlive function statics at exit
+		*/
+		inline Registry& GetRegistry()
+		{
+			static Registry* registry = new Registry();
+			return *registry;
+		}
+
+		struct ThreadCounters : Counters {
+			inline ThreadCounters()
+			{
+				std::lock_guard<std::mutex> lock(GetRegistry().mMtx);
+				GetRegistry().mLive.push_back(this);
+			}
+
+			inline ~ThreadCounters()
+			{
+				Registry& registry = GetRegistry();
+				std::lock_guard<std::mutex> lock(registry.mMtx);
+
+				registry.mRetired += *this;
+				registry.mLive.erase(std::find(registry.mLive.begin(), registry.mLive.end(), this));
+			}
+		};
+
+		inline Counters& Local()
+		{
+			thread_local ThreadCounters counters;
+			return counters;
+		}
+
+		inline Counters Get()
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mMtx);
+			Counters total = registry.mRetired;
+
+			for (Counters* counters : registry.mLive)
+				total += *counters;
+
+			return total;
+		}
+
+		inline void Reset()
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mMtx);
+
+			registry.mRetired = Counters();
+
+			for (Counters* counters : registry.mLive)
+				*counters = Counters();
+		}
+#else
+		inline Counters& Local()
+		{
+			static Counters counters;
+			return counters;
+		}
+
+		inline Counters Get()
+		{
+			return Local();
+		}
+
+		inline void Reset()
+		{
+			Local() = Counters();
+		}
+#endif
+
+		/*
+			Per description counters, summed over every range & slice sharing its UID
+		*/
+		struct DescriptionStats : Counters {
+			U64 mSlices = 0;
+		};
+
+		struct WorkerStats {
+			U64 mTasks = 0;
+			U64 mBusyNs = 0;
+		};
+
+		/*
+			Per State counters, accumulated over every Scan() of it. In multi-pattern
+			groups candidates, compares & transformer time are only known per group,
+			so they show up in mTotal but not per description.
+			mWorkers has one entry per pool worker, the last one is the submitting threads
+		*/
+		struct StateStats {
+			Counters mTotal;
+			U64 mScans = 0;
+			U64 mSlices = 0;
+			U64 mScanNs = 0;
+			U64 mPagesHashed = 0;	// Incremental scans only
+			U64 mPagesDirty = 0;
+			U64 mGroupsCompiled = 0;	// Multi-pattern groups, reusable States compile each once
+			Vector<WorkerStats> mWorkers;
+		};
+
+		/*
+			What the current thread counted & how long it was busy while in scope
+		*/
+		struct TaskScope {
+			inline TaskScope(Counters& counters, WorkerStats& worker)
+				: mCounters(counters)
+				, mWorker(worker)
+				, mBefore(Local())
+				, mStartNs(NowNs())
+			{}
+
+			inline ~TaskScope()
+			{
+				Counters delta = Local();
+				delta -= mBefore;
+
+				mCounters += delta;
+				mWorker.mTasks++;
+				mWorker.mBusyNs += NowNs() - mStartNs;
+			}
+
+			Counters& mCounters;
+			WorkerStats& mWorker;
+			Counters mBefore;
+			U64 mStartNs;
+		};
+	}
+
+#define TBS_STATS_ADD(counter, n) (TBS::Stats::Local().counter += (n))
+#else
+#define TBS_STATS_ADD(counter, n) ((void)0)
+#endif
+
+	/*
+		Instruction set the runtime dispatched kernels below go with. Auto picks
+		the best one supported, forcing another is meant for benchmarks & tests.
+		Switch only while nothing is scanning, patterns parsed before keep the
+		plan they were built with.
+	*/
+	enum class Kernel : U32 {
+		Auto,
+		Scalar,
+		Platform,	// Arch word compares, scalar searches
+		SSE2,
+		AVX2
+	};
+
+	namespace Dispatch {
+		enum : U32 {
+			USE_AVX2 = 1 << 0,
+			USE_AVX = 1 << 1,	// Without AVX2 only has float 256 bit ops, never forced
+			USE_SSE2 = 1 << 2,
+			USE_SSSE3 = 1 << 3,
+			USE_PLATFORM = 1 << 4,
+			UNRESOLVED = 1u << 31
+		};
+
+		inline std::atomic<Kernel>& Forced()
+		{
+			static std::atomic<Kernel> kernel{ Kernel::Auto };
+			return kernel;
+		}
+
+		/*
+			USE_* kernels going with `forced` on this CPU
+		*/
+		inline U32 Resolve(Kernel forced)
+		{
+			U32 use = 0;
+
+#ifdef TBS_IMPL_AVX
+			if (Memory::SIMD::AVX2::Supported() && (forced == Kernel::Auto || forced == Kernel::AVX2))
+				use |= USE_AVX2;
+
+			if (Memory::SIMD::AVX::Supported() && forced == Kernel::Auto)
+				use |= USE_AVX;
+#endif
+
+#ifdef TBS_IMPL_SSE2
+			if (forced == Kernel::Auto || forced == Kernel::SSE2)
+			{
+				if (Memory::SIMD::SSE2::Supported())
+					use |= USE_SSE2;
+
+				if (Memory::SIMD::SSE2::SupportedSSSE3())
+					use |= USE_SSSE3;
+			}
+#endif
+
+#if defined(TBS_USE_ARCH_WORD_SIMD)
+			if (forced == Kernel::Auto || forced == Kernel::Platform)
+				use |= USE_PLATFORM;
+#elif defined(TBS_IMPL_ARCH_WORD_SIMD)
+			if (forced == Kernel::Platform)
+				use |= USE_PLATFORM;
+#endif
+
+			(void)forced;
+			return use;
+		}
+
+		/*
+			Resolved on first use & by every SetKernel, the hot paths only do a relaxed load
+		*/
+		inline std::atomic<U32>& Selected()
+		{
+			static std::atomic<U32> use{ UNRESOLVED };
+			return use;
+		}
+
+		inline U32 Use()
+		{
+			U32 use = Selected().load(std::memory_order_relaxed);
+
+			if (use & UNRESOLVED)
+			{
+				use = Resolve(Forced().load(std::memory_order_relaxed));
+				Selected().store(use, std::memory_order_relaxed);
+			}
+
+			return use;
+		}
+
+		inline bool UseAVX2()
+		{
+			return (Use() & USE_AVX2) != 0;
+		}
+
+		inline bool UseAVX()
+		{
+			return (Use() & USE_AVX) != 0;
+		}
+
+		inline bool UseSSE2()
+		{
+			return (Use() & USE_SSE2) != 0;
+		}
+
+		inline bool UseSSSE3()
+		{
+			return (Use() & USE_SSSE3) != 0;
+		}
+
+		inline bool UsePlatform()
+		{
+			return (Use() & USE_PLATFORM) != 0;
+		}
+	}
+
+	inline bool KernelAvailable(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::Auto:
+		case Kernel::Scalar:
+			return true;
+		case Kernel::Platform:
+#ifdef TBS_IMPL_ARCH_WORD_SIMD
+			return true;
+#else
+			return false;
+#endif
+		case Kernel::SSE2:
+#ifdef TBS_IMPL_SSE2
+			return Memory::SIMD::SSE2::Supported();
+#else
+			return false;
+#endif
+		case Kernel::AVX2:
+#ifdef TBS_IMPL_AVX
+			return Memory::SIMD::AVX2::Supported();
+#else
+			return false;
+#endif
+		}
+
+		return false;
+	}
+
+	inline const char* KernelName(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::Scalar: return "Scalar";
+		case Kernel::Platform: return "Platform";
+		case Kernel::SSE2: return "SSE2";
+		case Kernel::AVX2: return "AVX2";
+		default: return "Auto";
+		}
+	}
+
+	/*
+		False, leaving the current one, when `kernel` isnt available
+	*/
+	inline bool SetKernel(Kernel kernel)
+	{
+		if (!KernelAvailable(kernel))
+			return false;
+
+		Dispatch::Forced().store(kernel, std::memory_order_relaxed);
+		Dispatch::Selected().store(Dispatch::Resolve(kernel), std::memory_order_relaxed);
+		return true;
+	}
+
+	inline Kernel GetKernel()
+	{
+		return Dispatch::Forced().load(std::memory_order_relaxed);
+	}
+
+	inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* compareMask)
+	{
+#ifdef TBS_IMPL_AVX
+		if (Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::Compare(chunk1, chunk2, len, compareMask);
+
+		if (Dispatch::UseAVX())
+			return Memory::SIMD::AVX::Compare(chunk1, chunk2, len, compareMask);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		if (Dispatch::UseSSE2())
+			return Memory::SIMD::SSE2::Compare(chunk1, chunk2, len, compareMask);
+#endif
+
+#ifdef TBS_IMPL_ARCH_WORD_SIMD
+		if (Dispatch::UsePlatform())
+			return Memory::SIMD::Platform::Compare(chunk1, chunk2, len, compareMask);
+#endif
+
+		return Memory::Compare(chunk1, chunk2, len, compareMask);
+	}
+
+	/*
+		Runtime dispatched compare of patterns stored as ParseResult pads them,
+		`len` multiple of PATTERN_PADDING & `pattern`, `mask` aligned to it
+	*/
+	inline bool ComparePadded(const UByte* chunk, const UByte* pattern, const UByte* mask, size_t len)
+	{
+#ifdef TBS_IMPL_AVX
+		if (Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::ComparePadded(chunk, pattern, mask, len);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		if (Dispatch::UseSSE2())
+			return Memory::SIMD::SSE2::ComparePadded(chunk, pattern, mask, len);
+#endif
+
+#ifdef TBS_IMPL_ARCH_WORD_SIMD
+		if (Dispatch::UsePlatform())
+			return Memory::SIMD::Platform::Compare(chunk, pattern, len, mask);
+#endif
+
+		return Memory::Compare(chunk, pattern, len, mask);
+	}
+
+	/*
+		Runtime dispatched Memory::Hash, same value whatever the kernel
+	*/
+	inline U64 Hash(const UByte* start, size_t len)
+	{
+#ifdef TBS_IMPL_AVX
+		if (Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::Hash(start, len);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		if (Dispatch::UseSSE2())
+			return Memory::SIMD::SSE2::Hash(start, len);
+#endif
+
+		return Memory::Hash(start, len);
+	}
+
+	/*
+		Compare specialized for patterns of at most `N` bytes, whose pattern & mask are
+		zero padded a whole vector past `N` (see Pattern::Compiled), then the vector count
+		is bounded at compile time & there is no tail. Vectors are counted from `len`,
+		the trimmed size, loads start at the trimmed pattern so they stay within the
+		padding. Only within a vector of `end`, up to where `chunk` is readable,
+		the `len` bytes get compared byte-wise
+	*/
+	template<size_t N>
+	inline bool CompareFixed(const UByte* chunk, const UByte* end, const UByte* pattern, size_t len, const UByte* mask)
+	{
+#ifdef TBS_IMPL_AVX
+		constexpr size_t AVX2_VECTORS = (N + sizeof(__m256i) - 1) / sizeof(__m256i);
+		const size_t avx2Len = (len + sizeof(__m256i) - 1) / sizeof(__m256i) * sizeof(__m256i);
+
+		if (N > sizeof(__m128i) && len > sizeof(__m128i) && end - chunk >= (ptrdiff_t)avx2Len && Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::CompareVectorsUpTo<AVX2_VECTORS>(chunk, pattern, mask, len);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		constexpr size_t SSE2_VECTORS = (N + sizeof(__m128i) - 1) / sizeof(__m128i);
+		const size_t sse2Len = (len + sizeof(__m128i) - 1) / sizeof(__m128i) * sizeof(__m128i);
+
+		if (end - chunk >= (ptrdiff_t)sse2Len && (Dispatch::UseSSE2() || Dispatch::UseAVX2()))
+			return Memory::SIMD::SSE2::CompareVectorsUpTo<SSE2_VECTORS>(chunk, pattern, mask, len);
+#endif
+
+		(void)end;	// Only the vector paths bound their loads with it
+
+		return Memory::Compare(chunk, pattern, len, mask);
+	}
+
+	inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
+	{
+		if (start >= end)
+			return nullptr;
+
+#ifdef TBS_IMPL_AVX
+		if (Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::SearchFirst(start, end, byte);
+
+		if (Dispatch::UseAVX())
+			return Memory::SIMD::AVX::SearchFirst(start, end, byte);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		if (Dispatch::UseSSE2())
+			return Memory::SIMD::SSE2::SearchFirst(start, end, byte);
+#endif
+
+		return Memory::SearchFirst(start, end, byte);
+	}
+
+	/*
+		Runtime dispatched Memory::SearchAnchors, for single anchor searches
+		pass the same offset & byte twice
+	*/
+	template<typename OnCandidateT>
+	inline bool SearchAnchors(const UByte* start, const UByte* end, size_t off1, UByte byte1, size_t off2, UByte byte2, OnCandidateT&& onCandidate)
+	{
+		if (start >= end)
+			return true;
+
+#ifdef TBS_IMPL_AVX
+		if (Dispatch::UseAVX2())
+			return Memory::SIMD::AVX2::SearchAnchors(start, end, off1, byte1, off2, byte2, onCandidate);
+#endif
+
+#ifdef TBS_IMPL_SSE2
+		if (Dispatch::UseSSE2() || Dispatch::UseAVX())
+			return Memory::SIMD::SSE2::SearchAnchors(start, end, off1, byte1, off2, byte2, onCandidate);
+#endif
+
+		return Memory::SearchAnchors(start, end, off1, byte1, off2, byte2, onCandidate);
+	}
+
+	namespace Pattern
+	{
+		using Result = TBS_RESULT_TYPE;
+		using Results = Vector<Result>;
+
+		/*
+			Byte value distribution of the data being scanned,
+			used to estimate how often a pattern byte will hit
+		*/
+		struct Histogram {
+			inline Histogram()
+				: mTotal(0)
+			{
+				memset(mCounts, 0, sizeof(mCounts));
+			}
+
+			/*
+				Approximation of x86-64 machine code, opcodes, REX prefixes,
+				ModRM & small displacements dominate, rest is assumed uniform
+			*/
+			static constexpr UByte HOT_BYTES[] = {
+				0x00, 0xFF, 0x48, 0x8B, 0x89, 0x24, 0x0F, 0x44, 0x4C, 0xE8,
+				0x8D, 0x85, 0x01, 0x83, 0x74, 0xC3, 0x45, 0x08, 0x10, 0x49,
+				0xC0, 0x75, 0x41, 0x20, 0x4D, 0x84, 0xCC, 0x90, 0x40, 0x18,
+				0x5C, 0x28, 0x38, 0x30, 0xE9, 0xC7, 0xEB, 0x02, 0x04, 0x03,
+			};
+
+			static constexpr U64 DefaultCount(U32 value)
+			{
+				U64 count = 16;
+
+				for (U32 rank = 0; rank < sizeof(HOT_BYTES); rank++)
+				{
+					if (HOT_BYTES[rank] == value)
+						count += 4096 / (rank + 1);
+				}
+
+				return count;
+			}
+
+			static constexpr U64 DefaultTotal()
+			{
+				U64 total = 256 * 16;
+
+				for (U32 rank = 0; rank < sizeof(HOT_BYTES); rank++)
+					total += 4096 / (rank + 1);
+
+				return total;
+			}
+
+			/*
+				Probability() under Default(), for plans built at compile time
+			*/
+			static constexpr double DefaultProbability(UByte value, UByte mask)
+			{
+				if (mask == 0x00)
+					return 1.0;
+
+				U64 hits = 0;
+
+				if (mask == 0xFF)
+					hits = DefaultCount(value);
+				else for (U32 i = 0; i < 256; i++)
+				{
+					if ((i & mask) == value)
+						hits += DefaultCount(i);
+				}
+
+				return double(hits + 1) / double(DefaultTotal() + 256);
+			}
+
+			static const Histogram& Default()
+			{
+				static const Histogram x86 = [] {
+					Histogram histogram;
+
+					for (U32 i = 0; i < 256; i++)
+					{
+						histogram.mCounts[i] = DefaultCount(i);
+						histogram.mTotal += histogram.mCounts[i];
+					}
+
+					return histogram;
+					}();
+
+				return x86;
+			}
+
+			/*
+				Counts byte values of [start, end), visiting at most `maxSampled`
+				bytes spread in blocks across the whole range.
+				Four sub tables break the store to load dependency on repeated values
+			*/
+			inline Histogram& Sample(const UByte* start, const UByte* end, size_t maxSampled = PG_SIZE * 64)
+			{
+				if (start >= end)
+					return *this;
+
+				const size_t len = (size_t)(end - start);
+				const size_t blockLen = PG_SIZE / 4;
+				const size_t blocks = len <= maxSampled ? 1 : maxSampled / blockLen;
+				const size_t stride = len <= maxSampled ? len : len / blocks;
+				const size_t sampledLen = len <= maxSampled ? len : blockLen;
+
+				U64 counts[4][256] = {};
+
+				for (size_t block = 0; block < blocks; block++)
+				{
+					const UByte* i = start + block * stride;
+					const UByte* blockEnd = i + sampledLen;
+
+					for (; blockEnd - i >= 4; i += 4)
+					{
+						counts[0][i[0]]++;
+						counts[1][i[1]]++;
+						counts[2][i[2]]++;
+						counts[3][i[3]]++;
+					}
+
+					for (; i < blockEnd; i++)
+						counts[0][*i]++;
+				}
+
+				for (U32 i = 0; i < 256; i++)
+				{
+					const U64 count = counts[0][i] + counts[1][i] + counts[2][i] + counts[3][i];
+					mCounts[i] += count;
+					mTotal += count;
+				}
+
+				return *this;
+			}
+
+			/*
+				Probability of a random byte satisfying (byte & mask) == value
+			*/
+			inline double Probability(UByte value, UByte mask) const
+			{
+				if (mask == 0x00)
+					return 1.0;
+
+				U64 hits = 0;
+
+				if (mask == 0xFF)
+					hits = mCounts[value];
+				else for (U32 i = 0; i < 256; i++)
+				{
+					if ((i & mask) == value)
+						hits += mCounts[i];
+				}
+
+				// Smoothed, so bytes never seen on a small sample arent deemed impossible
+
+				return double(hits + 1) / double(mTotal + 256);
+			}
+
+			U64 mCounts[256];
+			U64 mTotal;
+		};
+
+		/*
+			How a pattern gets searched, offsets are relative to the trimmed pattern.
+			The anchor is the rarest solid byte (searched for with SearchFirst),
+			mAnchor2 the second rarest one checked right after, then mVerifyOrder
+			holds the rest of the non-wildcard offsets, most selective first.
+			Long patterns may instead be searched skipping (Horspool) over
+			their longest run without full byte wildcards, see mSkip.
+		*/
+		struct Plan {
+			/*
+				Verify order entries checked one by one before the full Compare
+			*/
+			static constexpr size_t EARLY_REJECT_CHECKS = 4;
+
+			/*
+				Shorter runs cant skip far enough to be worth it, longer ones are cut
+				so shifts fit a byte
+			*/
+			static constexpr size_t SKIP_MIN_LEN = 16;
+			static constexpr size_t SKIP_MAX_LEN = 255;
+
+			/*
+				Expected bytes skipped per step, under the plan histogram, for skipping
+				to beat the anchor search SearchAnchors dispatches to. A skip step is
+				a dependent load chain while the anchor search goes a whole vector per step
+			*/
+			static double SkipMinExpectedShift()
+			{
+				if (Dispatch::UseAVX2())
+					return 160.0;
+
+				if (Dispatch::UseSSE2() || Dispatch::UseAVX())
+					return 80.0;
+
+				return 8.0;
+			}
+
+			inline Plan()
+				: mAnchor(0)
+				, mAnchor2(0)
+				, mSolidAnchor(false)
+				, mSkip(false)
+				, mSkipStart(0)
+				, mSkipLen(0)
+			{}
+
+			inline bool HasSecondAnchor() const
+			{
+				return mSolidAnchor && mAnchor2 != mAnchor;
+			}
+
+			inline bool UseSkip() const
+			{
+				return mSkip;
+			}
+
+			size_t mAnchor;
+			size_t mAnchor2;
+			Vector<U32> mVerifyOrder;
+			bool mSolidAnchor;
+
+			/*
+				Horspool over [mSkipStart, mSkipStart + mSkipLen), wildcard aware,
+				a byte value shifts by the distance from the run last byte
+				to the last earlier position it can match (nibble masks included)
+			*/
+			bool mSkip;
+			size_t mSkipStart;
+			size_t mSkipLen;
+			UByte mSkipShift[256] = {};
+		};
+
+		struct ParseResult {
+			inline ParseResult()
+				: mParseSuccess(false)
+				, mTrimmDisp(0)
+			{}
+
+			inline operator bool()
+			{
+				return mParseSuccess;
+			}
+
+			/*
+				Back to an empty, unparsed result, keeping the storage
+			*/
+			inline void Clear()
+			{
+				mPattern.clear();
+				mCompareMask.clear();
+				mPaddedPattern.clear();
+				mPaddedCompareMask.clear();
+				mTrimmDisp = 0;
+				mParseSuccess = false;
+			}
+
+			struct alignas(PATTERN_PADDING) PaddedBlock {
+				UByte mBytes[PATTERN_PADDING];
+			};
+
+			Vector<UByte> mPattern;
+			Vector<UByte> mCompareMask;
+			size_t mTrimmDisp;
+			bool mParseSuccess;
+			Plan mPlan;
+
+			/*
+				Trimmed pattern & mask again, zero padded up to whole PaddedBlocks
+			*/
+			Vector<PaddedBlock> mPaddedPattern;
+			Vector<PaddedBlock> mPaddedCompareMask;
+
+			inline void Pad()
+			{
+				const size_t size = getTrimmedSize();
+				const size_t blocks = (size + PATTERN_PADDING - 1) / PATTERN_PADDING;
+
+				mPaddedPattern.assign(blocks, PaddedBlock{});
+				mPaddedCompareMask.assign(blocks, PaddedBlock{});
+
+				if (size == 0)
+					return;
+
+				memcpy(mPaddedPattern.data(), getTrimmedPattern(), size);
+				memcpy(mPaddedCompareMask.data(), getTrimmedCompareMask(), size);
+			}
+
+			inline bool IsPadded() const
+			{
+				return getPaddedSize() >= getTrimmedSize() && !mPaddedPattern.empty();
+			}
+
+			inline const UByte* getPaddedPattern() const
+			{
+				return mPaddedPattern.data()->mBytes;
+			}
+
+			inline const UByte* getPaddedCompareMask() const
+			{
+				return mPaddedCompareMask.data()->mBytes;
+			}
+
+			/*
+				Bytes read per padded compare, from the candidate on
+			*/
+			inline size_t getPaddedSize() const
+			{
+				return mPaddedPattern.size() * PATTERN_PADDING;
+			}
+
+			inline UByte* getTrimmedPattern()
+			{
+				return mPattern.data() + mTrimmDisp;
+			}
+
+			inline UByte* getTrimmedCompareMask()
+			{
+				return mCompareMask.data() + mTrimmDisp;
+			}
+
+			inline const UByte* getTrimmedPattern() const
+			{
+				return mPattern.data() + mTrimmDisp;
+			}
+
+			inline const UByte* getTrimmedCompareMask() const
+			{
+				return mCompareMask.data() + mTrimmDisp;
+			}
+
+			inline size_t getTrimmedSize() const
+			{
+				return mPattern.size() - mTrimmDisp;
+			}
+
+			inline bool TrimmedIsFirstTrullySolid() const
+			{
+				return getTrimmedCompareMask()[0] == 0xFF;
+			}
+		};
+
+		/*
+			Stable insertion sort of the `count` offsets of `order`, least probable first,
+			so on ties earlier offsets go first
+		*/
+		constexpr void SortBySelectivity(U32* order, size_t count, const double* probabilities)
+		{
+			for (size_t i = 1; i < count; i++)
+			{
+				const U32 offset = order[i];
+				size_t j = i;
+
+				for (; j > 0 && probabilities[offset] < probabilities[order[j - 1]]; j--)
+					order[j] = order[j - 1];
+
+				order[j] = offset;
+			}
+		}
+
+		/*
+			Longest run without full byte wildcards, those would cap every shift,
+			cut to Plan::SKIP_MAX_LEN. `runLen` is 0 when there is none
+		*/
+		constexpr void LongestRun(const UByte* mask, size_t patternSize, size_t& runStart, size_t& runLen)
+		{
+			runStart = 0;
+			runLen = 0;
+
+			for (size_t i = 0; i < patternSize;)
+			{
+				if (mask[i] == 0x00)
+				{
+					i++;
+					continue;
+				}
+
+				size_t j = i;
+
+				for (; j < patternSize && mask[j] != 0x00; j++)
+					;
+
+				if (j - i > runLen)
+				{
+					runStart = i;
+					runLen = j - i;
+				}
+
+				i = j;
+			}
+
+			if (runLen > Plan::SKIP_MAX_LEN)
+			{
+				runStart += runLen - Plan::SKIP_MAX_LEN;
+				runLen = Plan::SKIP_MAX_LEN;
+			}
+		}
+
+		/*
+			Horspool shifts of the run [runStart, runStart + runLen) into `shifts`.
+			Later positions overwrite earlier ones, leaving the shortest shift
+		*/
+		constexpr void SkipShifts(const UByte* pattern, const UByte* mask, size_t runStart, size_t runLen, UByte* shifts)
+		{
+			for (U32 c = 0; c < 256; c++)
+				shifts[c] = UByte(runLen);
+
+			for (size_t j = 0; j + 1 < runLen; j++)
+			{
+				const UByte value = pattern[runStart + j];
+				const UByte byteMask = mask[runStart + j];
+				const UByte shift = UByte(runLen - 1 - j);
+
+				if (byteMask == 0xFF)
+				{
+					shifts[value] = shift;
+					continue;
+				}
+
+				for (U32 c = 0; c < 256; c++)
+				{
+					if ((c & byteMask) == value)
+						shifts[c] = shift;
+				}
+			}
+		}
+
+		/*
+			Picks anchors & verification order of `parsed` by selectivity under `histogram`,
+			into `plan` reusing its storage
+		*/
+		static void BuildPlan(const UByte* pattern, const UByte* mask, size_t patternSize, const Histogram& histogram, Plan& plan)
+		{
+			Vector<U32> verifyOrder;
+			verifyOrder.swap(plan.mVerifyOrder);
+			verifyOrder.clear();
+
+			plan = Plan();
+
+			// Signatures rarely get longer, longer ones spill to the heap
+
+			constexpr size_t STACK_PROBABILITIES = 128;
+			double stackProbabilities[STACK_PROBABILITIES];
+			Vector<double> heapProbabilities;
+			double* probabilities = stackProbabilities;
+
+			if (patternSize > STACK_PROBABILITIES)
+			{
+				heapProbabilities.resize(patternSize);
+				probabilities = heapProbabilities.data();
+			}
+
+			verifyOrder.reserve(patternSize);
+
+			for (U32 i = 0; i < (U32)patternSize; i++)
+			{
+				probabilities[i] = histogram.Probability(pattern[i], mask[i]);
+
+				if (mask[i] != 0x00)
+					verifyOrder.push_back(i);
+			}
+
+			// Stable, so on ties earlier offsets go first. Insertion sort while
+			// short, std::stable_sort would allocate its buffer for every pattern
+
+			if (verifyOrder.size() <= STACK_PROBABILITIES)
+				SortBySelectivity(verifyOrder.data(), verifyOrder.size(), probabilities);
+			else
+			{
+				std::stable_sort(verifyOrder.begin(), verifyOrder.end(), [probabilities](U32 a, U32 b) {
+					return probabilities[a] < probabilities[b];
+					});
+			}
+
+			for (U32 i : verifyOrder)
+			{
+				if (mask[i] != 0xFF)
+					continue;
+
+				if (!plan.mSolidAnchor)
+				{
+					plan.mSolidAnchor = true;
+					plan.mAnchor = plan.mAnchor2 = i;
+					continue;
+				}
+
+				plan.mAnchor2 = i;
+				break;
+			}
+
+			if (plan.mSolidAnchor)
+			{
+				verifyOrder.erase(std::remove_if(verifyOrder.begin(), verifyOrder.end(), [&plan](U32 i) {
+					return i == plan.mAnchor || i == plan.mAnchor2;
+					}), verifyOrder.end());
+			}
+
+			plan.mVerifyOrder.swap(verifyOrder);
+
+			size_t runStart = 0;
+			size_t runLen = 0;
+
+			LongestRun(mask, patternSize, runStart, runLen);
+
+			if (runLen < Plan::SKIP_MIN_LEN)
+				return;
+
+			SkipShifts(pattern, mask, runStart, runLen, plan.mSkipShift);
+
+			double expectedShift = 0.0;
+
+			for (U32 c = 0; c < 256; c++)
+				expectedShift += histogram.Probability(UByte(c), 0xFF) * plan.mSkipShift[c];
+
+			plan.mSkip = expectedShift >= Plan::SkipMinExpectedShift();
+			plan.mSkipStart = runStart;
+			plan.mSkipLen = runLen;
+		}
+
+		inline Plan BuildPlan(const UByte* pattern, const UByte* mask, size_t patternSize, const Histogram& histogram = Histogram::Default())
+		{
+			Plan plan;
+			BuildPlan(pattern, mask, patternSize, histogram, plan);
+			return plan;
+		}
+
+		static void BuildPlan(ParseResult& parsed, const Histogram& histogram = Histogram::Default())
+		{
+			BuildPlan(parsed.getTrimmedPattern(), parsed.getTrimmedCompareMask(), parsed.getTrimmedSize(), histogram, parsed.mPlan);
+		}
+
+		static bool Parse(const void* _pattern, const char* mask, ParseResult& result)
+		{
+			result = ParseResult();
+
+			if (_pattern == nullptr || mask == nullptr)
+				return false;
+
+			size_t patternLen = StringLength(mask);
+
+			result.mPattern.resize(patternLen);
+			result.mCompareMask.resize(patternLen);
+
+			memcpy(result.mPattern.data(), _pattern, patternLen);
+			memset(result.mCompareMask.data(), 0xFF, patternLen);
+
+			bool bFirstSolidFound = false;
+
+			for (size_t i = 0; i < patternLen; i++)
+			{
+				if (mask[i] == '?')
+				{
+					result.mPattern[i] = 0x00;
+					result.mCompareMask[i] = 0x00;
+
+					continue;
+				}
+
+				if (!bFirstSolidFound)
+				{
+					result.mTrimmDisp = i;
+					bFirstSolidFound = true;
+				}
+			}
+
+			result.Pad();
+			BuildPlan(result);
+
+			return result.mParseSuccess = true;
+		}
+
+		/*
+			"XX", "X?", "?X", "??", "?" or a lone hex digit
+		*/
+		static constexpr bool ValidToken(const char* token, size_t len)
+		{
+			return (len == 1 || len == 2) &&
+				(token[0] == '?' || Memory::IsHex(token[0])) &&
+				(len == 1 || token[1] == '?' || Memory::IsHex(token[1]));
+		}
+
+		/*
+			Single pass over `pattern`, bytes get encoded straight into `result`,
+			whose storage is reused, parsing many patterns into the same result
+			only allocates while growing it
+		*/
+		static bool Parse(StringView pattern, ParseResult& result)
+		{
+			result.Clear();
+
+			if (pattern.empty())
+				return true;
+
+			// Upper bound, one byte per single char token
+
+			result.mPattern.resize((pattern.size() + 1) / 2);
+			result.mCompareMask.resize((pattern.size() + 1) / 2);
+
+			const char* c = pattern.data();
+			const char* end = c + pattern.size();
+			size_t count = 0;
+			bool bFirstSolidFound = false;
+
+			for (; ; count++)
+			{
+				for (; c != end && *c == ' '; c++)
+					;
+
+				if (c == end)
+					break;
+
+				const char* token = c;
+
+				for (; c != end && *c != ' '; c++)
+					;
+
+				const size_t tokenLen = (size_t)(c - token);
+
+				if (!ValidToken(token, tokenLen))
+				{
+					// At this point, only the bytes before stay parsed
+
+					result.mPattern.resize(count);
+					result.mCompareMask.resize(count);
+					return false;
+				}
+
+				// At this point, current pattern byte structure good so far
+
+				const char high = token[0];
+				const char low = tokenLen == 2 ? token[1] : '\0';
+
+				UByte& value = result.mPattern[count];
+				UByte& mask = result.mCompareMask[count];
+
+				if ((high == '?' && (low == '?' || low == '\0')))
+				{
+					// At this point we are dealing with Full Byte Wildcard Case
+					value = 0x00;
+					mask = 0x00;
+					continue;
+				}
+
+				if (!bFirstSolidFound)
+				{
+					result.mTrimmDisp = count;
+					bFirstSolidFound = true;
+				}
+
+				if (high == '?')
+				{
+					// At this point, we are dealing with High Part of Byte wildcarding "?X"
+					value = Memory::Bits4FromChar(low);
+					mask = 0x0F;
+					continue;
+				}
+
+				if (low == '?')
+				{
+					// At this point, we are dealing with Low Part of Byte wildcarding "X?"
+					value = UByte(Memory::Bits4FromChar(high) << 4);
+					mask = 0xF0;
+					continue;
+				}
+
+				// Not Wilcarding this byte, a single char token being the high nibble
+				value = UByte((Memory::Bits4FromChar(high) << 4) | Memory::Bits4FromChar(low));
+				mask = 0xFF;
+			}
+
+			result.mPattern.resize(count);
+			result.mCompareMask.resize(count);
+
+			result.Pad();
+			BuildPlan(result);
+
+			return result.mParseSuccess = true;
+		}
+
+#ifdef TBS_USE_ETL
+		static bool Parse(const char* pattern, ParseResult& result)
+		{
+			return Parse(StringView(pattern), result);
+		}
+
+		static bool Parse(const String<>& pattern, ParseResult& result)
+		{
+			return Parse(StringView(pattern.data(), pattern.size()), result);
+		}
+#endif
+
+		/*
+			Same verdict as Parse() & a non empty result, without encoding anything
+		*/
+		inline bool Valid(StringView pattern)
+		{
+			const char* c = pattern.data();
+			const char* end = c + pattern.size();
+			size_t count = 0;
+
+			for (; ; count++)
+			{
+				for (; c != end && *c == ' '; c++)
+					;
+
+				if (c == end)
+					break;
+
+				const char* token = c;
+
+				for (; c != end && *c != ' '; c++)
+					;
+
+				if (!ValidToken(token, (size_t)(c - token)))
+					return false;
+			}
+
+			return count != 0;
+		}
+
+#ifdef TBS_USE_ETL
+		static bool Valid(const char* pattern)
+		{
+			return Valid(StringView(pattern));
+		}
+
+		static bool Valid(const String<>& pattern)
+		{
+			return Valid(StringView(pattern.data(), pattern.size()));
+		}
+#endif
+
+		inline bool Valid(const void* _pattern, const char* mask)
+		{
+			ParseResult res;
+
+			return Parse(_pattern, mask, res) && res;
+		}
+
+		/*
+			Reports through `onMatch(found)` every trimmed start `found` in [start, end)
+			where the trimmed pattern matches & fully fits before `end`,
+			following `plan`, a Plan or a CompiledPlan. Full verification goes through `compare(candidate)`
+			for candidates having `readLen` bytes before `end`, `compareTail(candidate)`
+			for the last few which dont, so `compare` is free of bound checks.
+			`onMatch` returning false aborts the search.
+		*/
+		template<typename PlanT, typename CompareT, typename CompareTailT, typename OnMatchT>
+		inline bool Find(const UByte* pattern, const UByte* mask, size_t patternSize, const PlanT& plan,
+			const UByte* start, const UByte* end, size_t readLen, CompareT&& compare, CompareTailT&& compareTail, OnMatchT&& onMatch)
+		{
+			if (patternSize == 0 || start >= end || (size_t)(end - start) < patternSize)
+				return true;
+
+			TBS_STATS_ADD(mBytes, end - start);
+
+			const UByte* last = end - patternSize; // Last valid trimmed start
+			const UByte* wholeEnd = (size_t)(end - start) >= readLen ? end - readLen + 1 : start; // First start needing compareTail
+			const size_t earlyChecks = plan.mVerifyOrder.size() < Plan::EARLY_REJECT_CHECKS ? plan.mVerifyOrder.size() : Plan::EARLY_REJECT_CHECKS;
+
+			auto search = [&](const UByte* from, const UByte* to, auto& compareCandidate) {
+				auto compareCounted = [&](const UByte* candidate) {
+					TBS_STATS_ADD(mCompares, 1);
+
+					const bool bMatch = compareCandidate(candidate);
+
+					TBS_STATS_ADD(mMatches, bMatch);
+					return bMatch;
+					};
+
+				auto verify = [&](const UByte* candidate) {
+					TBS_STATS_ADD(mCandidates, 1);
+
+					// Anchors are already checked, most selective bytes first,
+					// so most false candidates die here
+
+					for (size_t i = 0; i < earlyChecks; i++)
+					{
+						const U32 off = plan.mVerifyOrder[i];
+
+						if ((candidate[off] & mask[off]) != pattern[off])
+							return false;
+					}
+
+					return compareCounted(candidate);
+					};
+
+				if (plan.UseSkip())
+				{
+					// Horspool on the run, window [w, w + mSkipLen) sits at candidate + mSkipStart
+
+					const UByte* runPattern = pattern + plan.mSkipStart;
+					const UByte* runMask = mask + plan.mSkipStart;
+					const size_t runLast = plan.mSkipLen - 1;
+
+					for (const UByte* w = from + plan.mSkipStart; w < to + plan.mSkipStart; w += plan.mSkipShift[w[runLast]])
+					{
+						if ((w[runLast] & runMask[runLast]) != runPattern[runLast])
+							continue;
+
+						const UByte* candidate = w - plan.mSkipStart;
+
+						TBS_STATS_ADD(mCandidates, 1);
+
+						if (compareCounted(candidate) && !onMatch(candidate))
+							return false;
+					}
+
+					return true;
+				}
+
+				if (!plan.mSolidAnchor)
+				{
+					// Nothing fully solid to search for, lets check every position
+
+					for (const UByte* candidate = from; candidate < to; candidate++)
+					{
+						if (verify(candidate) && !onMatch(candidate))
+							return false;
+					}
+
+					return true;
+				}
+
+				// Both anchors tested at once at their pattern distance,
+				// only candidates passing both reach verify()
+
+				const size_t anchor2 = plan.HasSecondAnchor() ? plan.mAnchor2 : plan.mAnchor;
+
+				return SearchAnchors(from, to, plan.mAnchor, pattern[plan.mAnchor], anchor2, pattern[anchor2], [&](const UByte* candidate) {
+					return !verify(candidate) || onMatch(candidate);
+					});
+				};
+
+			return search(start, wholeEnd, compare) && search(wholeEnd, last + 1, compareTail);
+		}
+
+		template<typename OnMatchT>
+		inline bool Find(const ParseResult& parsed, const UByte* start, const UByte* end, OnMatchT&& onMatch)
+		{
+			const size_t patternSize = parsed.getTrimmedSize();
+			const UByte* pattern = parsed.getTrimmedPattern();
+			const UByte* mask = parsed.getTrimmedCompareMask();
+
+			auto compareTail = [&](const UByte* candidate) {
+				return Compare(candidate, pattern, patternSize, mask);
+				};
+
+			if (!parsed.IsPadded())
+				return Find(pattern, mask, patternSize, parsed.mPlan, start, end, patternSize, compareTail, compareTail, onMatch);
+
+			// At this point, whole padded vectors are compared wherever they are readable
+
+			const UByte* paddedPattern = parsed.getPaddedPattern();
+			const UByte* paddedMask = parsed.getPaddedCompareMask();
+			const size_t paddedSize = parsed.getPaddedSize();
+
+			return Find(pattern, mask, patternSize, parsed.mPlan, start, end, paddedSize, [&](const UByte* candidate) {
+				return ComparePadded(candidate, paddedPattern, paddedMask, paddedSize);
+				}, compareTail, onMatch);
+		}
+
+		namespace Compiler {
+			/*
+				Hex digit value, -1 if `c` is none
+			*/
+			constexpr int Bits4FromChar(char c)
+			{
+				return
+					('0' <= c && c <= '9') ? c - '0' :
+					('A' <= c && c <= 'F') ? c - 'A' + 10 :
+					('a' <= c && c <= 'f') ? c - 'a' + 10 :
+					-1;
+			}
+
+			/*
+				Amount of space separated byte tokens in `pattern`
+			*/
+			constexpr size_t CountBytes(const char* pattern)
+			{
+				size_t count = 0;
+
+				while (*pattern)
+				{
+					for (; *pattern == ' '; pattern++)
+						;
+
+					if (*pattern == '\0')
+						break;
+
+					for (; *pattern && *pattern != ' '; pattern++)
+						;
+
+					count++;
+				}
+
+				return count;
+			}
+		}
+
+		/*
+			Plan of a Compiled<N>, built at compile time under Histogram::Default(),
+			same members as Plan but the verify order is held inline. Whether the
+			run is skipped over depends on the kernels, so it is decided when searching
+		*/
+		template<size_t N>
+		struct CompiledPlan {
+			struct Order {
+				constexpr size_t size() const
+				{
+					return mCount;
+				}
+
+				constexpr U32 operator[](size_t i) const
+				{
+					return mOffsets[i];
+				}
+
+				Array<U32, N> mOffsets{};
+				size_t mCount = 0;
+			};
+
+			constexpr bool HasSecondAnchor() const
+			{
+				return mSolidAnchor && mAnchor2 != mAnchor;
+			}
+
+			inline bool UseSkip() const
+			{
+				return mSkipLen != 0 && mExpectedShift >= Plan::SkipMinExpectedShift();
+			}
+
+			/*
+				Same choices as BuildPlan() with the default histogram
+			*/
+			static constexpr CompiledPlan Build(const UByte* pattern, const UByte* mask, size_t patternSize)
+			{
+				CompiledPlan plan{};
+				double probabilities[N ? N : 1] = {};
+
+				for (U32 i = 0; i < (U32)patternSize; i++)
+				{
+					probabilities[i] = Histogram::DefaultProbability(pattern[i], mask[i]);
+
+					if (mask[i] != 0x00)
+						plan.mVerifyOrder.mOffsets[plan.mVerifyOrder.mCount++] = i;
+				}
+
+				SortBySelectivity(plan.mVerifyOrder.mOffsets.data(), plan.mVerifyOrder.mCount, probabilities);
+
+				for (size_t k = 0; k < plan.mVerifyOrder.mCount; k++)
+				{
+					const U32 i = plan.mVerifyOrder.mOffsets[k];
+
+					if (mask[i] != 0xFF)
+						continue;
+
+					if (!plan.mSolidAnchor)
+					{
+						plan.mSolidAnchor = true;
+						plan.mAnchor = plan.mAnchor2 = i;
+						continue;
+					}
+
+					plan.mAnchor2 = i;
+					break;
+				}
+
+				if (plan.mSolidAnchor)
+				{
+					size_t kept = 0;
+
+					for (size_t k = 0; k < plan.mVerifyOrder.mCount; k++)
+					{
+						const U32 i = plan.mVerifyOrder.mOffsets[k];
+
+						if (i != plan.mAnchor && i != plan.mAnchor2)
+							plan.mVerifyOrder.mOffsets[kept++] = i;
+					}
+
+					plan.mVerifyOrder.mCount = kept;
+				}
+
+				size_t runStart = 0;
+				size_t runLen = 0;
+
+				LongestRun(mask, patternSize, runStart, runLen);
+
+				if (runLen < Plan::SKIP_MIN_LEN)
+					return plan;
+
+				SkipShifts(pattern, mask, runStart, runLen, plan.mSkipShift);
+
+				for (U32 c = 0; c < 256; c++)
+					plan.mExpectedShift += Histogram::DefaultProbability(UByte(c), 0xFF) * plan.mSkipShift[c];
+
+				plan.mSkipStart = runStart;
+				plan.mSkipLen = runLen;
+
+				return plan;
+			}
+
+			size_t mAnchor = 0;
+			size_t mAnchor2 = 0;
+			Order mVerifyOrder{};
+			bool mSolidAnchor = false;
+			size_t mSkipStart = 0;
+			size_t mSkipLen = 0;	// 0 when there is no run to skip over
+			UByte mSkipShift[256] = {};
+			double mExpectedShift = 0.0;
+		};
+
+		/*
+			Compile time parsed pattern of `N` bytes, same layout as ParseResult,
+			but held in arrays zero padded (mask 0x00) a whole vector past `N`,
+			so it is compared with CompareFixed<N>, see Compile().
+			Its plan is built along, searching it allocates nothing
+		*/
+		template<size_t N>
+		struct Compiled {
+			static constexpr size_t SIZE = N;
+			static constexpr size_t PADDING = 32;
+
+			constexpr operator bool() const
+			{
+				return mParseSuccess;
+			}
+
+			constexpr const UByte* getTrimmedPattern() const
+			{
+				return mPattern.data() + mTrimmDisp;
+			}
+
+			constexpr const UByte* getTrimmedCompareMask() const
+			{
+				return mCompareMask.data() + mTrimmDisp;
+			}
+
+			constexpr size_t getTrimmedSize() const
+			{
+				return N - mTrimmDisp;
+			}
+
+			inline ParseResult ToParseResult() const
+			{
+				ParseResult result;
+
+				if (!mParseSuccess)
+					return result;
+
+				result.mPattern.assign(mPattern.begin(), mPattern.begin() + N);
+				result.mCompareMask.assign(mCompareMask.begin(), mCompareMask.begin() + N);
+				result.mTrimmDisp = mTrimmDisp;
+				result.Pad();
+				BuildPlan(result);
+				result.mParseSuccess = true;
+
+				return result;
+			}
+
+			Array<UByte, N + PADDING> mPattern{};
+			Array<UByte, N + PADDING> mCompareMask{};
+			size_t mTrimmDisp = 0;
+			bool mParseSuccess = false;
+			const char* mSource = nullptr;
+			CompiledPlan<N> mPlan{};
+		};
+
+		/*
+			Parses `pattern`, having exactly `N` bytes, at compile time,
+			same syntax as Parse(const String<>&, ...) but any non hex digit fails it
+		*/
+		template<size_t N>
+		constexpr Compiled<N> Compile(const char* pattern)
+		{
+			Compiled<N> result{};
+			const char* c = pattern;
+			bool bFirstSolidFound = false;
+			size_t i = 0;
+
+			while (*c)
+			{
+				for (; *c == ' '; c++)
+					;
+
+				if (*c == '\0')
+					break;
+
+				char str[2] = { '\0', '\0' };
+				size_t len = 0;
+
+				for (; *c && *c != ' '; c++, len++)
+				{
+					if (len < 2)
+						str[len] = *c;
+				}
+
+				if (len > 2 || i >= N)
+					return Compiled<N>{};
+
+				// At this point, current pattern byte structure good so far
+
+				const bool bFullByteWildcard = (str[0] == '?' && (len == 1 || str[1] == '?'));
+
+				if (!bFirstSolidFound && !bFullByteWildcard)
+				{
+					result.mTrimmDisp = i;
+					bFirstSolidFound = true;
+				}
+
+				if (bFullByteWildcard)
+				{
+					i++;
+					continue;
+				}
+
+				const int high = str[0] == '?' ? 0 : Compiler::Bits4FromChar(str[0]);
+				const int low = len == 1 || str[1] == '?' ? 0 : Compiler::Bits4FromChar(str[1]);
+
+				if (high < 0 || low < 0)
+					return Compiled<N>{};
+
+				result.mPattern[i] = UByte((high << 4) | low);
+				result.mCompareMask[i] = str[0] == '?' ? UByte(0x0Fu) : len == 2 && str[1] == '?' ? UByte(0xF0u) : UByte(0xFFu);
+				i++;
+			}
+
+			result.mParseSuccess = N > 0 && i == N && bFirstSolidFound;
+			result.mSource = pattern;
+
+			if (result.mParseSuccess)
+				result.mPlan = CompiledPlan<N>::Build(result.getTrimmedPattern(), result.getTrimmedCompareMask(), result.getTrimmedSize());
+
+			return result;
+		}
+
+		template<size_t N, typename PlanT, typename OnMatchT>
+		inline bool Find(const Compiled<N>& compiled, const PlanT& plan, const UByte* start, const UByte* end, OnMatchT&& onMatch)
+		{
+			const size_t patternSize = compiled.getTrimmedSize();
+			const UByte* pattern = compiled.getTrimmedPattern();
+			const UByte* mask = compiled.getTrimmedCompareMask();
+
+			auto compare = [&](const UByte* candidate) {
+				return CompareFixed<N>(candidate, end, pattern, patternSize, mask);
+				};
+
+			return Find(pattern, mask, patternSize, plan, start, end, patternSize, compare, compare, onMatch);
+		}
+
+		template<size_t N, typename OnMatchT>
+		inline bool Find(const Compiled<N>& compiled, const UByte* start, const UByte* end, OnMatchT&& onMatch)
+		{
+			return Find(compiled, compiled.mPlan, start, end, onMatch);
+		}
+
+		/*
+			Built in result transform, unlike a ResultTransformer it runs after
+			the scan over every result of a UID at once, see ApplySteps().
+			Offsets are relative to the result, memory read is not validated
+		*/
+		struct ResultStep {
+			enum class EType : UByte {
+				ADD,		// result + mOffset
+				DEREF,		// *(Result*)(result + mOffset)
+				REL32,		// result + mSize + *(int32_t*)(result + mOffset)
+				REL8,		// result + mSize + *(int8_t*)(result + mOffset)
+				MODRM_DISP	// Displacement of the ModRM (+ SIB) operand at result + mOffset, 0 when none
+			};
+
+			static inline ResultStep Add(intptr_t offset)
+			{
+				return ResultStep{ EType::ADD, offset, 0 };
+			}
+
+			static inline ResultStep Deref(intptr_t offset = 0)
+			{
+				return ResultStep{ EType::DEREF, offset, 0 };
+			}
+
+			/*
+				rel32 at `dispOffset` of an instruction `size` bytes long,
+				by default ending with its displacement, eg. `E8 rel32` is Rel32(1)
+			*/
+			static inline ResultStep Rel32(intptr_t dispOffset, intptr_t size = 0)
+			{
+				return ResultStep{ EType::REL32, dispOffset, size ? size : dispOffset + 4 };
+			}
+
+			static inline ResultStep Rel8(intptr_t dispOffset, intptr_t size = 0)
+			{
+				return ResultStep{ EType::REL8, dispOffset, size ? size : dispOffset + 1 };
+			}
+
+			/*
+				eg. ModRMDisp(2) on `48 8B 81 A8 01 00 00` (mov rax, [rcx+0x1A8]) is 0x1A8
+			*/
+			static inline ResultStep ModRMDisp(intptr_t modRMOffset)
+			{
+				return ResultStep{ EType::MODRM_DISP, modRMOffset, 0 };
+			}
+
+			EType mType;
+			intptr_t mOffset;
+			intptr_t mSize;
+		};
+
+		using ResultSteps = Vector<ResultStep>;
+
+		template<typename T>
+		inline T ReadAt(Result address)
+		{
+			T value;
+			memcpy(&value, (const void*)(UPtr)address, sizeof(T));
+			return value;
+		}
+
+		inline Result ModRMDisplacement(const UByte* modRM)
+		{
+			const UByte mod = modRM[0] >> 6;
+			const UByte rm = modRM[0] & 7;
+			const UByte* disp = modRM + 1;
+
+			if (mod == 3)
+				return 0;
+
+			bool bDisp32 = mod == 2 || (mod == 0 && rm == 5);
+
+			if (rm == 4)
+			{
+				// At this point, a SIB byte follows, base 5 without mod means disp32
+
+				bDisp32 = bDisp32 || (mod == 0 && (*disp & 7) == 5);
+				disp++;
+			}
+
+			if (bDisp32)
+				return (Result)(intptr_t)ReadAt<int32_t>((Result)(UPtr)disp);
+
+			if (mod == 1)
+				return (Result)(intptr_t)(int8_t)*disp;
+
+			return 0;
+		}
+
+		/*
+			Runs `steps` in order over results[0, count), a step at a time across
+			all of them so each loop stays branch free on the step type
+		*/
+		inline void ApplySteps(const ResultSteps& steps, Result* results, size_t count)
+		{
+			for (const ResultStep& step : steps)
+			{
+				const Result offset = (Result)step.mOffset;
+				const Result size = (Result)step.mSize;
+
+				switch (step.mType)
+				{
+				case ResultStep::EType::ADD:
+					for (size_t i = 0; i < count; i++)
+						results[i] += offset;
+					break;
+
+				case ResultStep::EType::DEREF:
+					for (size_t i = 0; i < count; i++)
+						results[i] = ReadAt<Result>(results[i] + offset);
+					break;
+
+				case ResultStep::EType::REL32:
+					for (size_t i = 0; i < count; i++)
+						results[i] += size + (Result)(intptr_t)ReadAt<int32_t>(results[i] + offset);
+					break;
+
+				case ResultStep::EType::REL8:
+					for (size_t i = 0; i < count; i++)
+						results[i] += size + (Result)(intptr_t)ReadAt<int8_t>(results[i] + offset);
+					break;
+
+				case ResultStep::EType::MODRM_DISP:
+					for (size_t i = 0; i < count; i++)
+						results[i] = ModRMDisplacement((const UByte*)(UPtr)(results[i] + offset));
+					break;
+				}
+			}
+		}
+
+		enum class EScan {
+			SCAN_ALL,
+			SCAN_FIRST
+		};
+
+		struct Description {
+			using ResultTransformer = Function<Result(Description&, Result)>;
+
+			/*
+				Gets every result a UID found in a Scan() at once, after its steps ran.
+				Transformers of different UIDs may run concurrently
+			*/
+			using BatchTransformer = Function<void(Result* results, size_t count)>;
+			using SearchSlice = Memory::Slice<const UByte*>;
+
+			/*
+				What scans produced for a UID, either the one every Shared carries
+				or one of a State::ScanResults, so the descriptions themselves are only read
+			*/
+			struct Outcome {
+				static constexpr Result NO_MATCH = ~Result(0);
+
+				inline Outcome()
+					: mFinished(false)
+					, mFirstMatch(NO_MATCH)
+					, mPostProcessed(0)
+				{}
+
+				inline void Reset()
+				{
+					mResult.clear();
+					mFinished = false;
+					mFirstMatch = NO_MATCH;
+					mPostProcessed = 0;
+				}
+
+				/*
+					Lowest SCAN_FIRST match address reported so far, any chunk
+					only able to produce higher addresses can be skipped
+				*/
+				inline Result FirstMatch() const
+				{
+#ifdef TBS_MT
+					return mFirstMatch.load(std::memory_order_acquire);
+#else
+					return mFirstMatch;
+#endif
+				}
+
+				/*
+					Returns false if a lower or equal address was already offered
+				*/
+				inline bool OfferFirstMatch(Result address)
+				{
+#ifdef TBS_MT
+					Result current = mFirstMatch.load(std::memory_order_relaxed);
+
+					while (address < current)
+					{
+						if (mFirstMatch.compare_exchange_weak(current, address, std::memory_order_acq_rel))
+							return true;
+					}
+
+					return false;
+#else
+					if (address >= mFirstMatch)
+						return false;
+
+					mFirstMatch = address;
+					return true;
+#endif
+				}
+
+#ifdef TBS_MT
+				std::mutex mMutex;
+				std::atomic<bool> mFinished;
+				std::atomic<Result> mFirstMatch;
+#else
+				bool mFinished;
+				Result mFirstMatch;
+#endif
+				Results mResult;
+				size_t mPostProcessed;	// Leading results already through the steps & batch transformers
+			};
+
+			struct Shared {
+				struct ResultAccesor {
+					inline ResultAccesor(const Outcome& outcome)
+						: mOutcome(outcome)
+					{}
+
+					inline operator const Results& () const {
+						return ResultsGet();
+					}
+
+					inline operator Result () const {
+						if (mOutcome.mResult.size() < 1)
+							return 0;
+
+						return mOutcome.mResult[0];
+					}
+
+					inline const Results& ResultsGet() const
+					{
+						return mOutcome.mResult;
+					}
+
+					const Outcome& mOutcome;
+				};
+
+				/*
+					`index` is unique within the State owning it, see State::ScanResults
+				*/
+				inline Shared(EScan scanType, size_t index = 0)
+					: mScanType(scanType)
+					, mIndex(index)
+				{}
+
+				EScan mScanType;
+				size_t mIndex;
+				Outcome mOutcome;
+				ResultSteps mSteps;
+				Vector<BatchTransformer> mBatchTransforms;
+#ifdef TBS_STATS
+				Stats::DescriptionStats mStats;
+#endif
+			};
+
+			/*
+				Where a slice by slice Scan(desc, cursor) is at, kept apart
+				from the description so it can be searched again from scratch
+			*/
+			struct Cursor {
+				inline Cursor(const Description& desc)
+					: mCurrentSearchRange(desc.mSearchRangeSlicer.begin())
+					, mLastSearchPos(desc.mSearchRangeSlicer.mStart)
+				{}
+
+				SearchSlice::Container::Iterator mCurrentSearchRange;
+				const UByte* mLastSearchPos;
+			};
+
+			inline Description(Shared& shared, const String<>& uid, const UByte* searchStart, const UByte* searchEnd,
+				const Vector<ResultTransformer>& transformers, const String<>& pattern)
+				: Description(shared, uid, searchStart, searchEnd, transformers)
+			{
+				Parse(pattern, mParsed);
+			}
+
+			inline Description(
+				Shared& shared, const String<>& uid,
+				const UByte* searchStart, const UByte* searchEnd,
+				const Vector<ResultTransformer>& transformers, const void* _pattern, const char* mask)
+				: Description(shared, uid, searchStart, searchEnd, transformers)
+			{
+				Parse(_pattern, mask, mParsed);
+			}
+
+			inline Description(
+				Shared& shared, const String<>& uid,
+				const UByte* searchStart, const UByte* searchEnd,
+				const Vector<ResultTransformer>& transformers, const ParseResult& parsed)
+				: Description(shared, uid, searchStart, searchEnd, transformers)
+			{
+				mParsed = parsed;
+			}
+
+			inline Description(
+				Shared& shared, const String<>& uid,
+				const UByte* searchStart, const UByte* searchEnd,
+				const Vector<ResultTransformer>& transformers, ParseResult&& parsed)
+				: Description(shared, uid, searchStart, searchEnd, transformers)
+			{
+				mParsed = std::move(parsed);
+			}
+
+			/*
+				Same pattern, result & transforms as `other`, searching [searchStart, searchEnd) instead
+			*/
+			inline Description(const Description& other, const UByte* searchStart, const UByte* searchEnd)
+				: Description(other.mShared, other.mUID, searchStart, searchEnd, other.mTransforms)
+			{
+				mParsed = other.mParsed;
+			}
+
+			inline operator bool()
+			{
+				return mParsed;
+			}
+
+			Shared& mShared;
+			String<> mUID;
+			Vector<ResultTransformer> mTransforms;
+			SearchSlice::Container mSearchRangeSlicer;
+			ParseResult mParsed;
+			Cursor mCursor;		// Of Scan(desc), scans never touch it otherwise
+
+		private:
+
+			inline Description(Shared& shared, const String<>& uid, const UByte* searchStart, const UByte* searchEnd,
+				const Vector<ResultTransformer>& transformers)
+				: mShared(shared)
+				, mUID(uid)
+				, mTransforms(transformers)
+				, mSearchRangeSlicer(searchStart, searchEnd, PATTERN_SEARCH_SLICE_SIZE)
+				, mCursor(*this)
+			{ }
+		};
+
+		using ResultTransformer = Description::ResultTransformer;
+		using Outcome = Description::Outcome;
+
+		/*
+			Pattern text & its UID for State::AddPatterns(), an empty UID is the pattern text
+		*/
+		struct Source {
+			StringView mUID;
+			StringView mPattern;
+		};
+
+		/*
+			Applies the user transforms to a match whose trimmed pattern starts at `found`
+		*/
+		static Result Transform(Description& desc, const UByte* found)
+		{
+			Result currMatch = (Result)(found - desc.mParsed.mTrimmDisp);
+
+			if (desc.mTransforms.empty())
+				return currMatch;
+
+#ifdef TBS_STATS
+			const U64 startNs = Stats::NowNs();
+#endif
+
+			for (const auto& transform : desc.mTransforms)
+				currMatch = transform(desc, currMatch);
+
+			TBS_STATS_ADD(mTransformNs, Stats::NowNs() - startNs);
+
+			return currMatch;
+		}
+
+		/*
+			Match waiting to be merged into its shared description results
+		*/
+		struct Match {
+			Description::Shared* mShared;
+			Outcome* mOutcome;
+			Result mAddress;
+			Result mValue;
+		};
+
+		using Matches = Vector<Match>;
+
+		/*
+			Where a scan of compiled descriptions puts what it finds, the outcome each
+			Shared carries or those of a State::ScanResults, indexed by Shared::mIndex
+		*/
+		struct Sink {
+			inline Outcome& Of(Description::Shared& shared) const
+			{
+				return mOutcomes ? *mOutcomes[shared.mIndex] : shared.mOutcome;
+			}
+
+			UniquePtr<Outcome>* mOutcomes = nullptr;
+		};
+
+		/*
+			Transforms & publishes a match whose trimmed pattern starts at `found`
+			returns false once the shared description doesnt accept more results
+		*/
+		static bool Report(Description& desc, const UByte* found)
+		{
+			auto& shared = desc.mShared.mOutcome;
+
+			Result currMatch = Transform(desc, found);
+
+			// At this point, match is properly user transformed
+			// lets report it
+
+#ifdef TBS_MT
+#ifdef TBS_STATS
+			const U64 lockStartNs = Stats::NowNs();
+#endif
+
+#ifdef TBS_TRACE
+			std::unique_lock<std::mutex> resultReportLck(shared.mMutex, std::try_to_lock);
+
+			if (!resultReportLck.owns_lock())
+			{
+				// Only contended acquisitions make it to the timeline
+
+				TBS_TRACE_SCOPE("Report lock wait", "lock");
+				resultReportLck.lock();
+			}
+#else
+			std::lock_guard<std::mutex> resultReportLck(shared.mMutex);
+#endif
+
+			TBS_STATS_ADD(mLockWaitNs, Stats::NowNs() - lockStartNs);
+#endif
+
+			if (shared.mFinished)
+				return false;
+
+			// At this point, we have the lock & we havent finished!
+			// Lets directly push it
+
+			shared.mResult.push_back(currMatch);
+
+			if (desc.mShared.mScanType != EScan::SCAN_FIRST)
+				return true;
+
+			// At this point seems we are searching for a single result
+			// lets report finished state for the shared state
+
+			shared.mFinished = true;
+			return false;
+		}
+
+		/*
+			Lock free counterpart of Report(), matches land in the `matches` buffer
+			of the running task & get published later by Merge().
+			SCAN_FIRST matches are kept only while lower than any other one reported,
+			returns false once `desc` wont accept more matches from this search.
+		*/
+		static bool Collect(Description& desc, Outcome& outcome, const UByte* found, Matches& matches)
+		{
+			const Result address = (Result)(found - desc.mParsed.mTrimmDisp);
+
+			if (desc.mShared.mScanType == EScan::SCAN_FIRST &&
+				outcome.OfferFirstMatch(address) == false)
+				return false;
+
+			matches.push_back(Match{ &desc.mShared, &outcome, address, Transform(desc, found) });
+
+			// Searches go in ascending address order, so for SCAN_FIRST
+			// whatever comes after this one is higher
+
+			return desc.mShared.mScanType != EScan::SCAN_FIRST;
+		}
+
+		/*
+			True when a SCAN_FIRST description already has a match lower than
+			anything a search starting at (trimmed) `searchStart` could find
+		*/
+		static bool Superseded(const Description& desc, const Outcome& outcome, const UByte* searchStart)
+		{
+			return desc.mShared.mScanType == EScan::SCAN_FIRST &&
+				outcome.FirstMatch() <= (Result)(searchStart - desc.mParsed.mTrimmDisp);
+		}
+
+		/*
+			Publishes collected matches, per shared description in address order & without
+			duplicates, so results dont depend on how chunks got scheduled across workers
+		*/
+		static void Merge(Matches& matches)
+		{
+			std::stable_sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+				if (a.mOutcome != b.mOutcome)
+					return std::less<>()(a.mOutcome, b.mOutcome);
+
+				return a.mAddress < b.mAddress;
+				});
+
+			for (size_t i = 0; i < matches.size(); i++)
+			{
+				const Match& match = matches[i];
+				auto& outcome = *match.mOutcome;
+
+				if (i > 0 &&
+					matches[i - 1].mOutcome == match.mOutcome &&
+					matches[i - 1].mAddress == match.mAddress &&
+					matches[i - 1].mValue == match.mValue)
+					continue;
+
+				if (match.mShared->mScanType == EScan::SCAN_FIRST)
+				{
+					// Sorted, so the lowest address comes first
+
+					if (outcome.mFinished)
+						continue;
+
+					outcome.mFinished = true;
+				}
+
+				outcome.mResult.push_back(match.mValue);
+			}
+		}
+
+		/*
+			Searches the slice `cursor` is at & moves it to the next one, results go
+			to the description own outcome. False once there is nothing left to search
+		*/
+		static bool Scan(Description& desc, Description::Cursor& cursor)
+		{
+			auto& shared = desc.mShared.mOutcome;
+			auto& parsed = desc.mParsed;
+
+			if (shared.mFinished ||
+				(cursor.mCurrentSearchRange == desc.mSearchRangeSlicer.end()))
+				return false;
+
+			Description::SearchSlice currSearchnigRange = (*cursor.mCurrentSearchRange);
+
+			const auto patternSize = parsed.getTrimmedSize();
+
+			bool bAccepting = Find(parsed, cursor.mLastSearchPos, currSearchnigRange.mEnd, [&desc, &shared](const UByte* found) {
+				// At this point, we found a match
+
+				return !shared.mFinished && Report(desc, found);
+				});
+
+			if (!bAccepting)
+				return false;
+
+			cursor.mLastSearchPos = currSearchnigRange.mEnd - patternSize;
+			++cursor.mCurrentSearchRange;
+			return !(cursor.mCurrentSearchRange == desc.mSearchRangeSlicer.end());
+		}
+
+		/*
+			Same, over the cursor the description carries itself. Moving it writes to the
+			description, so not while a State it belongs to is being scanned
+		*/
+		inline bool Scan(Description& desc)
+		{
+			return Scan(desc, desc.mCursor);
+		}
+
+		/*
+			Scans every trimmed start in [chunkStart, chunkEnd) of `desc`, matches may
+			extend up to `searchEnd`, the end of the range being searched, so adjacent
+			chunks neither miss nor duplicate boundary matches
+		*/
+		static void Scan(Description& desc, const Sink& sink, const UByte* chunkStart, const UByte* chunkEnd, const UByte* searchEnd, Matches& matches)
+		{
+			Outcome& outcome = sink.Of(desc.mShared);
+
+			if (outcome.mFinished || Superseded(desc, outcome, chunkStart))
+				return;
+
+			const size_t reach = desc.mParsed.getTrimmedSize() > 0 ? desc.mParsed.getTrimmedSize() - 1 : 0;
+			const UByte* windowEnd = (size_t)(searchEnd - chunkEnd) > reach ? chunkEnd + reach : searchEnd;
+
+			Find(desc.mParsed, chunkStart, windowEnd, [&desc, &outcome, &matches](const UByte* found) {
+				return Collect(desc, outcome, found, matches);
+				});
+		}
+
+		using SharedDescription = Description::Shared;
+		using SharedResultAccesor = SharedDescription::ResultAccesor;
+
+		/*
+			Single pass matcher for many patterns over the same range.
+			Patterns are distributed into 8 buckets, for each of the first
+			(up to 3) trimmed bytes a low & high nibble table tells which
+			buckets accept that byte, a position is a candidate when the AND
+			of all its lookups leaves any bucket bit set, only the patterns of
+			those buckets are then verified with the masked Compare.
+			Past a few dozen patterns every bucket accepts nearly any byte, so once
+			the fingerprint expects more than SATURATION verifications per position
+			patterns are indexed by their 3 leading trimmed bytes instead, hashed into
+			a bit filter & slots, a position only verifies the patterns keyed by the
+			slot of the very 3 bytes found there.
+			Patterns too wildcarded to be keyed keep the fingerprint, or get
+			searched one by one when they alone still saturate it.
+		*/
+		struct MultiMatcher {
+			static constexpr size_t BUCKETS = 8;
+			static constexpr size_t FINGERPRINT_MAX_LEN = 3;
+			static constexpr size_t KEY_LEN = 3;
+			static constexpr size_t KEY_FILTER_BITS = 20;	// 128KB filter, sparse even with tens of thousands of keys
+			static constexpr size_t KEY_SLOT_MAX_BITS = 20;
+			static constexpr size_t KEY_SPREAD_MAX = 16;	// Keys a pattern with nibble wildcarded leading bytes may take
+			static constexpr double SATURATION = 1.0 / 32;
+
+			/*
+				What a sweep reads, over the matcher own storage or laid out
+				in a Database image, patterns are referred to by index only
+			*/
+			struct Tables {
+				const UByte(*mLo)[16];
+				const UByte(*mHi)[16];
+				size_t mFingerprintLen;
+				const U32* mBucketStarts;	// BUCKETS + 1, into mBucketPatterns
+				const U32* mBucketPatterns;
+				const U64* mKeyBits;		// Null when nothing is keyed
+				const U32* mKeySlots;
+				const U32* mKeyPatterns;
+				U32 mKeyShift;
+				const U32* mSolo;
+				size_t mSoloCount;
+			};
+
+			inline MultiMatcher()
+				: mFingerprintLen(0)
+				, mKeyShift(0)
+			{
+				memset(mLo, 0, sizeof(mLo));
+				memset(mHi, 0, sizeof(mHi));
+				mBucketStarts.assign(BUCKETS + 1, 0);
+			}
+
+			inline void Add(const ParseResult& parsed)
+			{
+				mPatterns.push_back(&parsed);
+			}
+
+			inline void Compile()
+			{
+				mKeyBits.clear();
+				mKeySlots.clear();
+				mKeyPatterns.clear();
+				mSolo.clear();
+
+				Vector<U32> fingerprinted;
+
+				for (U32 i = 0; i < (U32)mPatterns.size(); i++)
+				{
+					if (mPatterns[i]->getTrimmedSize() > 0)	// Empty patterns never match
+						fingerprinted.push_back(i);
+				}
+
+				Fingerprint(fingerprinted);
+
+				if (ExpectedVerifications() <= SATURATION)
+					return;
+
+				// At this point, the fingerprint barely filters, keying whatever we can
+
+				Vector<U32> keyed, loose;
+
+				for (U32 i : fingerprinted)
+				{
+					if (KeySpread(*mPatterns[i]) <= KEY_SPREAD_MAX)
+						keyed.push_back(i);
+					else
+						loose.push_back(i);
+				}
+
+				Key(keyed);
+				Fingerprint(loose);
+
+				if (ExpectedVerifications() <= SATURATION)
+					return;
+
+				mSolo = std::move(loose);
+				Fingerprint(Vector<U32>());
+			}
+
+			inline size_t size() const
+			{
+				return mPatterns.size();
+			}
+
+			inline Tables GetTables() const
+			{
+				return Tables{
+					mLo, mHi, mFingerprintLen,
+					mBucketStarts.data(), mBucketPatterns.data(),
+					mKeyPatterns.empty() ? nullptr : mKeyBits.data(), mKeySlots.data(), mKeyPatterns.data(), mKeyShift,
+					mSolo.data(), mSolo.size()
+				};
+			}
+
+			/*
+				Reports through `onMatch(patternIndex, found)` every pattern whose trimmed
+				start is in [start, end) and fully fits before `limit`, in no particular order,
+				`onMatch` returning false aborts the sweep.
+			*/
+			template<typename OnMatchT>
+			inline bool Scan(const UByte* start, const UByte* end, const UByte* limit, OnMatchT&& onMatch) const
+			{
+				return Sweep(GetTables(), start, end, limit, [this, limit, &onMatch](U32 i, const UByte* found) {
+					return Verify(i, found, limit, onMatch);
+					}, [this, start, end, limit, &onMatch](U32 i) {
+					const ParseResult& parsed = *mPatterns[i];
+					const size_t reach = parsed.getTrimmedSize() - 1;
+					const UByte* windowEnd = (size_t)(limit - end) > reach ? end + reach : limit;
+
+					return Find(parsed, start, windowEnd, [i, &onMatch](const UByte* found) { return onMatch(i, found); });
+					});
+			}
+
+			/*
+				Sweeps [start, end) following `tables`, `verify(patternIndex, found)` checks
+				a candidate & reports it, `solo(patternIndex)` searches a pattern on its own,
+				both returning false to abort
+			*/
+			template<typename VerifyT, typename SoloT>
+			static inline bool Sweep(const Tables& tables, const UByte* start, const UByte* end, const UByte* limit, VerifyT&& verify, SoloT&& solo)
+			{
+				if (start >= end)
+					return true;
+
+				TBS_STATS_ADD(mBytes, end - start);
+
+				if (tables.mKeyBits && !ScanKeyed(tables, start, end, limit, verify))
+					return false;
+
+				if (tables.mFingerprintLen && !ScanFingerprint(tables, start, end, limit, verify))
+					return false;
+
+				for (size_t k = 0; k < tables.mSoloCount; k++)
+				{
+					if (!solo(tables.mSolo[k]))
+						return false;
+				}
+
+				return true;
+			}
+
+			/*
+				Filter bit & slot of a key are the top bits of its hash
+			*/
+			static inline U32 KeyHash(U32 key)
+			{
+				return key * 0x9E3779B1u;
+			}
+
+			static inline U32 Slot(U32 key, U32 keyShift)
+			{
+				return KeyHash(key) >> keyShift;
+			}
+
+			Vector<const ParseResult*> mPatterns;
+			Vector<U32> mBucketStarts;	// BUCKETS + 1, bucket b holds [mBucketStarts[b], mBucketStarts[b + 1]) of mBucketPatterns
+			Vector<U32> mBucketPatterns;
+			size_t mFingerprintLen;
+			alignas(16) UByte mLo[FINGERPRINT_MAX_LEN][16];
+			alignas(16) UByte mHi[FINGERPRINT_MAX_LEN][16];
+			Vector<U64> mKeyBits;		// KEY_FILTER_BITS hashed filter of the leading bytes values some pattern accepts
+			Vector<U32> mKeySlots;		// Hashed key -> [mKeySlots[slot], mKeySlots[slot + 1]) of mKeyPatterns
+			Vector<U32> mKeyPatterns;
+			U32 mKeyShift;
+			Vector<U32> mSolo;			// Searched one by one
+
+		private:
+
+			static inline U32 KeyOf(const UByte* bytes)
+			{
+				return U32(bytes[0]) | U32(bytes[1]) << 8 | U32(bytes[2]) << 16;
+			}
+
+			/*
+				Leading KEY_LEN trimmed bytes values `parsed` accepts, past KEY_SPREAD_MAX when it cant be keyed
+			*/
+			static inline size_t KeySpread(const ParseResult& parsed)
+			{
+				if (parsed.getTrimmedSize() < KEY_LEN)
+					return KEY_SPREAD_MAX + 1;
+
+				const U32 keyMask = KeyOf(parsed.getTrimmedCompareMask());
+				size_t spread = 1;
+
+				for (U32 bit = 0; bit < KEY_LEN * 8 && spread <= KEY_SPREAD_MAX; bit++)
+				{
+					if (((keyMask >> bit) & 1) == 0)
+						spread *= 2;
+				}
+
+				return spread;
+			}
+
+			/*
+				Calls `onKey(key)` for every leading KEY_LEN bytes value `parsed` accepts
+			*/
+			template<typename OnKeyT>
+			static inline void ForEachKey(const ParseResult& parsed, OnKeyT&& onKey)
+			{
+				const U32 keyMask = KeyOf(parsed.getTrimmedCompareMask());
+				const U32 value = KeyOf(parsed.getTrimmedPattern()) & keyMask;
+				const U32 free = ~keyMask & ((U32(1) << (KEY_LEN * 8)) - 1);
+
+				// Every subset of the wildcarded bits
+
+				U32 bits = 0;
+
+				do
+				{
+					onKey(value | bits);
+					bits = (bits - free) & free;
+				} while (bits);
+			}
+
+			inline void Key(const Vector<U32>& keyed)
+			{
+				if (keyed.empty())
+					return;
+
+				size_t entries = 0;
+
+				for (U32 i : keyed)
+					entries += KeySpread(*mPatterns[i]);
+
+				U32 slotBits = 8;
+
+				while (slotBits < KEY_SLOT_MAX_BITS && (size_t(1) << slotBits) < entries * 2)
+					slotBits++;
+
+				mKeyShift = 32 - slotBits;
+				mKeyBits.assign((size_t(1) << KEY_FILTER_BITS) / 64, 0);
+				mKeySlots.assign((size_t(1) << slotBits) + 1, 0);
+				mKeyPatterns.resize(entries);
+
+				// Counting, then filling each slot from its end
+
+				for (U32 i : keyed)
+				{
+					ForEachKey(*mPatterns[i], [this](U32 key) {
+						const U32 bit = KeyHash(key) >> (32 - KEY_FILTER_BITS);
+
+						mKeyBits[bit >> 6] |= U64(1) << (bit & 63);
+						mKeySlots[Slot(key, mKeyShift) + 1]++;
+						});
+				}
+
+				for (size_t slot = 1; slot < mKeySlots.size(); slot++)
+					mKeySlots[slot] += mKeySlots[slot - 1];
+
+				Vector<U32> filled(mKeySlots.begin(), mKeySlots.end() - 1);
+
+				for (U32 i : keyed)
+				{
+					ForEachKey(*mPatterns[i], [this, i, &filled](U32 key) {
+						mKeyPatterns[filled[Slot(key, mKeyShift)]++] = i;
+						});
+				}
+			}
+
+			inline void Fingerprint(const Vector<U32>& fingerprinted)
+			{
+				memset(mLo, 0, sizeof(mLo));
+				memset(mHi, 0, sizeof(mHi));
+
+				mFingerprintLen = fingerprinted.empty() ? 0 : FINGERPRINT_MAX_LEN;
+
+				for (U32 i : fingerprinted)
+				{
+					if (mPatterns[i]->getTrimmedSize() < mFingerprintLen)
+						mFingerprintLen = mPatterns[i]->getTrimmedSize();
+				}
+
+				Vector<U32> bucketOf(fingerprinted.size());
+				mBucketStarts.assign(BUCKETS + 1, 0);
+
+				for (size_t j = 0; j < fingerprinted.size(); j++)
+				{
+					const ParseResult& parsed = *mPatterns[fingerprinted[j]];
+					const UByte* pattern = parsed.getTrimmedPattern();
+					const UByte* mask = parsed.getTrimmedCompareMask();
+
+					// Same fingerprint lands in the same bucket, keeping false positives per bucket low
+
+					U32 hash = 0;
+
+					for (size_t k = 0; k < mFingerprintLen; k++)
+						hash = hash * 31 + (pattern[k] & mask[k]) + mask[k];
+
+					const U32 bucket = bucketOf[j] = hash % BUCKETS;
+
+					mBucketStarts[bucket + 1]++;
+
+					for (size_t k = 0; k < mFingerprintLen; k++)
+					{
+						// Masks are nibble granular, so each nibble can be accepted independently
+
+						const UByte loMask = mask[k] & 0x0F, loValue = pattern[k] & loMask;
+						const UByte hiMask = mask[k] >> 4, hiValue = (pattern[k] >> 4) & hiMask;
+
+						for (UByte nibble = 0; nibble < 16; nibble++)
+						{
+							if ((nibble & loMask) == loValue)
+								mLo[k][nibble] |= UByte(1u << bucket);
+
+							if ((nibble & hiMask) == hiValue)
+								mHi[k][nibble] |= UByte(1u << bucket);
+						}
+					}
+				}
+
+				for (size_t bucket = 1; bucket <= BUCKETS; bucket++)
+					mBucketStarts[bucket] += mBucketStarts[bucket - 1];
+
+				Vector<U32> filled(mBucketStarts.begin(), mBucketStarts.end() - 1);
+				mBucketPatterns.resize(fingerprinted.size());
+
+				for (size_t j = 0; j < fingerprinted.size(); j++)
+					mBucketPatterns[filled[bucketOf[j]]++] = fingerprinted[j];
+			}
+
+			/*
+				Patterns the fingerprint sends to verification per position of random data
+			*/
+			inline double ExpectedVerifications() const
+			{
+				double expected = 0;
+
+				for (U32 bucket = 0; bucket < BUCKETS; bucket++)
+				{
+					double pass = (double)(mBucketStarts[bucket + 1] - mBucketStarts[bucket]);
+
+					for (size_t k = 0; k < mFingerprintLen && pass > 0; k++)
+					{
+						U32 lo = 0, hi = 0;
+
+						for (size_t nibble = 0; nibble < 16; nibble++)
+						{
+							lo += (mLo[k][nibble] >> bucket) & 1;
+							hi += (mHi[k][nibble] >> bucket) & 1;
+						}
+
+						pass *= double(lo * hi) / 256;
+					}
+
+					expected += pass;
+				}
+
+				return expected;
+			}
+
+			template<typename VerifyT>
+			static inline bool ScanKeyed(const Tables& tables, const UByte* start, const UByte* end, const UByte* limit, VerifyT& verify)
+			{
+				const U64* keyBits = tables.mKeyBits;
+
+				for (; start < end && (size_t)(limit - start) >= KEY_LEN; start++)
+				{
+					const U32 hash = KeyHash(KeyOf(start));
+					const U32 bit = hash >> (32 - KEY_FILTER_BITS);
+
+					if (((keyBits[bit >> 6] >> (bit & 63)) & 1) == 0)
+						continue;
+
+					TBS_STATS_ADD(mCandidates, 1);
+
+					const U32 slot = hash >> tables.mKeyShift;
+
+					for (U32 k = tables.mKeySlots[slot]; k < tables.mKeySlots[slot + 1]; k++)
+					{
+						if (!verify(tables.mKeyPatterns[k], start))
+							return false;
+					}
+				}
+
+				return true;
+			}
+
+			template<typename VerifyT>
+			static inline bool ScanFingerprint(const Tables& tables, const UByte* start, const UByte* end, const UByte* limit, VerifyT& verify)
+			{
+				const size_t fingerprintLen = tables.mFingerprintLen;
+				const UByte(*lo)[16] = tables.mLo;
+				const UByte(*hi)[16] = tables.mHi;
+
+				auto onCandidate = [&tables, &verify](const UByte* found, UByte buckets) {
+					TBS_STATS_ADD(mCandidates, 1);
+
+					for (; buckets; buckets &= buckets - 1)
+					{
+						const U32 bucket = CTZ(buckets);
+
+						for (U32 k = tables.mBucketStarts[bucket]; k < tables.mBucketStarts[bucket + 1]; k++)
+						{
+							if (!verify(tables.mBucketPatterns[k], found))
+								return false;
+						}
+					}
+
+					return true;
+					};
+
+#ifdef TBS_IMPL_AVX
+				if (Dispatch::UseAVX2() && (start = Memory::SIMD::AVX2::Fingerprint(start, end, limit, lo, hi, fingerprintLen, onCandidate)) == nullptr)
+					return false;
+#endif
+
+#ifdef TBS_IMPL_SSE2
+				if (Dispatch::UseSSSE3() && (start = Memory::SIMD::SSE2::Fingerprint(start, end, limit, lo, hi, fingerprintLen, onCandidate)) == nullptr)
+					return false;
+#endif
+
+				// Scalar sweep, also the tail of the vectorized ones
+
+				for (; start < end && (size_t)(limit - start) >= fingerprintLen; start++)
+				{
+					UByte buckets = 0xFF;
+
+					for (size_t k = 0; k < fingerprintLen && buckets; k++)
+						buckets &= lo[k][start[k] & 0x0F] & hi[k][start[k] >> 4];
+
+					if (buckets && !onCandidate(start, buckets))
+						return false;
+				}
+
+				return true;
+			}
+
+			/*
+				False only when `onMatch` aborted
+			*/
+			template<typename OnMatchT>
+			inline bool Verify(U32 i, const UByte* found, const UByte* limit, OnMatchT& onMatch) const
+			{
+				const ParseResult& parsed = *mPatterns[i];
+				const size_t patternSize = parsed.getTrimmedSize();
+
+				if ((size_t)(limit - found) < patternSize)
+					return true;
+
+				const bool bWhole = parsed.IsPadded() && (size_t)(limit - found) >= parsed.getPaddedSize();
+
+				TBS_STATS_ADD(mCompares, 1);
+
+				if (bWhole && !ComparePadded(found, parsed.getPaddedPattern(), parsed.getPaddedCompareMask(), parsed.getPaddedSize()))
+					return true;
+
+				if (!bWhole && !Compare(found, parsed.getTrimmedPattern(), patternSize, parsed.getTrimmedCompareMask()))
+					return true;
+
+				TBS_STATS_ADD(mMatches, 1);
+
+				return onMatch(i, found);
+			}
+		};
+
+		/*
+			Descriptions sharing the exact same search range,
+			scanned together through a single MultiMatcher
+		*/
+		struct Group {
+			inline Group(const UByte* searchStart, const UByte* searchEnd)
+				: mSearchStart(searchStart)
+				, mSearchEnd(searchEnd)
+				, mbAllFirst(true)
+			{}
+
+			inline void Add(Description& desc)
+			{
+				mDescriptions.push_back(&desc);
+				mMatcher.Add(desc.mParsed);
+				mbAllFirst = mbAllFirst && desc.mShared.mScanType == EScan::SCAN_FIRST;
+			}
+
+			/*
+				Only groups made of SCAN_FIRST descriptions can run out of work early
+			*/
+			inline bool Superseded(const Sink& sink, const UByte* sliceStart) const
+			{
+				if (!mbAllFirst)
+					return false;
+
+				for (const Description* desc : mDescriptions)
+				{
+					const Outcome& outcome = sink.Of(desc->mShared);
+
+					if (!outcome.mFinished && !Pattern::Superseded(*desc, outcome, sliceStart))
+						return false;
+				}
+
+				return true;
+			}
+
+			const UByte* mSearchStart;
+			const UByte* mSearchEnd;
+			Vector<Description*> mDescriptions;
+			MultiMatcher mMatcher;
+			bool mbAllFirst;
+		};
+
+		/*
+			Compiled groups a reusable State keeps across scans, one per range & set of
+			descriptions searching it. Groups held by a running scan are never evicted,
+			past CAPACITY the least recently used idle one makes room
+		*/
+		struct GroupCache {
+			static constexpr size_t CAPACITY = 64;
+
+			struct Entry {
+				inline Entry(const UByte* searchStart, const UByte* searchEnd)
+					: mGroup(searchStart, searchEnd)
+					, mLastUse(0)
+					, mUsers(0)
+				{}
+
+				Group mGroup;
+				Vector<size_t> mIndices;	// Into State::mDescriptionts, ascending
+				U64 mLastUse;
+				size_t mUsers;
+			};
+
+			inline void Clear()
+			{
+				mEntries.clear();
+			}
+
+			Vector<UniquePtr<Entry>> mEntries;
+			U64 mTick = 0;
+#ifdef TBS_MT
+			std::mutex mMutex;
+#endif
+		};
+
+		/*
+			Scans every trimmed start in [sliceStart, sliceEnd) of the group
+			in a single sweep, matches may extend up to the group search end
+		*/
+		static void Scan(Group& group, const Sink& sink, const UByte* sliceStart, const UByte* sliceEnd, Matches& matches)
+		{
+			if (group.Superseded(sink, sliceStart))
+				return;
+
+			group.mMatcher.Scan(sliceStart, sliceEnd, group.mSearchEnd, [&group, &sink, &matches](U32 i, const UByte* found) {
+				Description& desc = *group.mDescriptions[i];
+				Outcome& outcome = sink.Of(desc.mShared);
+
+				if (!outcome.mFinished)
+					Collect(desc, outcome, found, matches);
+
+				return true;
+				});
+		}
+	}
+
+	namespace Pattern {
+		template<U32 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE>
+		struct DescriptionBuilder {
+
+			inline DescriptionBuilder(UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY>& sharedDescriptions)
+				: mSharedDescriptions(sharedDescriptions)
+				, mScanStart(0)
+				, mScanEnd(0)
+				, mScanType(EScan::SCAN_ALL)
+				, mRawPattern(0)
+				, mRawMask(0)
+			{}
+
+			inline DescriptionBuilder& setPattern(const String<>& pattern)
+			{
+				mPattern = pattern;
+
+				if (!mUID.empty())
+					return *this;
+
+				return setUID(pattern);
+			}
+
+			/*
+				Already parsed at compile time, UID defaults to the pattern text
+			*/
+			template<size_t N>
+			inline DescriptionBuilder& setPattern(const Compiled<N>& compiled)
+			{
+				mCompiled = compiled.ToParseResult();
+
+				if (!mUID.empty() || compiled.mSource == nullptr)
+					return *this;
+
+				return setUID(compiled.mSource);
+			}
+
+			inline DescriptionBuilder& setPatternRaw(const void* pattern)
+			{
+				mRawPattern = pattern;
+
+				if (!mUID.empty())
+					return *this;
+
+#ifdef TBS_USE_ETL
+				TBS::String<> uid;
+				uid = etl::to_string((UPtr)pattern, uid);
+				return setUID(uid);
+#else
+				return setUID(std::to_string((UPtr)pattern));
+#endif
+			}
+
+			inline DescriptionBuilder& setMask(const char* mask)
+			{
+				mRawMask = mask;
+				return *this;
+			}
+
+			inline DescriptionBuilder& setUID(const String<>& uid)
+			{
+				mUID = uid;
+				return *this;
+			}
+
+			template<typename T>
+			inline DescriptionBuilder& setScanStart(T start)
+			{
+				mScanStart = (const UByte*)start;
+				return *this;
+			}
+
+			template<typename T>
+			inline DescriptionBuilder& setScanEnd(T end, bool bOffsetFromStart = false)
+			{
+				mScanEnd = (const UByte*)end;
+
+				if (bOffsetFromStart)
+					mScanEnd += (UPtr)mScanStart;
+
+				return *this;
+			}
+
+			inline DescriptionBuilder& AddTransformer(const Description::ResultTransformer& transformer)
+			{
+				mTransformers.emplace_back(transformer);
+				return *this;
+			}
+
+			/*
+				Steps & batch transformers belong to the UID, they run once over all its
+				results after the scan, the last Build() of the UID setting any wins
+			*/
+			inline DescriptionBuilder& addStep(const ResultStep& step)
+			{
+				mSteps.push_back(step);
+				return *this;
+			}
+
+			inline DescriptionBuilder& addOffset(intptr_t offset)
+			{
+				return addStep(ResultStep::Add(offset));
+			}
+
+			inline DescriptionBuilder& deref(intptr_t offset = 0)
+			{
+				return addStep(ResultStep::Deref(offset));
+			}
+
+			inline DescriptionBuilder& resolveRel32(intptr_t dispOffset, intptr_t size = 0)
+			{
+				return addStep(ResultStep::Rel32(dispOffset, size));
+			}
+
+			inline DescriptionBuilder& resolveRel8(intptr_t dispOffset, intptr_t size = 0)
+			{
+				return addStep(ResultStep::Rel8(dispOffset, size));
+			}
+
+			inline DescriptionBuilder& modRMDisp(intptr_t modRMOffset)
+			{
+				return addStep(ResultStep::ModRMDisp(modRMOffset));
+			}
+
+			inline DescriptionBuilder& AddBatchTransformer(const Description::BatchTransformer& transformer)
+			{
+				mBatchTransformers.emplace_back(transformer);
+				return *this;
+			}
+
+			inline DescriptionBuilder& setScanType(EScan type)
+			{
+				mScanType = type;
+				return *this;
+			}
+
+			inline DescriptionBuilder& stopOnFirstMatch()
+			{
+				return setScanType(EScan::SCAN_FIRST);
+			}
+
+			inline DescriptionBuilder Clone() const
+			{
+				return DescriptionBuilder(*this);
+			}
+
+			inline Description Build()
+			{
+				// Parsed once, straight into what the description keeps
+
+				ParseResult parsed;
+
+				if (mCompiled)
+					parsed = mCompiled;
+				else if (mRawPattern && mRawMask)
+					Parse(mRawPattern, mRawMask, parsed);
+				else if (!Parse(mPattern, parsed) || !parsed)
+				{
+					static SharedDescription nullSharedDesc(EScan::SCAN_ALL);
+					static Description nullDescription(nullSharedDesc, "", 0, 0, {}, "");
+					return nullDescription;
+				}
+
+				auto& sharedPtr = mSharedDescriptions[mUID];
+
+				if (!sharedPtr)
+					sharedPtr = UniquePtr<SharedDescription>(new SharedDescription(mScanType, mSharedDescriptions.size() - 1));
+
+				SharedDescription& shared = *sharedPtr;
+
+				if (!mSteps.empty())
+					shared.mSteps = mSteps;
+
+				if (!mBatchTransformers.empty())
+					shared.mBatchTransforms = mBatchTransformers;
+
+				return Description(shared, mUID, mScanStart, mScanEnd, mTransformers, std::move(parsed));
+			}
+
+		private:
+			UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY>& mSharedDescriptions;
+			EScan mScanType;
+			String<> mPattern;
+			ParseResult mCompiled;
+			const void* mRawPattern;
+			const char* mRawMask;
+			String<> mUID;
+			const UByte* mScanStart;
+			const UByte* mScanEnd;
+			Vector<ResultTransformer> mTransformers;
+			ResultSteps mSteps;
+			Vector<Description::BatchTransformer> mBatchTransformers;
+		};
+	}
+
+	namespace Process {
+		/*
+			Mapped range [mStart, mEnd) of some address space
+		*/
+		struct Region {
+			enum EProt : UByte {
+				READ = 1 << 0,
+				WRITE = 1 << 1,
+				EXEC = 1 << 2,
+			};
+
+			UPtr mStart;
+			UPtr mEnd;
+			UByte mProt;
+			String<> mPath;
+		};
+
+		struct RegionFilter {
+			inline RegionFilter()
+				: mProt(Region::READ)
+				, mStart(0)
+				, mEnd(~UPtr(0))
+			{}
+
+			/*
+				All of `prot` bits are required
+			*/
+			inline RegionFilter& setProt(UByte prot)
+			{
+				mProt = prot;
+				return *this;
+			}
+
+			/*
+				Only regions whose mapped path contains `module`
+			*/
+			inline RegionFilter& setModule(const String<>& module)
+			{
+				mModule = module;
+				return *this;
+			}
+
+			/*
+				Only [start, end), overlapping regions get clamped to it
+			*/
+			template<typename T>
+			inline RegionFilter& setRange(T start, T end)
+			{
+				mStart = (UPtr)start;
+				mEnd = (UPtr)end;
+				return *this;
+			}
+
+			inline bool Accepts(const Region& region) const
+			{
+				if ((region.mProt & mProt) != mProt)
+					return false;
+
+				if (region.mEnd <= mStart || region.mStart >= mEnd)
+					return false;
+
+				return mModule.empty() || region.mPath.find(mModule) != String<>::npos;
+			}
+
+			UByte mProt;
+			String<> mModule;
+			UPtr mStart;
+			UPtr mEnd;
+		};
+
+		/*
+			Address space the scanner cant dereference directly,
+			everything is reached through Read()
+		*/
+		struct RegionProvider {
+			virtual ~RegionProvider() = default;
+
+			/*
+				Appends the mapped regions, ascending
+			*/
+			virtual bool Regions(Vector<Region>& regions) = 0;
+
+			/*
+				Reads [address, address + len) into `out`, returns how many
+				bytes were read before the first unreadable one
+			*/
+			virtual size_t Read(UPtr address, UByte* out, size_t len) = 0;
+		};
+
+		/*
+			Contiguous run of bytes read from a provider, mBytes keeps headroom
+			in front of the data so the bytes carried from the previous block can be prepended
+		*/
+		struct Block {
+			UPtr mAddress;
+			size_t mLen;
+			bool mbContinues; // Data follows the previous block data without gap
+			Vector<UByte> mBytes;
+		};
+
+		/*
+			Bytes read per block
+		*/
+		constexpr size_t BLOCK_SIZE = PG_SIZE * 256;
+
+		/*
+			Reads `regions` block by block into reusable buffers, handing each one to `onBlock(block)`.
+			Unreadable pages split a region, the block after them doesnt continue.
+			Under TBS_MT the next block is read by the pool while the current one is handed out,
+			so `onBlock` may run on a pool worker, though never concurrently with itself.
+			`onBlock` returning false aborts.
+		*/
+		template<typename OnBlockT>
+		inline bool StreamBlocks(RegionProvider& provider, const Vector<Region>& regions, size_t headroom, OnBlockT&& onBlock)
+		{
+			size_t regionIdx = 0;
+			UPtr cursor = regions.empty() ? 0 : regions[0].mStart;
+			bool bContinues = false;
+
+			auto produce = [&](Block& block) {
+				block.mBytes.resize(headroom + BLOCK_SIZE);
+
+				for (; regionIdx < regions.size(); regionIdx++, bContinues = false)
+				{
+					const Region& region = regions[regionIdx];
+
+					if (cursor < region.mStart)
+						cursor = region.mStart;
+
+					while (cursor < region.mEnd)
+					{
+						const size_t len = region.mEnd - cursor < BLOCK_SIZE ? size_t(region.mEnd - cursor) : BLOCK_SIZE;
+						const size_t read = provider.Read(cursor, block.mBytes.data() + headroom, len);
+
+						block.mAddress = cursor;
+						block.mLen = read;
+						block.mbContinues = bContinues;
+
+						// At this point, unreadable page at cursor + read if short, skipping it
+
+						cursor = read == len ? cursor + len : ((cursor + read) & ~UPtr(PG_SIZE - 1)) + PG_SIZE;
+						bContinues = read == len;
+
+						if (read)
+							return true;
+					}
+				}
+
+				return false;
+				};
+
+#ifdef TBS_MT
+			// Reading the next block & handing out the current one are two tasks
+			// of the process wide pool, no thread gets started per scan
+
+			struct StepTask : Thread::TaskOf<StepTask> {
+				inline StepTask(decltype(produce)& produce, OnBlockT& onBlock, Block& block, bool bRead)
+					: mProduce(&produce)
+					, mOnBlock(&onBlock)
+					, mBlock(&block)
+					, mbRead(bRead)
+					, mbResult(false)
+				{}
+
+				inline void Run()
+				{
+					mbResult = mbRead ? (*mProduce)(*mBlock) : (*mOnBlock)(*mBlock);
+				}
+
+				decltype(produce)* mProduce;
+				std::remove_reference_t<OnBlockT>* mOnBlock;
+				Block* mBlock;
+				bool mbRead;
+				bool mbResult;
+			};
+
+			Block blocks[2];
+
+			if (!produce(blocks[0]))
+				return true;
+
+			for (size_t i = 0;; i++)
+			{
+				StepTask steps[] = {
+					StepTask(produce, onBlock, blocks[i % 2], false),
+					StepTask(produce, onBlock, blocks[(i + 1) % 2], true),
+				};
+
+				Thread::Run(steps, 2);
+
+				if (!steps[0].mbResult)
+					return false;
+
+				if (!steps[1].mbResult)
+					return true;
+			}
+#else
+			Block block;
+
+			while (produce(block))
+			{
+				if (!onBlock(block))
+					return false;
+			}
+
+			return true;
+#endif
+		}
+
+		/*
+			Regions of `provider` accepted by `filter`, clamped to its range
+		*/
+		inline Vector<Region> Regions(RegionProvider& provider, const RegionFilter& filter)
+		{
+			Vector<Region> all, accepted;
+
+			provider.Regions(all);
+
+			for (const Region& region : all)
+			{
+				if (!filter.Accepts(region))
+					continue;
+
+				accepted.push_back(region);
+				accepted.back().mStart = region.mStart > filter.mStart ? region.mStart : filter.mStart;
+				accepted.back().mEnd = region.mEnd < filter.mEnd ? region.mEnd : filter.mEnd;
+			}
+
+			return accepted;
+		}
+
+		/*
+			Scans the `filter` accepted regions of `provider` for `parsed`, streamed in blocks,
+			reporting remote addresses of the matches, ascending, through `onMatch(address)`.
+			The last trimmed size - 1 bytes of a block are carried into the next one,
+			so matches straddling blocks are found. `onMatch` returning false aborts,
+			under TBS_MT it may be called from a pool worker, one call at a time.
+		*/
+		template<typename OnMatchT>
+		inline bool Scan(RegionProvider& provider, const RegionFilter& filter, const Pattern::ParseResult& parsed, OnMatchT&& onMatch)
+		{
+			const size_t patternSize = parsed.getTrimmedSize();
+
+			if (!parsed.mParseSuccess || patternSize == 0)
+				return true;
+
+			const size_t carryMax = patternSize - 1;
+			Vector<UByte> carry(carryMax);
+			size_t carried = 0;
+
+			return StreamBlocks(provider, Regions(provider, filter), carryMax, [&](Block& block) {
+				UByte* data = block.mBytes.data() + carryMax;
+
+				if (!block.mbContinues)
+					carried = 0;
+
+				memcpy(data - carried, carry.data(), carried);
+
+				const UByte* scanStart = data - carried;
+				const UByte* scanEnd = data + block.mLen;
+				const UPtr scanAddress = block.mAddress - carried;
+
+				const bool bCompleted = Pattern::Find(parsed, scanStart, scanEnd, [&](const UByte* found) {
+					return onMatch((Pattern::Result)(scanAddress + (found - scanStart) - parsed.mTrimmDisp));
+					});
+
+				// At this point, carrying the tail, it might start a match ending in the next block
+
+				carried = (size_t)(scanEnd - scanStart) < carryMax ? (size_t)(scanEnd - scanStart) : carryMax;
+				memcpy(carry.data(), scanEnd - carried, carried);
+
+				return bCompleted;
+				});
+		}
+
+		inline bool Scan(RegionProvider& provider, const RegionFilter& filter, Pattern::Results& results, const Pattern::ParseResult& parsed)
+		{
+			results.clear();
+
+			Scan(provider, filter, parsed, [&results](Pattern::Result found) {
+				results.push_back(found);
+				return true;
+				});
+
+			return results.empty() == false;
+		}
+
+		inline bool Scan(RegionProvider& provider, const RegionFilter& filter, Pattern::Results& results, const char* pattern)
+		{
+			Pattern::ParseResult parse;
+
+			if (Pattern::Parse(pattern, parse) == false)
+				return false;
+
+			return Scan(provider, filter, results, parse);
+		}
+
+		inline bool ScanOne(RegionProvider& provider, const RegionFilter& filter, Pattern::Result& result, const Pattern::ParseResult& parsed)
+		{
+			bool bFound = false;
+
+			Scan(provider, filter, parsed, [&result, &bFound](Pattern::Result found) {
+				result = found;
+				bFound = true;
+				return false;
+				});
+
+			return bFound;
+		}
+
+#if defined(__linux__)
+		/*
+			Another process, regions from /proc/<pid>/maps, read with process_vm_readv.
+			Needs ptrace access to it (same user & a parent, or CAP_SYS_PTRACE)
+		*/
+		struct LinuxProvider : RegionProvider {
+			/*
+				Remote iovecs per process_vm_readv, bounded by IOV_MAX
+			*/
+			static constexpr size_t READ_BATCH = 1024;
+
+			inline LinuxProvider(pid_t pid)
+				: mPid(pid)
+			{}
+
+			inline bool Regions(Vector<Region>& regions) override
+			{
+				char mapsPath[64];
+				snprintf(mapsPath, sizeof(mapsPath), "/proc/%d/maps", (int)mPid);
+
+				FILE* maps = fopen(mapsPath, "r");
+
+				if (maps == nullptr)
+					return false;
+
+				char line[PG_SIZE + 256];
+
+				while (fgets(line, sizeof(line), maps))
+				{
+					unsigned long long start = 0, end = 0;
+					char perms[5] = {};
+					int pathPos = 0;
+
+					if (sscanf(line, "%llx-%llx %4s %*s %*s %*s %n", &start, &end, perms, &pathPos) < 3)
+						continue;
+
+					Region region;
+					region.mStart = (UPtr)start;
+					region.mEnd = (UPtr)end;
+					region.mProt =
+						(perms[0] == 'r' ? Region::READ : 0) |
+						(perms[1] == 'w' ? Region::WRITE : 0) |
+						(perms[2] == 'x' ? Region::EXEC : 0);
+
+					if (pathPos > 0)
+					{
+						size_t pathLen = strlen(line + pathPos);
+
+						for (; pathLen && (line[pathPos + pathLen - 1] == '\n' || line[pathPos + pathLen - 1] == ' '); pathLen--)
+							;
+
+						region.mPath = String<>(line + pathPos, pathLen);
+					}
+
+					regions.push_back(region);
+				}
+
+				fclose(maps);
+
+				return true;
+			}
+
+			/*
+				Partial transfers only happen at remote iovec granularity,
+				so the range is split per page to get the exact readable prefix
+			*/
+			inline size_t Read(UPtr address, UByte* out, size_t len) override
+			{
+				iovec remote[READ_BATCH];
+				size_t total = 0;
+
+				while (total < len)
+				{
+					const UPtr batchStart = address + total;
+					UPtr at = batchStart;
+					size_t count = 0;
+
+					for (; count < READ_BATCH && at < address + len; count++)
+					{
+						const UPtr pageEnd = (at & ~UPtr(PG_SIZE - 1)) + PG_SIZE;
+						const UPtr chunkEnd = pageEnd < address + len ? pageEnd : address + len;
+
+						remote[count].iov_base = (void*)at;
+						remote[count].iov_len = chunkEnd - at;
+						at = chunkEnd;
+					}
+
+					iovec local;
+					local.iov_base = out + total;
+					local.iov_len = at - batchStart;
+
+					const ssize_t read = process_vm_readv(mPid, &local, 1, remote, count, 0);
+
+					if (read <= 0)
+						break;
+
+					total += (size_t)read;
+
+					if ((size_t)read < local.iov_len)
+						break;
+				}
+
+				return total;
+			}
+
+			pid_t mPid;
+		};
+
+		/*
+			Readable spans of the current process, adjacent readable mappings coalesced.
+			Built from /proc/self/maps on first use & cached, Refresh() after mapping
+			memory later scans should see or changing its protection. Spans unmapped
+			since are noticed before being handed out & the cache gets rebuilt.
+			[vvar], [vsyscall] & device mappings are left out, reading them may fault
+			even though they are mapped readable.
+			Files mapped in are read like any other memory, truncating one under the
+			scan raises SIGBUS on pages past its new end, nothing guards against that
+		*/
+		struct Self {
+			static Self& Instance()
+			{
+				static Self self;
+				return self;
+			}
+
+			inline void Refresh()
+			{
+#ifdef TBS_MT
+				std::lock_guard<std::mutex> lock(mMutex);
+#endif
+				mbBuilt = false;
+			}
+
+			/*
+				Calls `onSpan(spanStart, spanEnd)` for every readable span of [start, end), ascending
+			*/
+			template<typename OnSpanT>
+			inline void ForEachReadable(const UByte* start, const UByte* end, OnSpanT&& onSpan)
+			{
+#ifdef TBS_MT
+				std::lock_guard<std::mutex> lock(mMutex);
+#endif
+				if (!mbBuilt || !Mapped(start, end))
+					Build();
+
+				for (const Region& span : mSpans)
+				{
+					const UByte* spanStart = (const UByte*)span.mStart < start ? start : (const UByte*)span.mStart;
+					const UByte* spanEnd = (const UByte*)span.mEnd > end ? end : (const UByte*)span.mEnd;
+
+					if (spanStart < spanEnd)
+						onSpan(spanStart, spanEnd);
+				}
+			}
+
+		private:
+			inline Self()
+				: mbBuilt(false)
+			{}
+
+			inline void Build()
+			{
+				Vector<Region> regions;
+
+				mSpans.clear();
+				LinuxProvider(getpid()).Regions(regions);
+
+				for (const Region& region : regions)
+				{
+					if (!(region.mProt & Region::READ) || region.mPath.find("[vvar") == 0 || region.mPath.find("[vsyscall") == 0 || region.mPath.find("/dev/") == 0)
+						continue;
+
+					if (!mSpans.empty() && mSpans.back().mEnd == region.mStart)
+					{
+						mSpans.back().mEnd = region.mEnd;
+						continue;
+					}
+
+					mSpans.push_back(region);
+				}
+
+				mbBuilt = true;
+			}
+
+			/*
+				False once part of a cached span within [start, end) got unmapped,
+				msync() fails with ENOMEM on unmapped pages & reads nothing
+			*/
+			inline bool Mapped(const UByte* start, const UByte* end) const
+			{
+				for (const Region& span : mSpans)
+				{
+					const UPtr spanStart = span.mStart < (UPtr)start ? (UPtr)start & ~UPtr(PG_SIZE - 1) : span.mStart;
+					const UPtr spanEnd = span.mEnd > (UPtr)end ? (UPtr)end : span.mEnd;
+
+					if (spanStart < spanEnd && msync((void*)spanStart, spanEnd - spanStart, MS_ASYNC) != 0 && errno == ENOMEM)
+						return false;
+				}
+
+				return true;
+			}
+
+			Vector<Region> mSpans;
+			bool mbBuilt;
+#ifdef TBS_MT
+			std::mutex mMutex;
+#endif
+		};
+#endif
+	}
+
+	/*
+		What an incremental State (State::setIncremental()) keeps between scans,
+		a hash per page of every range searched & every match each description had
+	*/
+	namespace Incremental {
+		constexpr U64 PAGE_SIZE = PG_SIZE;
+
+		/*
+			Pages are counted from mStart, the last one may be partial
+		*/
+		struct Range {
+			inline Range(const UByte* start, const UByte* end)
+				: mStart(start)
+				, mEnd(end)
+			{}
+
+			inline size_t PageCount() const
+			{
+				return (size_t)((mEnd - mStart + PAGE_SIZE - 1) / PAGE_SIZE);
+			}
+
+			const UByte* mStart;
+			const UByte* mEnd;
+			Vector<U64> mHashes;
+			Vector<UByte> mDirty;	// Per page, as of the last scan
+		};
+
+		/*
+			Match of a description, where its trimmed pattern starts & the user transformed value
+		*/
+		struct Hit {
+			const UByte* mAt;
+			Pattern::Result mValue;
+		};
+
+		using Hits = Vector<Hit>;
+
+		/*
+			Which description searched which range, see ScanTarget
+		*/
+		struct Key {
+			inline bool operator<(const Key& other) const
+			{
+				if (mIndex != other.mIndex)
+					return mIndex < other.mIndex;
+
+				return mStart != other.mStart ? std::less<>()(mStart, other.mStart) : std::less<>()(mEnd, other.mEnd);
+			}
+
+			inline bool operator==(const Key& other) const
+			{
+				return mIndex == other.mIndex && mStart == other.mStart && mEnd == other.mEnd;
+			}
+
+			size_t mIndex;
+			const UByte* mStart;
+			const UByte* mEnd;
+		};
+
+		struct Snapshot {
+			Vector<Range> mRanges;	// Sorted by bounds
+			Vector<Key> mTargets;	// Sorted, targets not in it are searched whole
+			Vector<Hits> mKnown;	// Parallel to mTargets
+		};
+	}
+
+	template<U64 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE, U64 DESCS_CAPACITY = SHAREDDESCS_CAPACITY * 2>
+	struct State {
+
+		using DescriptionBuilderT = Pattern::DescriptionBuilder<SHAREDDESCS_CAPACITY>;
+
+		static constexpr U64 DESCRIPTIONS_CAPACITY = DESCS_CAPACITY;
+
+		inline State()
+			: State(nullptr, nullptr)
+		{}
+
+		template<typename T, typename K>
+		inline State(T defScanStart = (T)0, K defScanEnd = (K)0)
+			: mDefaultScanStart((const UByte*)defScanStart)
+			, mDefaultScanEnd((const UByte*)defScanEnd)
+			, mMultiPattern(false)
+			, mbSafeScan(false)
+			, mbIncremental(false)
+			, mbReusable(false)
+		{}
+
+		/*
+			Results of Scan(state, results), kept apart from the State so its descriptions
+			are only read & several scans can run at once, each into its own ScanResults.
+			Scans accumulate into it until Reset()
+		*/
+		struct ScanResults {
+			inline ScanResults(const State& state)
+				: mState(&state)
+			{}
+
+			inline Pattern::SharedResultAccesor operator[](const String<>& uid) const
+			{
+				static const Pattern::Outcome nullOutcome;
+
+				auto it = mState->mSharedDescriptions.find(uid);
+
+				if (it == mState->mSharedDescriptions.end() || it->second->mIndex >= mOutcomes.size())
+					return nullOutcome;
+
+				return *mOutcomes[it->second->mIndex];
+			}
+
+			inline ScanResults& Reset()
+			{
+				for (auto& outcome : mOutcomes)
+					outcome->Reset();
+
+				return *this;
+			}
+
+			/*
+				An outcome for every UID of the State, those added since included
+			*/
+			inline Pattern::Sink GetSink()
+			{
+				while (mOutcomes.size() < mState->mSharedDescriptions.size())
+					mOutcomes.emplace_back(new Pattern::Outcome());
+
+				return Pattern::Sink{ mOutcomes.data() };
+			}
+
+			const State* mState;
+			Vector<UniquePtr<Pattern::Outcome>> mOutcomes;
+		};
+
+		/*
+			When enabled, description ranges are cut down to the readable spans
+			of the current process (Process::Self) before scanning, so a single
+			State can cover the whole address space, holes & guard pages included.
+			Linux only, elsewhere ranges are scanned as given
+		*/
+		inline State& setSafeScan(bool bSafeScan = true)
+		{
+			mbSafeScan = bSafeScan;
+			return *this;
+		}
+
+		/*
+			When enabled, descriptions sharing a search range are
+			compiled into a single Pattern::MultiMatcher & scanned in one pass
+		*/
+		inline State& setMultiPattern(bool bMultiPattern = true)
+		{
+			mMultiPattern = bMultiPattern;
+			return *this;
+		}
+
+		/*
+			When enabled, descriptions are kept after Scan() along with a hash of every
+			page they searched & the matches they had. Later scans hash the pages again &
+			only search around the changed ones, so unchanged memory costs a hashing pass.
+			Results are those of the memory as of the last Scan() instead of accumulating.
+			Ranges must stay readable in between, multi-pattern grouping doesnt apply
+		*/
+		inline State& setIncremental(bool bIncremental = true)
+		{
+			mbIncremental = bIncremental;
+			return *this;
+		}
+
+		/*
+			When enabled, Scan() keeps the descriptions, so the State gets scanned again
+			without rebuilding them, & Scan(state, results) is usable. Multi-pattern
+			groups stay compiled per range too. Results keep accumulating in the State
+			until ResetResults()
+		*/
+		inline State& setReusable(bool bReusable = true)
+		{
+			mbReusable = bReusable;
+			return *this;
+		}
+
+		/*
+			Clears what every Scan(state) found so far
+		*/
+		inline State& ResetResults()
+		{
+			for (auto& sharedDescKv : mSharedDescriptions)
+				sharedDescKv.second->mOutcome.Reset();
+
+			return *this;
+		}
+
+		/*
+			Forgets page hashes & matches, the next incremental Scan() searches everything
+		*/
+		inline State& ResetIncremental()
+		{
+			mSnapshot = Incremental::Snapshot();
+			return *this;
+		}
+
+		inline State& AddPattern(Pattern::Description&& pattern)
+		{
+			mGroupCache.Clear();
+			mDescriptionts.emplace_back(std::move(pattern));
+			return *this;
+		}
+
+		/*
+			Already parsed & planned pattern over the default range, all its matches
+		*/
+		inline State& AddPattern(const String<>& uid, Pattern::ParseResult&& parsed)
+		{
+			auto& sharedPtr = mSharedDescriptions[uid];
+
+			if (!sharedPtr)
+				sharedPtr = UniquePtr<Pattern::SharedDescription>(new Pattern::SharedDescription(Pattern::EScan::SCAN_ALL, mSharedDescriptions.size() - 1));
+
+			static const Vector<Pattern::ResultTransformer> noTransformers;
+
+			mGroupCache.Clear();
+			mDescriptionts.emplace_back(*sharedPtr, uid, mDefaultScanStart, mDefaultScanEnd, noTransformers, std::move(parsed));
+			return *this;
+		}
+
+		/*
+			Bulk AddPattern(), every pattern searching the default range for all its
+			matches, storage reserved once. Returns how many were valid, invalid ones are skipped
+		*/
+		inline size_t AddPatterns(const Pattern::Source* sources, size_t count)
+		{
+#ifndef TBS_USE_ETL
+			mDescriptionts.reserve(mDescriptionts.size() + count);
+			mSharedDescriptions.reserve(mSharedDescriptions.size() + count);
+#endif
+
+			String<> uid;
+			size_t added = 0;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				Pattern::ParseResult parsed;
+
+				if (!Pattern::Parse(sources[i].mPattern, parsed) || !parsed)
+					continue;
+
+				const StringView uidView = sources[i].mUID.empty() ? sources[i].mPattern : sources[i].mUID;
+				uid.assign(uidView.data(), uidView.size());
+
+				AddPattern(uid, std::move(parsed));
+				added++;
+			}
+
+			return added;
+		}
+
+		template<typename SourcesT>
+		inline size_t AddPatterns(const SourcesT& sources)
+		{
+			return AddPatterns(sources.data(), sources.size());
+		}
+
+		/*
+			Re-plans every added description for data distributed as `histogram`,
+			for instance Pattern::Histogram().Sample(mDefaultScanStart, mDefaultScanEnd)
+		*/
+		inline State& Replan(const Pattern::Histogram& histogram)
+		{
+			for (Pattern::Description& description : mDescriptionts)
+				Pattern::BuildPlan(description.mParsed, histogram);
+
+			return *this;
+		}
+
+		inline DescriptionBuilderT PatternBuilder()
+		{
+			return DescriptionBuilderT(mSharedDescriptions)
+				.setScanStart(mDefaultScanStart)
+				.setScanEnd(mDefaultScanEnd);
+		}
+
+#ifdef TBS_STATS
+		/*
+			Counters of every Scan() of this State so far
+		*/
+		inline const Stats::StateStats& GetStats() const
+		{
+			return mStats;
+		}
+
+		/*
+			Counters of the description(s) added with `uid`
+		*/
+		inline const Stats::DescriptionStats& GetStats(const String<>& uid) const
+		{
+			static const Stats::DescriptionStats nullStats;
+
+			auto it = mSharedDescriptions.find(uid);
+
+			return it != mSharedDescriptions.end() ? it->second->mStats : nullStats;
+		}
+
+		inline State& ResetStats()
+		{
+			mStats = Stats::StateStats();
+
+			for (auto& sharedDescKv : mSharedDescriptions)
+				sharedDescKv.second->mStats = Stats::DescriptionStats();
+
+			return *this;
+		}
+
+		/*
+			Held while a scan folds its counters in, scans of a reusable State may overlap
+		*/
+		struct StatsLock {
+#ifdef TBS_MT
+			inline StatsLock(State& state)
+				: mLock(state.mStatsMutex)
+			{}
+
+			std::lock_guard<std::mutex> mLock;
+#else
+			inline StatsLock(State&)
+			{}
+#endif
+		};
+#endif
+
+		inline Pattern::SharedResultAccesor operator[](const String<>& uid) const
+		{
+			if (mSharedDescriptions.find(uid) != mSharedDescriptions.end())
+				return mSharedDescriptions.at(uid)->mOutcome;
+
+			static const Pattern::Outcome nullOutcome;
+
+			return nullOutcome;
+		}
+
+		const UByte* mDefaultScanStart;
+		const UByte* mDefaultScanEnd;
+		UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY> mSharedDescriptions;
+		Vector<Pattern::Description, DESCS_CAPACITY> mDescriptionts;
+		bool mMultiPattern;
+		bool mbSafeScan;
+		bool mbIncremental;
+		bool mbReusable;
+		Incremental::Snapshot mSnapshot;
+		Pattern::GroupCache mGroupCache;	// Reusable multi-pattern States only
+#ifdef TBS_STATS
+		Stats::StateStats mStats;
+#ifdef TBS_MT
+		std::mutex mStatsMutex;
+#endif
+#endif
+	};
+
+	/*
+		A description & the range one scan searches it over, its own one, the one
+		given to Scan() or a readable span of either. This is all a scan keeps per
+		description, the descriptions themselves are only ever read
+	*/
+	struct ScanTarget {
+		inline Incremental::Key Key() const
+		{
+			return Incremental::Key{ mIndex, mStart, mEnd };
+		}
+
+		size_t mIndex;	// Into State::mDescriptionts
+		Pattern::Description* mDescription;
+		const UByte* mStart;
+		const UByte* mEnd;
+	};
+
+	/*
+		Every description over `range`, or its own range when null, cut down
+		to the readable spans of the current process for safe scans
+	*/
+	template<typename StateT>
+	static void MakeTargets(StateT& state, const Pattern::Description::SearchSlice* range, Vector<ScanTarget>& targets)
+	{
+		for (size_t i = 0; i < state.mDescriptionts.size(); i++)
+		{
+			Pattern::Description& description = state.mDescriptionts[i];
+			const UByte* start = range ? range->mStart : description.mSearchRangeSlicer.mStart;
+			const UByte* end = range ? range->mEnd : description.mSearchRangeSlicer.mEnd;
+
+			if (!(start < end))
+				continue;
+
+#if defined(__linux__)
+			if (state.mbSafeScan)
+			{
+				Process::Self::Instance().ForEachReadable(start, end, [&](const UByte* spanStart, const UByte* spanEnd) {
+					targets.push_back(ScanTarget{ i, &description, spanStart, spanEnd });
+					});
+
+				continue;
+			}
+#endif
+
+			targets.push_back(ScanTarget{ i, &description, start, end });
+		}
+	}
+
+	/*
+		Visits the chunks of every item interleaved, first chunk of all of them,
+		then the second ones & so on. Tasks get executed in submission order,
+		so lower chunks are always scanned first & SCAN_FIRST searches can
+		skip any chunk above an already found match.
+	*/
+	template<typename ItemsT, typename SlicerGetterT, typename OnChunkT>
+	static void ForEachChunk(ItemsT& items, SlicerGetterT&& getSlicer, OnChunkT&& onChunk)
+	{
+		using Iterator = Pattern::Description::SearchSlice::Container::Iterator;
+
+		Vector<Iterator> cursors;
+
+		for (auto& item : items)
+			cursors.push_back(getSlicer(item).begin());
+
+		for (bool bAny = true; bAny; )
+		{
+			bAny = false;
+
+			for (size_t i = 0; i < cursors.size(); i++)
+			{
+				if (cursors[i] == getSlicer(items[i]).end())
+					continue;
+
+				onChunk(items[i], *cursors[i]);
+				++cursors[i];
+				bAny = true;
+			}
+		}
+	}
+
+#ifdef TBS_STATS
+	/*
+		Per task counters, folded into the State once every task is done
+	*/
+	struct TaskStats {
+		inline Stats::TaskScope Scope()
+		{
+			mWorkerIndex = Thread::CurrentWorker();
+			return Stats::TaskScope(mCounters, mWorker);
+		}
+
+		Stats::Counters mCounters;
+		Stats::WorkerStats mWorker;
+		size_t mWorkerIndex = 0;
+	};
+
+	template<typename StateT>
+	static void FoldTaskStats(StateT& state, const TaskStats& task)
+	{
+		auto& stats = state.mStats;
+
+		if (stats.mWorkers.size() < Thread::WorkerCount() + 1)
+			stats.mWorkers.resize(Thread::WorkerCount() + 1);
+
+		stats.mTotal += task.mCounters;
+		stats.mSlices++;
+		stats.mWorkers[task.mWorkerIndex].mTasks += task.mWorker.mTasks;
+		stats.mWorkers[task.mWorkerIndex].mBusyNs += task.mWorker.mBusyNs;
+	}
+#endif
+
+	/*
+		Concatenates the per task match buffers in task order & merges them
+	*/
+	template<typename TaskT>
+	static void MergeMatches(TaskT* tasks, size_t count)
+	{
+		TBS_TRACE_SCOPE("Merge", "scan");
+
+		size_t total = 0;
+
+		for (size_t i = 0; i < count; i++)
+			total += tasks[i].mMatches.size();
+
+		if (total == 0)
+			return;
+
+		Pattern::Matches matches;
+		matches.reserve(total);
+
+		for (size_t i = 0; i < count; i++)
+			matches.insert(matches.end(), tasks[i].mMatches.begin(), tasks[i].mMatches.end());
+
+		Pattern::Merge(matches);
+	}
+
+	/*
+		Compiled group of the targets [first, last), all sharing a range, out of the
+		State cache, compiled & cached first when missing. Held until ReleaseGroups(),
+		concurrent scans of the State wait while a group compiles
+	*/
+	template<typename StateT>
+	static Pattern::GroupCache::Entry* AcquireGroup(StateT& state, const ScanTarget* first, const ScanTarget* last, U64& compiled)
+	{
+		using Entry = Pattern::GroupCache::Entry;
+
+		Pattern::GroupCache& cache = state.mGroupCache;
+		const size_t count = last - first;
+
+#ifdef TBS_MT
+		std::lock_guard<std::mutex> lock(cache.mMutex);
+#endif
+
+		const auto sameTargets = [first, count](const Entry& entry) {
+			if (entry.mGroup.mSearchStart != first->mStart || entry.mGroup.mSearchEnd != first->mEnd || entry.mIndices.size() != count)
+				return false;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				if (entry.mIndices[i] != first[i].mIndex)
+					return false;
+			}
+
+			return true;
+			};
+
+		Entry* found = nullptr;
+
+		for (const UniquePtr<Entry>& entry : cache.mEntries)
+		{
+			if (sameTargets(*entry))
+			{
+				found = entry.get();
+				break;
+			}
+		}
+
+		if (found == nullptr)
+		{
+			if (cache.mEntries.size() >= Pattern::GroupCache::CAPACITY)
+			{
+				auto idle = cache.mEntries.end();
+
+				for (auto it = cache.mEntries.begin(); it != cache.mEntries.end(); it++)
+				{
+					if ((*it)->mUsers == 0 && (idle == cache.mEntries.end() || (*it)->mLastUse < (*idle)->mLastUse))
+						idle = it;
+				}
+
+				if (idle != cache.mEntries.end())
+					cache.mEntries.erase(idle);
+			}
+
+			cache.mEntries.emplace_back(new Entry(first->mStart, first->mEnd));
+			found = cache.mEntries.back().get();
+
+			for (const ScanTarget* target = first; target < last; target++)
+			{
+				found->mGroup.Add(*target->mDescription);
+				found->mIndices.push_back(target->mIndex);
+			}
+
+			found->mGroup.mMatcher.Compile();
+			compiled++;
+		}
+
+		found->mUsers++;
+		found->mLastUse = ++cache.mTick;
+
+		return found;
+	}
+
+	template<typename StateT>
+	static void ReleaseGroups(StateT& state, Pattern::GroupCache::Entry* const* entries, size_t count)
+	{
+		if (count == 0)
+			return;
+
+#ifdef TBS_MT
+		std::lock_guard<std::mutex> lock(state.mGroupCache.mMutex);
+#else
+		(void)state;
+#endif
+
+		for (size_t i = 0; i < count; i++)
+			entries[i]->mUsers--;
+	}
+
+	template<typename StateT>
+	static void ScanGrouped(StateT& state, Vector<ScanTarget>& targets, const Pattern::Sink& sink)
+	{
+		std::stable_sort(targets.begin(), targets.end(), [](const ScanTarget& a, const ScanTarget& b) {
+			if (a.mStart != b.mStart)
+				return std::less<>()(a.mStart, b.mStart);
+
+			return std::less<>()(a.mEnd, b.mEnd);
+			});
+
+		// Targets sharing a range make a group, reusable States get theirs compiled once
+
+		Vector<Pattern::Group, StateT::DESCRIPTIONS_CAPACITY> built;
+		Vector<Pattern::GroupCache::Entry*, StateT::DESCRIPTIONS_CAPACITY> held;
+		U64 compiled = 0;
+
+		{
+			TBS_TRACE_SCOPE("Compile", "scan");
+
+			for (size_t first = 0, last = 0; first < targets.size(); first = last)
+			{
+				while (last < targets.size() && targets[last].mStart == targets[first].mStart && targets[last].mEnd == targets[first].mEnd)
+					last++;
+
+				if (state.mbReusable)
+				{
+					held.push_back(AcquireGroup(state, targets.data() + first, targets.data() + last, compiled));
+					continue;
+				}
+
+				built.emplace_back(targets[first].mStart, targets[first].mEnd);
+
+				for (size_t i = first; i < last; i++)
+					built.back().Add(*targets[i].mDescription);
+
+				built.back().mMatcher.Compile();
+				compiled++;
+			}
+		}
+
+		// At this point, groups are stable in memory, lets slice them
+
+		Vector<Pattern::Group*, StateT::DESCRIPTIONS_CAPACITY> groups;
+
+		for (Pattern::Group& group : built)
+			groups.push_back(&group);
+
+		for (Pattern::GroupCache::Entry* entry : held)
+			groups.push_back(&entry->mGroup);
+
+		struct GroupSliceTask : Thread::TaskOf<GroupSliceTask> {
+			inline GroupSliceTask(Pattern::Group& group, const Pattern::Sink& sink, const Pattern::Description::SearchSlice& slice)
+				: mGroup(&group)
+				, mSink(&sink)
+				, mSlice(slice)
+			{}
+
+			inline void Run()
+			{
+#ifdef TBS_STATS
+				auto scope = mStats.Scope();
+#endif
+				TBS_TRACE_SCOPE(mGroup->mDescriptions.front()->mUID.c_str(), "group", mSlice.mStart, mSlice.mEnd, mGroup->mDescriptions.size());
+
+				Pattern::Scan(*mGroup, *mSink, mSlice.mStart, mSlice.mEnd, mMatches);
+			}
+
+			Pattern::Group* mGroup;
+			const Pattern::Sink* mSink;
+			Pattern::Description::SearchSlice mSlice;
+			Pattern::Matches mMatches;
+#ifdef TBS_STATS
+			TaskStats mStats;
+#endif
+		};
+
+		Vector<GroupSliceTask> tasks;
+
+		ForEachChunk(groups, [](const Pattern::Group* group) {
+			return Pattern::Description::SearchSlice::Container(group->mSearchStart, group->mSearchEnd, PATTERN_SEARCH_SLICE_SIZE);
+			}, [&tasks, &sink](Pattern::Group* group, const Pattern::Description::SearchSlice& slice) {
+				tasks.emplace_back(*group, sink, slice);
+			});
+
+		Thread::Run(tasks.data(), tasks.size());
+
+#ifdef TBS_STATS
+		{
+			typename StateT::StatsLock statsLock(state);
+
+			state.mStats.mGroupsCompiled += compiled;
+
+			for (const GroupSliceTask& task : tasks)
+			{
+				FoldTaskStats(state, task.mStats);
+
+				for (Pattern::Description* desc : task.mGroup->mDescriptions)
+				{
+					desc->mShared.mStats.mBytes += task.mSlice.mEnd - task.mSlice.mStart;
+					desc->mShared.mStats.mSlices++;
+				}
+
+				for (const Pattern::Match& match : task.mMatches)
+					match.mShared->mStats.mMatches++;
+			}
+		}
+#endif
+
+		ReleaseGroups(state, held.data(), held.size());
+		MergeMatches(tasks.data(), tasks.size());
+	}
+
+	/*
+		Every description range is partitioned into slice sized chunks,
+		all of them independent tasks, so a single huge range scales across all workers
+	*/
+	template<typename StateT>
+	static void ScanChunked(StateT& state, Vector<ScanTarget>& targets, const Pattern::Sink& sink)
+	{
+		(void)state;	// Only TBS_STATS folds into it
+
+		struct ChunkTask : Thread::TaskOf<ChunkTask> {
+			inline ChunkTask(const ScanTarget& target, const Pattern::Sink& sink, const Pattern::Description::SearchSlice& chunk)
+				: mDescription(target.mDescription)
+				, mSink(&sink)
+				, mSearchEnd(target.mEnd)
+				, mChunk(chunk)
+			{}
+
+			inline void Run()
+			{
+#ifdef TBS_STATS
+				auto scope = mStats.Scope();
+#endif
+				TBS_TRACE_SCOPE(mDescription->mUID.c_str(), "chunk", mChunk.mStart, mChunk.mEnd);
+
+				Pattern::Scan(*mDescription, *mSink, mChunk.mStart, mChunk.mEnd, mSearchEnd, mMatches);
+			}
+
+			Pattern::Description* mDescription;
+			const Pattern::Sink* mSink;
+			const UByte* mSearchEnd;
+			Pattern::Description::SearchSlice mChunk;
+			Pattern::Matches mMatches;
+#ifdef TBS_STATS
+			TaskStats mStats;
+#endif
+		};
+
+		Vector<ChunkTask> tasks;
+
+		ForEachChunk(targets, [](const ScanTarget& target) {
+			return Pattern::Description::SearchSlice::Container(target.mStart, target.mEnd, PATTERN_SEARCH_SLICE_SIZE);
+			}, [&tasks, &sink](const ScanTarget& target, const Pattern::Description::SearchSlice& chunk) {
+				tasks.emplace_back(target, sink, chunk);
+			});
+
+		Thread::Run(tasks.data(), tasks.size());
+
+#ifdef TBS_STATS
+		typename StateT::StatsLock statsLock(state);
+
+		for (const ChunkTask& task : tasks)
+		{
+			FoldTaskStats(state, task.mStats);
+
+			auto& descStats = task.mDescription->mShared.mStats;
+
+			static_cast<Stats::Counters&>(descStats) += task.mStats.mCounters;
+			descStats.mSlices++;
+		}
+#endif
+
+		MergeMatches(tasks.data(), tasks.size());
+	}
+
+	/*
+		Runs the steps & batch transformers of every UID over the results it got
+		since the last time, after the scan so the hot loops only collect addresses.
+		UIDs are independent, each one is a task
+	*/
+	template<typename StateT>
+	static void PostProcess(StateT& state, const Pattern::Sink& sink)
+	{
+		struct PostProcessTask : Thread::TaskOf<PostProcessTask> {
+			inline PostProcessTask(const String<>& uid, Pattern::SharedDescription& shared, Pattern::Outcome& outcome)
+				: mUID(&uid)
+				, mShared(&shared)
+				, mOutcome(&outcome)
+				, mNs(0)
+			{}
+
+			inline void Run()
+			{
+				TBS_TRACE_SCOPE(mUID->c_str(), "transform");
+
+#ifdef TBS_STATS
+				const U64 startNs = Stats::NowNs();
+#endif
+
+				Pattern::Results& results = mOutcome->mResult;
+				Pattern::Result* first = results.data() + mOutcome->mPostProcessed;
+				const size_t count = results.size() - mOutcome->mPostProcessed;
+
+				Pattern::ApplySteps(mShared->mSteps, first, count);
+
+				for (const auto& transformer : mShared->mBatchTransforms)
+					transformer(first, count);
+
+				mOutcome->mPostProcessed = results.size();
+
+#ifdef TBS_STATS
+				mNs = Stats::NowNs() - startNs;
+#endif
+			}
+
+			const String<>* mUID;
+			Pattern::SharedDescription* mShared;
+			Pattern::Outcome* mOutcome;
+			U64 mNs;
+		};
+
+		Vector<PostProcessTask> tasks;
+
+		for (auto& sharedDescKv : state.mSharedDescriptions)
+		{
+			Pattern::SharedDescription& shared = *sharedDescKv.second;
+			Pattern::Outcome& outcome = sink.Of(shared);
+
+			if (outcome.mPostProcessed == outcome.mResult.size())
+				continue;
+
+			if (shared.mSteps.empty() && shared.mBatchTransforms.empty())
+			{
+				outcome.mPostProcessed = outcome.mResult.size();
+				continue;
+			}
+
+			tasks.emplace_back(sharedDescKv.first, shared, outcome);
+		}
+
+		Thread::Run(tasks.data(), tasks.size());
+
+#ifdef TBS_STATS
+		typename StateT::StatsLock statsLock(state);
+
+		for (const PostProcessTask& task : tasks)
+		{
+			task.mShared->mStats.mTransformNs += task.mNs;
+			state.mStats.mTotal.mTransformNs += task.mNs;
+		}
+#endif
+	}
+
+	/*
+		Incremental counterpart of ScanChunked, see State::setIncremental().
+		A page hashing differently than in the previous scan is dirty, matches overlapping
+		it start up to the trimmed pattern size - 1 bytes before it, so only those windows
+		are searched again & the previous matches within them dropped. Targets not in the
+		previous scan (descriptions added since, other ranges) get searched whole.
+		Every match is kept, SCAN_FIRST included, so losing the first one never takes a
+		search, the lowest remaining is the result. Kept matches get their transformers
+		run again, those may read memory outside of the pages hashed. The snapshot is
+		the State's own, incremental scans of a State must not overlap
+	*/
+	template<typename StateT>
+	static void ScanIncremental(StateT& state, const Vector<ScanTarget>& targets, const Pattern::Sink& sink)
+	{
+		using Incremental::PAGE_SIZE;
+		using Slice = Pattern::Description::SearchSlice;
+
+		Incremental::Snapshot& snapshot = state.mSnapshot;
+
+		const auto byBounds = [](const Incremental::Range& range, const Slice& bounds) {
+			return range.mStart != bounds.mStart ? std::less<>()(range.mStart, bounds.mStart) : std::less<>()(range.mEnd, bounds.mEnd);
+			};
+
+		// Ranges searched this time, with their hashes from the previous scan if any
+
+		Vector<Slice> bounds;
+
+		for (const ScanTarget& target : targets)
+			bounds.emplace_back(target.mStart, target.mEnd);
+
+		std::sort(bounds.begin(), bounds.end(), [](const Slice& a, const Slice& b) {
+			return a.mStart != b.mStart ? std::less<>()(a.mStart, b.mStart) : std::less<>()(a.mEnd, b.mEnd);
+			});
+
+		Vector<Incremental::Range> ranges;
+
+		for (const Slice& bound : bounds)
+		{
+			if (!ranges.empty() && ranges.back().mStart == bound.mStart && ranges.back().mEnd == bound.mEnd)
+				continue;
+
+			auto previous = std::lower_bound(snapshot.mRanges.begin(), snapshot.mRanges.end(), bound, byBounds);
+
+			if (previous != snapshot.mRanges.end() && previous->mStart == bound.mStart && previous->mEnd == bound.mEnd)
+				ranges.emplace_back(std::move(*previous));
+			else
+				ranges.emplace_back(bound.mStart, bound.mEnd);
+		}
+
+		struct HashTask : Thread::TaskOf<HashTask> {
+			inline HashTask(Incremental::Range& range, size_t firstPage, size_t endPage, bool bFresh)
+				: mRange(&range)
+				, mFirstPage(firstPage)
+				, mEndPage(endPage)
+				, mbFresh(bFresh)
+			{}
+
+			inline void Run()
+			{
+				TBS_TRACE_SCOPE("Hash", "incremental", mRange->mStart + mFirstPage * PAGE_SIZE, mRange->mStart + std::min<U64>(mEndPage * PAGE_SIZE, mRange->mEnd - mRange->mStart));
 
-				inline Iterator begin() const {
-					return Iterator(mStart, mStep, mEnd);
-				}
+				for (size_t page = mFirstPage; page < mEndPage; page++)
+				{
+					const UByte* pageStart = mRange->mStart + page * PAGE_SIZE;
+					const U64 hash = Hash(pageStart, (size_t)std::min<U64>(PAGE_SIZE, mRange->mEnd - pageStart));
 
-				inline Iterator end() const {
-					return Iterator(mEnd, mStep, mEnd);
+					mRange->mDirty[page] = mbFresh || mRange->mHashes[page] != hash;
+					mRange->mHashes[page] = hash;
 				}
+			}
 
-				PtrTypeT mStart;
-				PtrTypeT mEnd;
-				U64 mStep;
-			};
+			Incremental::Range* mRange;
+			size_t mFirstPage;
+			size_t mEndPage;
+			bool mbFresh;
 		};
-	}
 
-	inline bool Compare(const UByte* chunk1, const UByte* chunk2, size_t len, const UByte* compareMask)
-	{
-		static auto RTCompare = [] {
-#ifdef TBS_USE_AVX
-			if (Memory::SIMD::AVX2::Supported())
-				return Memory::SIMD::AVX2::Compare;
+		Vector<HashTask> hashTasks;
+		constexpr size_t pagesPerTask = PATTERN_SEARCH_SLICE_SIZE / PAGE_SIZE;
 
-			if (Memory::SIMD::AVX::Supported())
-				return Memory::SIMD::AVX::Compare;
-#endif
+		for (Incremental::Range& range : ranges)
+		{
+			const size_t pageCount = range.PageCount();
+			const bool bFresh = range.mHashes.size() != pageCount;
 
-#ifdef TBS_USE_SSE2
-			if (Memory::SIMD::SSE2::Supported())
-				return Memory::SIMD::SSE2::Compare;
-#endif
+			range.mHashes.resize(pageCount);
+			range.mDirty.resize(pageCount);
 
-#ifdef TBS_USE_ARCH_WORD_SIMD
-			return Memory::SIMD::Platform::Compare;
-#else 
-			return Memory::Compare;
-#endif
-			}();
+			for (size_t page = 0; page < pageCount; page += pagesPerTask)
+				hashTasks.emplace_back(range, page, std::min(page + pagesPerTask, pageCount), bFresh);
+		}
 
-		return RTCompare(chunk1, chunk2, len, compareMask);
-	}
+		Thread::Run(hashTasks.data(), hashTasks.size());
 
-	inline const UByte* SearchFirst(const UByte* start, const UByte* end, UByte byte)
-	{
-		if (start >= end)
-			return nullptr;
+		// At this point, every range knows its dirty pages, lets coalesce them into runs
 
-		static auto RTSearchFirst = [] {
-#ifdef TBS_USE_AVX
-			if (Memory::SIMD::AVX2::Supported())
-				return Memory::SIMD::AVX2::SearchFirst;
+		Vector<Vector<Slice>> dirtyRuns(ranges.size());
 
-			if (Memory::SIMD::AVX::Supported())
-				return Memory::SIMD::AVX::SearchFirst;
-#endif
+		for (size_t r = 0; r < ranges.size(); r++)
+		{
+			const Incremental::Range& range = ranges[r];
 
-#ifdef TBS_USE_SSE2
-			if (Memory::SIMD::SSE2::Supported())
-				return Memory::SIMD::SSE2::SearchFirst;
-#endif
-			return Memory::SearchFirst;
-			}();
+			for (size_t page = 0; page < range.mDirty.size(); page++)
+			{
+				if (!range.mDirty[page])
+					continue;
 
-		return RTSearchFirst(start, end, byte);
-	}
+				const UByte* pageStart = range.mStart + page * PAGE_SIZE;
+				const UByte* pageEnd = pageStart + std::min<U64>(PAGE_SIZE, range.mEnd - pageStart);
 
-	namespace Pattern
-	{
-		using Result = TBS_RESULT_TYPE;
-		using Results = Vector<Result>;
+				if (!dirtyRuns[r].empty() && dirtyRuns[r].back().mEnd == pageStart)
+					dirtyRuns[r].back().mEnd = pageEnd;
+				else
+					dirtyRuns[r].emplace_back(pageStart, pageEnd);
+			}
 
-		struct ParseResult {
-			inline ParseResult()
-				: mParseSuccess(false)
-				, mTrimmDisp(0)
-			{}
+#ifdef TBS_STATS
+			typename StateT::StatsLock statsLock(state);
 
-			inline operator bool()
-			{
-				return mParseSuccess;
-			}
+			state.mStats.mPagesHashed += range.mDirty.size();
+			state.mStats.mPagesDirty += std::count(range.mDirty.begin(), range.mDirty.end(), UByte(1));
+#endif
+		}
 
-			Vector<UByte> mPattern;
-			Vector<UByte> mCompareMask;
-			size_t mTrimmDisp;
-			bool mParseSuccess;
+		struct RescanTask : Thread::TaskOf<RescanTask> {
+			inline RescanTask(size_t index, const ScanTarget& target, const UByte* start, const UByte* end)
+				: mIndex(index)
+				, mDescription(target.mDescription)
+				, mSearchEnd(target.mEnd)
+				, mStart(start)
+				, mEnd(end)
+			{}
 
-			inline UByte* getTrimmedPattern()
+			inline void Run()
 			{
-				return mPattern.data() + mTrimmDisp;
-			}
+#ifdef TBS_STATS
+				auto scope = mStats.Scope();
+#endif
+				TBS_TRACE_SCOPE(mDescription->mUID.c_str(), "rescan", mStart, mEnd);
 
-			inline UByte* getTrimmedCompareMask()
-			{
-				return mCompareMask.data() + mTrimmDisp;
-			}
+				const size_t reach = mDescription->mParsed.getTrimmedSize() > 0 ? mDescription->mParsed.getTrimmedSize() - 1 : 0;
+				const UByte* windowEnd = (size_t)(mSearchEnd - mEnd) > reach ? mEnd + reach : mSearchEnd;
 
-			inline size_t getTrimmedSize() const
-			{
-				return mPattern.size() - mTrimmDisp;
+				Pattern::Find(mDescription->mParsed, mStart, windowEnd, [this](const UByte* found) {
+					mHits.push_back(Incremental::Hit{ found, Pattern::Transform(*mDescription, found) });
+					return true;
+					});
 			}
 
-			inline bool TrimmedIsFirstTrullySolid()
-			{
-				return getTrimmedCompareMask()[0] != 0;
-			}
+			size_t mIndex;	// Into the targets
+			Pattern::Description* mDescription;
+			const UByte* mSearchEnd;
+			const UByte* mStart;
+			const UByte* mEnd;
+			Incremental::Hits mHits;
+#ifdef TBS_STATS
+			TaskStats mStats;
+#endif
 		};
 
-		static bool Parse(const void* _pattern, const char* mask, ParseResult& result)
-		{
-			result = ParseResult();
+		Vector<RescanTask> tasks;
+		Vector<Incremental::Key> keys;
+		Vector<Incremental::Hits> known(targets.size());
+		Vector<Slice> windows;
 
-			if (_pattern == nullptr || mask == nullptr)
-				return false;
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			const ScanTarget& target = targets[i];
+			Pattern::Description& description = *target.mDescription;
+			const Slice bound(target.mStart, target.mEnd);
 
-			size_t patternLen = StringLength(mask);
+			const size_t r = std::lower_bound(ranges.begin(), ranges.end(), bound, byBounds) - ranges.begin();
+			const size_t reach = description.mParsed.getTrimmedSize() > 0 ? description.mParsed.getTrimmedSize() - 1 : 0;
 
-			result.mPattern.resize(patternLen);
-			result.mCompareMask.resize(patternLen);
+			keys.push_back(target.Key());
 
-			memcpy(result.mPattern.data(), _pattern, patternLen);
-			memset(result.mCompareMask.data(), 0xFF, patternLen);
+			auto previous = std::lower_bound(snapshot.mTargets.begin(), snapshot.mTargets.end(), keys.back());
+			const bool bKnown = previous != snapshot.mTargets.end() && *previous == keys.back();
 
-			bool bFirstSolidFound = false;
+			windows.clear();
 
-			for (size_t i = 0; i < patternLen; i++)
+			if (!bKnown)
+				windows.push_back(bound);
+			else for (const Slice& run : dirtyRuns[r])
 			{
-				if (mask[i] == '?')
-				{
-					result.mPattern[i] = 0x00;
-					result.mCompareMask[i] = 0x00;
+				const UByte* windowStart = (size_t)(run.mStart - bound.mStart) > reach ? run.mStart - reach : bound.mStart;
 
-					continue;
-				}
+				if (!windows.empty() && windowStart <= windows.back().mEnd)
+					windows.back().mEnd = run.mEnd;
+				else
+					windows.emplace_back(windowStart, run.mEnd);
+			}
 
-				if (!bFirstSolidFound)
+			// Previous matches outside of every window still hold, what their
+			// transformers dereference may have changed elsewhere though
+
+			if (bKnown)
+			{
+				size_t w = 0;
+
+				for (const Incremental::Hit& hit : snapshot.mKnown[previous - snapshot.mTargets.begin()])
 				{
-					result.mTrimmDisp = i;
-					bFirstSolidFound = true;
+					while (w < windows.size() && windows[w].mEnd <= hit.mAt)
+						w++;
+
+					if (w == windows.size() || hit.mAt < windows[w].mStart)
+						known[i].push_back(description.mTransforms.empty() ? hit : Incremental::Hit{ hit.mAt, Pattern::Transform(description, hit.mAt) });
 				}
 			}
 
-			return result.mParseSuccess = true;
+			for (const Slice& window : windows)
+			{
+				for (const Slice& chunk : Slice::Container(window.mStart, window.mEnd, PATTERN_SEARCH_SLICE_SIZE))
+					tasks.emplace_back(i, target, chunk.mStart, chunk.mEnd);
+			}
 		}
 
-		static bool Parse(const String<>& pattern, ParseResult& result)
+		Thread::Run(tasks.data(), tasks.size());
+
+		// At this point, kept matches are sorted & tasks of a target come
+		// in ascending address order, merging both keeps them sorted
+
+		Vector<size_t> keptCount(targets.size());
+
+		for (size_t i = 0; i < targets.size(); i++)
+			keptCount[i] = known[i].size();
+
+#ifdef TBS_STATS
+		typename StateT::StatsLock statsLock(state);
+#endif
+
+		for (RescanTask& task : tasks)
 		{
-			result = ParseResult();
+			known[task.mIndex].insert(known[task.mIndex].end(), task.mHits.begin(), task.mHits.end());
 
-			if (pattern.empty())
-				return true;
+#ifdef TBS_STATS
+			FoldTaskStats(state, task.mStats);
 
-			const char* c = pattern.c_str();
-			bool bFirstSolidFound = false;
+			auto& descStats = task.mDescription->mShared.mStats;
 
-			for (int i = 0; *c; i++)
-			{
-				String<> str;
+			static_cast<Stats::Counters&>(descStats) += task.mStats.mCounters;
+			descStats.mSlices++;
+#endif
+		}
 
-				for (; *c && *c == ' '; c++)
-					;
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			std::inplace_merge(known[i].begin(), known[i].begin() + keptCount[i], known[i].end(), [](const Incremental::Hit& a, const Incremental::Hit& b) {
+				return std::less<>()(a.mAt, b.mAt);
+				});
+		}
 
-				for (; *c && *c != ' '; c++)
-					str.push_back(*c);
+		// Results are rebuilt from scratch, steps & batch transformers run over all of them again
 
-				if (str.size() > 2)
-					return false;
+		for (const ScanTarget& target : targets)
+			sink.Of(target.mDescription->mShared).Reset();
 
-				// At this point, current pattern byte structure good so far
+		Pattern::Matches matches;
 
-				bool bAnyWildCard = str.find("?") != String<>::npos;
-				bool bFullByteWildcard = str.find("??") != String<>::npos || (bAnyWildCard && str.size() == 1);
+		for (size_t i = 0; i < targets.size(); i++)
+		{
+			Pattern::Description& description = *targets[i].mDescription;
+			Pattern::Outcome& outcome = sink.Of(description.mShared);
 
-				if (!bFirstSolidFound && !bFullByteWildcard)
-				{
-					result.mTrimmDisp = i;
-					bFirstSolidFound = true;
-				}
+			for (const Incremental::Hit& hit : known[i])
+				matches.push_back(Pattern::Match{ &description.mShared, &outcome, (Pattern::Result)(hit.mAt - description.mParsed.mTrimmDisp), hit.mValue });
+		}
+
+		{
+			TBS_TRACE_SCOPE("Merge", "scan");
+			Pattern::Merge(matches);
+		}
 
-				// At this point, current Byte is wildcarded
+		// MakeTargets() goes by description & address, keys come sorted
 
-				if (bFullByteWildcard)
-				{
-					// At this point we are dealing with Full Byte Wildcard Case
-					result.mPattern.emplace_back(UByte(0x00u));
-					result.mCompareMask.emplace_back(UByte(0x00u));
-					continue;
-				}
+		snapshot.mRanges.swap(ranges);
+		snapshot.mTargets.swap(keys);
+		snapshot.mKnown.swap(known);
+	}
 
-				if (!bAnyWildCard)
-				{
-					// Not Wilcarding this byte
-					result.mPattern.emplace_back(Memory::ByteFromString(str.c_str()));
-					result.mCompareMask.emplace_back(UByte(0xFFull));
-					continue;
-				}
+	/*
+		One scan of the descriptions of `state` over `range`, or their own ranges
+		when null, results going to `sink`. Only the State stats get written
+	*/
+	template<typename StateT>
+	static bool ScanPass(StateT& state, const Pattern::Sink& sink, const Pattern::Description::SearchSlice* range)
+	{
+#ifdef TBS_STATS
+		const U64 scanStartNs = Stats::NowNs();
+#endif
 
-				// At this point we are dealing with Half Byte Wildcard Case, "X?" or "?X"
+		{
+			TBS_TRACE_SCOPE("Scan", "scan");
 
-				if (str[0] == '?')
-				{
-					// At this point, we are dealing with High Part of Byte wildcarding "?X"
-					str[0] = '0';
-					result.mPattern.emplace_back(Memory::ByteFromString(str.c_str()));
-					result.mCompareMask.emplace_back(UByte(0x0Fu));
-					continue;
-				}
+			Vector<ScanTarget> targets;
 
-				// At this point, we are dealing with Low Part of Byte wildcarding "X?"
-				str[1] = '0';
-				result.mPattern.emplace_back(Memory::ByteFromString(str.c_str()));
-				result.mCompareMask.emplace_back(UByte(0xF0u));
+			{
+				TBS_TRACE_SCOPE(state.mbSafeScan ? "SplitReadable" : "Targets", "scan");
+				MakeTargets(state, range, targets);
 			}
 
-			return result.mParseSuccess = true;
+			if (state.mbIncremental)
+				ScanIncremental(state, targets, sink);
+			else if (state.mMultiPattern)
+				ScanGrouped(state, targets, sink);
+			else
+				ScanChunked(state, targets, sink);
+
+			PostProcess(state, sink);
 		}
 
-		static bool Valid(const String<>& pattern)
+#ifdef TBS_TRACE
+		Trace::Flush();
+#endif
+
+#ifdef TBS_STATS
 		{
-			ParseResult res;
+			typename StateT::StatsLock statsLock(state);
 
-			return Parse(pattern, res) && res;
+			state.mStats.mScans++;
+			state.mStats.mScanNs += Stats::NowNs() - scanStartNs;
 		}
+#endif
 
-		static bool Valid(const void* _pattern, const char* mask)
-		{
-			ParseResult res;
+		bool bAllFoundAny = true;
 
-			return Parse(_pattern, mask, res) && res;
+		for (auto& sharedDescKv : state.mSharedDescriptions)
+			bAllFoundAny = bAllFoundAny && sink.Of(*sharedDescKv.second).mResult.empty() == false;
+
+		return bAllFoundAny;
+	}
+
+	/*
+		Results accumulate in the State, descriptions are dropped
+		afterwards unless it is reusable or incremental
+	*/
+	template<typename StateT>
+	static bool Scan(StateT& state)
+	{
+		const bool bAllFoundAny = ScanPass(state, Pattern::Sink(), nullptr);
+
+		if (!state.mbReusable && !state.mbIncremental)
+		{
+			state.mDescriptionts.clear();
+			state.mGroupCache.Clear();
 		}
 
-		enum class EScan {
-			SCAN_ALL,
-			SCAN_FIRST
-		};
+		return bAllFoundAny;
+	}
 
-		struct Description {
-			using ResultTransformer = Function<Result(Description&, Result)>;
-			using SearchSlice = Memory::Slice<const UByte*>;
+	/*
+		Scans a reusable State into `results` instead, the State itself is only read
+		(stats aside), so scans into different ScanResults may run at once from several
+		threads as long as no pattern gets added meanwhile. Incremental States excepted
+	*/
+	template<typename StateT>
+	static bool Scan(StateT& state, typename StateT::ScanResults& results)
+	{
+		return ScanPass(state, results.GetSink(), nullptr);
+	}
 
-			struct Shared {
-				struct ResultAccesor {
-					inline ResultAccesor(Shared& sharedDesc)
-						: mSharedDesc(sharedDesc)
-					{}
+	/*
+		Same, every description searching [start, end) instead of its own range
+	*/
+	template<typename StateT, typename T, typename K>
+	static bool Scan(StateT& state, typename StateT::ScanResults& results, T start, K end)
+	{
+		const Pattern::Description::SearchSlice range((const UByte*)start, (const UByte*)end);
 
-					inline operator const Results& () const {
-						return ResultsGet();
-					}
+		return ScanPass(state, results.GetSink(), &range);
+	}
 
-					inline operator Result () const {
-						if (mSharedDesc.mResult.size() < 1)
-							return 0;
+	template<typename K, U64 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE, U64 DESCS_CAPACITY = SHAREDDESCS_CAPACITY * 2>
+	static bool ScanOne(K start, K end, const String<>& pattern, Pattern::Result& outResult)
+	{
+		outResult = Pattern::Result{};
 
-						return mSharedDesc.mResult[0];
-					}
+		State<SHAREDDESCS_CAPACITY, DESCS_CAPACITY> state(start, end);
 
-					inline const Results& ResultsGet() const
-					{
-						return mSharedDesc.mResult;
-					}
+		state.AddPattern(
+			state.PatternBuilder()
+			.setPattern(pattern)
+			.stopOnFirstMatch()
+			.Build()
+		);
 
-					Shared& mSharedDesc;
-				};
+		if (!Scan(state))
+			return false;
 
-				inline Shared(EScan scanType)
-					: mScanType(scanType)
-					, mResultAccesor(*this)
-					, mFinished(false)
-				{}
+		outResult = state[pattern];
 
-#ifdef TBS_MT
-				std::mutex mMutex;
-				std::atomic<bool> mFinished;
-#else
-				bool mFinished;
-#endif
-				EScan mScanType;
-				Results mResult;
-				ResultAccesor mResultAccesor;
+		return true;
+	}
+
+	/*
+		Precompiled signature database, what parsing & planning produce for a whole
+		signature set stored flat (tbs-compile), usable in place once mapped.
+		Little endian, offsets are relative to the file start & every section is
+		ALIGNMENT aligned, so the file maps anywhere & processes share its pages.
+
+		Header | Entry[mEntryCount] sorted by UID | UIDs | padded patterns & masks,
+		verify orders, skip tables | Matcher | its entry lists, key filter & slots
+	*/
+	namespace Database {
+		constexpr U32 MAGIC = 0x42445354; // "TSDB"
+		constexpr U32 VERSION = 2;
+
+		/*
+			Patterns & masks are zero padded to it, enough for every ComparePadded kernel
+		*/
+		constexpr size_t ALIGNMENT = 32;
+
+		static_assert(ALIGNMENT % PATTERN_PADDING == 0, "Database padding must suit every kernel");
+
+		constexpr size_t NOT_FOUND = ~size_t(0);
+
+		struct Header {
+			U32 mMagic;
+			U32 mVersion;
+			U64 mFileSize;
+			U32 mEntryCount;
+			U32 mEntriesOffset;
+			U32 mMatcherOffset;
+			U32 mReserved;
+		};
+
+		struct Entry {
+			U32 mUIDOffset;
+			U32 mUIDSize;
+			U32 mPatternOffset;		// Trimmed pattern, zero padded up to mPaddedSize
+			U32 mMaskOffset;
+			U32 mSize;				// Trimmed size
+			U32 mPaddedSize;
+			U32 mTrimmDisp;
+			U32 mAnchor;
+			U32 mAnchor2;
+			U32 mVerifyOrderOffset;
+			U32 mVerifyOrderCount;
+			U32 mSkipShiftOffset;	// 256 shifts, only when mSkip
+			U32 mSkipStart;
+			U32 mSkipLen;
+			UByte mSolidAnchor;
+			UByte mSkip;
+			UByte mReserved[2];
+		};
+
+		/*
+			Pattern::MultiMatcher tables compiled over every entry, scanned in place.
+			Lists refer to entries by index, offsets are into the image
+		*/
+		struct Matcher {
+			using Tables = Pattern::MultiMatcher::Tables;
+
+			static constexpr size_t BUCKETS = Pattern::MultiMatcher::BUCKETS;
+			static constexpr size_t FINGERPRINT_MAX_LEN = Pattern::MultiMatcher::FINGERPRINT_MAX_LEN;
+			static constexpr size_t KEY_BITS_SIZE = (size_t(1) << Pattern::MultiMatcher::KEY_FILTER_BITS) / 8;
+
+			UByte mLo[FINGERPRINT_MAX_LEN][16];
+			UByte mHi[FINGERPRINT_MAX_LEN][16];
+			U32 mFingerprintLen;
+			U32 mBucketStarts[BUCKETS + 1];
+			U32 mBucketEntriesOffset;
+			U32 mKeyBitsOffset;			// KEY_BITS_SIZE bytes, only when mKeySlotCount
+			U32 mKeySlotsOffset;
+			U32 mKeySlotCount;			// Hashed slots + 1, 0 when nothing is keyed
+			U32 mKeyEntriesOffset;
+			U32 mKeyEntryCount;
+			U32 mKeyShift;
+			U32 mSoloOffset;
+			U32 mSoloCount;
+			U32 mReserved;
+		};
+
+		/*
+			Plan of an entry read in place, what Pattern::Find needs of it
+		*/
+		struct EntryPlan {
+			struct Order {
+				inline size_t size() const
+				{
+					return mCount;
+				}
+
+				inline U32 operator[](size_t i) const
+				{
+					return mOffsets[i];
+				}
+
+				const U32* mOffsets;
+				size_t mCount;
 			};
 
-			inline Description(Shared& shared, const String<>& uid, const UByte* searchStart, const UByte* searchEnd,
-				const Vector<ResultTransformer>& transformers, const String<>& pattern)
-				: Description(shared, uid, searchStart, searchEnd, transformers)
+			inline bool HasSecondAnchor() const
+			{
+				return mSolidAnchor && mAnchor2 != mAnchor;
+			}
+
+			inline bool UseSkip() const
+			{
+				return mSkip;
+			}
+
+			size_t mAnchor;
+			size_t mAnchor2;
+			bool mSolidAnchor;
+			Order mVerifyOrder;
+			bool mSkip;
+			size_t mSkipStart;
+			size_t mSkipLen;
+			const UByte* mSkipShift;
+		};
+
+		/*
+			Collects parsed signatures & lays them out as a database image
+		*/
+		struct Writer {
+			/*
+				False when `pattern` doesnt parse, UIDs may repeat
+			*/
+			inline bool Add(const String<>& uid, StringView pattern)
+			{
+				Pattern::ParseResult parsed;
+
+				if (!Pattern::Parse(pattern, parsed) || !parsed)
+					return false;
+
+				return Add(uid, std::move(parsed));
+			}
+
+			inline bool Add(const String<>& uid, const void* pattern, const char* mask)
 			{
-				Parse(pattern, mParsed);
+				Pattern::ParseResult parsed;
+
+				if (!Pattern::Parse(pattern, mask, parsed) || !parsed)
+					return false;
+
+				return Add(uid, std::move(parsed));
 			}
 
-			inline Description(
-				Shared& shared, const String<>& uid,
-				const UByte* searchStart, const UByte* searchEnd,
-				const Vector<ResultTransformer>& transformers, const void* _pattern, const char* mask)
-				: Description(shared, uid, searchStart, searchEnd, transformers)
+			inline bool Add(const String<>& uid, Pattern::ParseResult&& parsed)
 			{
-				Parse(_pattern, mask, mParsed);
+				// Empty patterns never match, nothing to index them by
+
+				if (!parsed || parsed.getTrimmedSize() == 0)
+					return false;
+
+				mItems.push_back(Item{ uid, std::move(parsed) });
+				return true;
 			}
 
-			inline operator bool()
+			inline size_t size() const
 			{
-				return mParsed;
+				return mItems.size();
 			}
 
-			Shared& mShared;
-			String<> mUID;
-			Vector<ResultTransformer> mTransforms;
-			SearchSlice::Container mSearchRangeSlicer;
-			SearchSlice::Container::Iterator mCurrentSearchRange;
-			const UByte* mLastSearchPos;
-			ParseResult mParsed;
+			inline void Serialize(Vector<UByte>& image) const
+			{
+				Vector<const Item*> items;
 
-		private:
+				for (const Item& item : mItems)
+					items.push_back(&item);
 
-			inline Description(Shared& shared, const String<>& uid, const UByte* searchStart, const UByte* searchEnd,
-				const Vector<ResultTransformer>& transformers)
-				: mShared(shared)
-				, mUID(uid)
-				, mTransforms(transformers)
-				, mSearchRangeSlicer(searchStart, searchEnd, PATTERN_SEARCH_SLICE_SIZE)
-				, mCurrentSearchRange(mSearchRangeSlicer.begin())
-				, mLastSearchPos(searchStart)
-			{ }
-		};
+				std::stable_sort(items.begin(), items.end(), [](const Item* a, const Item* b) {
+					return a->mUID < b->mUID;
+					});
 
-		using ResultTransformer = Description::ResultTransformer;
+				image.clear();
 
-		static bool Scan(Description& desc)
-		{
-			auto& shared = desc.mShared;
-			auto& parsed = desc.mParsed;
+				const auto align = [&image](size_t alignment) {
+					image.resize((image.size() + alignment - 1) / alignment * alignment, 0);
+					};
 
-			if (shared.mFinished ||
-				(desc.mCurrentSearchRange == desc.mSearchRangeSlicer.end()))
-				return false;
+				const auto append = [&image](const void* data, size_t size) {
+					const U32 offset = (U32)image.size();
+					image.insert(image.end(), (const UByte*)data, (const UByte*)data + size);
+					return offset;
+					};
 
-			const size_t patternLen = parsed.mPattern.size();
+				image.resize(sizeof(Header), 0);
+				align(ALIGNMENT);
 
-			Description::SearchSlice currSearchnigRange = (*desc.mCurrentSearchRange);
+				const U32 entriesOffset = (U32)image.size();
+				Vector<Entry> entries(items.size());
 
-			const auto patternSize = parsed.getTrimmedSize();
+				image.resize(image.size() + sizeof(Entry) * entries.size(), 0);
+
+				for (size_t i = 0; i < items.size(); i++)
+				{
+					const Pattern::ParseResult& parsed = items[i]->mParsed;
+					const Pattern::Plan& plan = parsed.mPlan;
+					Entry& entry = entries[i];
 
-			const UByte* found = desc.mLastSearchPos - 1; // Minus one to bootstrap it with the next()
+					memset(&entry, 0, sizeof(entry));
 
-			auto next = [&found, &currSearchnigRange, &parsed] {
-				if (!parsed.TrimmedIsFirstTrullySolid()) // If solid is not solid, lets simply return [found + 1]
+					entry.mUIDSize = (U32)items[i]->mUID.size();
+					entry.mUIDOffset = append(items[i]->mUID.data(), entry.mUIDSize);
+
+					entry.mSize = (U32)parsed.getTrimmedSize();
+					entry.mPaddedSize = (U32)((entry.mSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+					entry.mTrimmDisp = (U32)parsed.mTrimmDisp;
+
+					align(ALIGNMENT);
+					entry.mPatternOffset = append(parsed.getTrimmedPattern(), entry.mSize);
+					image.resize(entry.mPatternOffset + entry.mPaddedSize, 0);
+					entry.mMaskOffset = append(parsed.getTrimmedCompareMask(), entry.mSize);
+					image.resize(entry.mMaskOffset + entry.mPaddedSize, 0);
+
+					entry.mAnchor = (U32)plan.mAnchor;
+					entry.mAnchor2 = (U32)plan.mAnchor2;
+					entry.mSolidAnchor = plan.mSolidAnchor;
+					entry.mVerifyOrderCount = (U32)plan.mVerifyOrder.size();
+					entry.mVerifyOrderOffset = append(plan.mVerifyOrder.data(), plan.mVerifyOrder.size() * sizeof(U32));
+
+					entry.mSkip = plan.mSkip;
+					entry.mSkipStart = (U32)plan.mSkipStart;
+					entry.mSkipLen = (U32)plan.mSkipLen;
+
+					if (plan.mSkip)
+						entry.mSkipShiftOffset = append(plan.mSkipShift, sizeof(plan.mSkipShift));
+				}
+
+				// At this point, every entry is laid out, lets compile the matcher over them
+
+				Pattern::MultiMatcher multiMatcher;
+
+				for (const Item* item : items)
+					multiMatcher.Add(item->mParsed);
+
+				multiMatcher.Compile();
+
+				Matcher matcher;
+				memset(&matcher, 0, sizeof(matcher));
+
+				memcpy(matcher.mLo, multiMatcher.mLo, sizeof(matcher.mLo));
+				memcpy(matcher.mHi, multiMatcher.mHi, sizeof(matcher.mHi));
+				matcher.mFingerprintLen = (U32)multiMatcher.mFingerprintLen;
+				memcpy(matcher.mBucketStarts, multiMatcher.mBucketStarts.data(), sizeof(matcher.mBucketStarts));
+
+				align(ALIGNMENT);
+				matcher.mBucketEntriesOffset = append(multiMatcher.mBucketPatterns.data(), multiMatcher.mBucketPatterns.size() * sizeof(U32));
+
+				if (!multiMatcher.mKeyPatterns.empty())
 				{
-					found++;
-					return;
+					align(ALIGNMENT);
+					matcher.mKeyBitsOffset = append(multiMatcher.mKeyBits.data(), Matcher::KEY_BITS_SIZE);
+					matcher.mKeySlotsOffset = append(multiMatcher.mKeySlots.data(), multiMatcher.mKeySlots.size() * sizeof(U32));
+					matcher.mKeySlotCount = (U32)multiMatcher.mKeySlots.size();
+					matcher.mKeyEntriesOffset = append(multiMatcher.mKeyPatterns.data(), multiMatcher.mKeyPatterns.size() * sizeof(U32));
+					matcher.mKeyEntryCount = (U32)multiMatcher.mKeyPatterns.size();
+					matcher.mKeyShift = multiMatcher.mKeyShift;
 				}
 
-				found = SearchFirst(found + 1, currSearchnigRange.mEnd, parsed.getTrimmedPattern()[0]);
-				};
+				matcher.mSoloOffset = append(multiMatcher.mSolo.data(), multiMatcher.mSolo.size() * sizeof(U32));
+				matcher.mSoloCount = (U32)multiMatcher.mSolo.size();
 
-			for (next(); found && found + patternSize - 1 < currSearchnigRange.mEnd; next())
+				align(ALIGNMENT);
+
+				Header header;
+				memset(&header, 0, sizeof(header));
+
+				header.mMatcherOffset = append(&matcher, sizeof(matcher));
+
+				header.mMagic = MAGIC;
+				header.mVersion = VERSION;
+				header.mFileSize = image.size();
+				header.mEntryCount = (U32)entries.size();
+				header.mEntriesOffset = entriesOffset;
+
+				memcpy(image.data(), &header, sizeof(header));
+				memcpy(image.data() + entriesOffset, entries.data(), entries.size() * sizeof(Entry));
+			}
+
+			inline bool Write(const String<>& path) const
 			{
-				if (shared.mFinished)
+				Vector<UByte> image;
+				Serialize(image);
+
+				FILE* file = fopen(path.c_str(), "wb");
+
+				if (file == nullptr)
 					return false;
 
-				if (Compare(found, parsed.getTrimmedPattern(), patternSize,
-					parsed.getTrimmedCompareMask()
-				) == false)
-					continue;
+				const bool bWritten = fwrite(image.data(), 1, image.size(), file) == image.size();
 
-				Result currMatch = (Result)(found - parsed.mTrimmDisp);
+				return fclose(file) == 0 && bWritten;
+			}
 
-				// At this point, we found a match
+		private:
+			struct Item {
+				String<> mUID;
+				Pattern::ParseResult mParsed;
+			};
 
-				for (const auto& transform : desc.mTransforms)
-					currMatch = transform(desc, currMatch);
+			Vector<Item> mItems;
+		};
 
-				// At this point, match is properly user transformed
-				// lets report it
-				{
-#ifdef TBS_MT
-					std::lock_guard<std::mutex> resultReportLck(shared.mMutex);
-#endif
+		/*
+			Read only view of a database image, mapped from a file or over memory
+			the caller keeps alive. Nothing gets parsed, Open() only validates offsets
+		*/
+		struct Reader {
+			inline Reader()
+				: mData(nullptr)
+				, mSize(0)
+				, mbMapped(false)
+			{}
 
-					if (shared.mFinished)
-						break;
+			inline ~Reader()
+			{
+				Close();
+			}
+
+			Reader(const Reader&) = delete;
+			Reader& operator=(const Reader&) = delete;
 
-					// At this point, we have the lock & we havent finished!
-					// Lets directly push it
+			/*
+				Mapped shared & read only where possible, read into memory otherwise
+			*/
+			inline bool Open(const String<>& path)
+			{
+				Close();
 
-					shared.mResult.push_back(currMatch);
+#if defined(__linux__)
+				const int fd = open(path.c_str(), O_RDONLY);
 
-					if (shared.mScanType != EScan::SCAN_FIRST)
-						continue;
+				if (fd < 0)
+					return false;
+
+				struct stat st;
+				void* mapped = MAP_FAILED;
+
+				if (fstat(fd, &st) == 0 && st.st_size > 0)
+					mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+				close(fd);
 
-					// At this point seems we are searching for a single result
-					// lets report finished state for the shared state & break 
-					// current search.
+				if (mapped == MAP_FAILED)
+					return false;
 
-					shared.mFinished = true;
+				if (!Attach(mapped, (size_t)st.st_size))
+				{
+					munmap(mapped, (size_t)st.st_size);
 					return false;
 				}
-			}
 
-			desc.mLastSearchPos = currSearchnigRange.mEnd - patternSize;
-			++desc.mCurrentSearchRange;
-			return !(desc.mCurrentSearchRange == desc.mSearchRangeSlicer.end());
-		}
+				mbMapped = true;
+				return true;
+#else
+				FILE* file = fopen(path.c_str(), "rb");
 
-		using SharedDescription = Description::Shared;
-		using SharedResultAccesor = SharedDescription::ResultAccesor;
-	}
+				if (file == nullptr)
+					return false;
 
-	namespace Pattern {
-		template<U32 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE>
-		struct DescriptionBuilder {
+				Vector<PaddedBlock> owned;
+				PaddedBlock block;
 
-			inline DescriptionBuilder(UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY>& sharedDescriptions)
-				: mSharedDescriptions(sharedDescriptions)
-				, mScanStart(0)
-				, mScanEnd(0)
-				, mScanType(EScan::SCAN_ALL)
-				, mRawPattern(0)
-				, mRawMask(0)
-			{}
+				for (size_t read; (read = fread(&block, 1, sizeof(block), file)) > 0; )
+					owned.push_back(block);
 
-			inline DescriptionBuilder& setPattern(const String<>& pattern)
-			{
-				mPattern = pattern;
+				fclose(file);
 
-				if (!mUID.empty())
-					return *this;
+				mOwned.swap(owned);
 
-				return setUID(pattern);
+				// At this point, the image is in aligned memory we own
+
+				if (!Attach(mOwned.data(), mOwned.size() * sizeof(PaddedBlock)))
+				{
+					Close();
+					return false;
+				}
+
+				return true;
+#endif
 			}
 
-			inline DescriptionBuilder& setPatternRaw(const void* pattern)
+			/*
+				`data` must be ALIGNMENT aligned & outlive the Reader
+			*/
+			inline bool Open(const void* data, size_t size)
 			{
-				mRawPattern = pattern;
+				Close();
 
-				if (!mUID.empty())
-					return *this;
+				return Attach(data, size);
+			}
 
-#ifdef TBS_USE_ETL
-				TBS::String<> uid;
-				uid = etl::to_string((UPtr)pattern, uid);
-				return setUID(uid);
-#else
-				return setUID(std::to_string((UPtr)pattern));
+			inline void Close()
+			{
+#if defined(__linux__)
+				if (mbMapped && mData)
+					munmap((void*)mData, mSize);
 #endif
+
+				mData = nullptr;
+				mSize = 0;
+				mbMapped = false;
+				mOwned.clear();
 			}
 
-			inline DescriptionBuilder& setMask(const char* mask)
+			inline operator bool() const
 			{
-				mRawMask = mask;
-				return *this;
+				return mData != nullptr;
 			}
 
-			inline DescriptionBuilder& setUID(const String<>& uid)
+			/*
+				Entry count
+			*/
+			inline size_t size() const
 			{
-				mUID = uid;
-				return *this;
+				return mData ? GetHeader().mEntryCount : 0;
 			}
 
-			template<typename T>
-			inline DescriptionBuilder& setScanStart(T start)
+			inline StringView UID(size_t i) const
 			{
-				mScanStart = (const UByte*)start;
-				return *this;
+				const Entry& entry = GetEntry(i);
+
+				return StringView((const char*)mData + entry.mUIDOffset, entry.mUIDSize);
 			}
 
-			template<typename T>
-			inline DescriptionBuilder& setScanEnd(T end, bool bOffsetFromStart = false)
+			/*
+				First entry of `uid`, those sharing it follow, NOT_FOUND when none
+			*/
+			inline size_t Find(StringView uid) const
 			{
-				mScanEnd = (const UByte*)end;
+				size_t lo = 0;
+				size_t hi = size();
 
-				if (bOffsetFromStart)
-					mScanEnd += (UPtr)mScanStart;
+				while (lo < hi)
+				{
+					const size_t mid = lo + (hi - lo) / 2;
 
-				return *this;
+					if (UID(mid) < uid)
+						lo = mid + 1;
+					else
+						hi = mid;
+				}
+
+				return lo < size() && UID(lo) == uid ? lo : NOT_FOUND;
 			}
 
-			inline DescriptionBuilder& AddTransformer(const Description::ResultTransformer& transformer)
+			/*
+				Copy of entry `i` as parsed & planned when compiled
+			*/
+			inline Pattern::ParseResult ToParseResult(size_t i) const
 			{
-				mTransformers.emplace_back(transformer);
-				return *this;
+				const Entry& entry = GetEntry(i);
+				Pattern::ParseResult parsed;
+
+				parsed.mPattern.assign(entry.mTrimmDisp + entry.mSize, 0);
+				parsed.mCompareMask.assign(entry.mTrimmDisp + entry.mSize, 0);
+				memcpy(parsed.mPattern.data() + entry.mTrimmDisp, mData + entry.mPatternOffset, entry.mSize);
+				memcpy(parsed.mCompareMask.data() + entry.mTrimmDisp, mData + entry.mMaskOffset, entry.mSize);
+
+				parsed.mTrimmDisp = entry.mTrimmDisp;
+				parsed.Pad();
+
+				Pattern::Plan& plan = parsed.mPlan;
+				const U32* verifyOrder = (const U32*)(mData + entry.mVerifyOrderOffset);
+
+				plan.mAnchor = entry.mAnchor;
+				plan.mAnchor2 = entry.mAnchor2;
+				plan.mSolidAnchor = entry.mSolidAnchor != 0;
+				plan.mVerifyOrder.assign(verifyOrder, verifyOrder + entry.mVerifyOrderCount);
+				plan.mSkip = entry.mSkip != 0;
+				plan.mSkipStart = entry.mSkipStart;
+				plan.mSkipLen = entry.mSkipLen;
+
+				if (plan.mSkip)
+					memcpy(plan.mSkipShift, mData + entry.mSkipShiftOffset, sizeof(plan.mSkipShift));
+
+				parsed.mParseSuccess = true;
+
+				return parsed;
 			}
 
-			inline DescriptionBuilder& setScanType(EScan type)
+			/*
+				Every entry into `state` over its default range, without parsing or planning,
+				for what Scan() below doesnt offer (transformers, threads, first match only)
+			*/
+			template<typename StateT>
+			inline StateT& AddTo(StateT& state) const
 			{
-				mScanType = type;
-				return *this;
+				for (size_t i = 0; i < size(); i++)
+				{
+					const StringView uid = UID(i);
+					state.AddPattern(String<>(uid.data(), uid.size()), ToParseResult(i));
+				}
+
+				return state;
 			}
 
-			inline DescriptionBuilder& stopOnFirstMatch()
+			/*
+				Reports through `onMatch(entryIndex, result)` every entry whose trimmed start
+				is in [start, end) & fully fits before `limit`, in no particular order.
+				Swept by the MultiMatcher tables compiled into the image, read in place.
+				`onMatch` returning false aborts the sweep.
+			*/
+			template<typename OnMatchT>
+			inline bool Scan(const UByte* start, const UByte* end, const UByte* limit, OnMatchT&& onMatch) const
 			{
-				return setScanType(EScan::SCAN_FIRST);
+				if (!mData)
+					return true;
+
+				const Entry* entries = (const Entry*)(mData + GetHeader().mEntriesOffset);
+
+				const auto verify = [this, entries, limit, &onMatch](U32 i, const UByte* found) {
+					const Entry& entry = entries[i];
+					const size_t left = (size_t)(limit - found);
+
+					if (left < entry.mSize)
+						return true;
+
+					const UByte* pattern = mData + entry.mPatternOffset;
+					const UByte* mask = mData + entry.mMaskOffset;
+
+					TBS_STATS_ADD(mCompares, 1);
+
+					if (left >= entry.mPaddedSize ? !ComparePadded(found, pattern, mask, entry.mPaddedSize) : !Compare(found, pattern, entry.mSize, mask))
+						return true;
+
+					TBS_STATS_ADD(mMatches, 1);
+
+					return onMatch((size_t)i, (Pattern::Result)(found - entry.mTrimmDisp));
+					};
+
+				const auto solo = [this, entries, start, end, limit, &onMatch](U32 i) {
+					const Entry& entry = entries[i];
+					const UByte* pattern = mData + entry.mPatternOffset;
+					const UByte* mask = mData + entry.mMaskOffset;
+					const size_t reach = entry.mSize - 1;
+					const UByte* windowEnd = (size_t)(limit - end) > reach ? end + reach : limit;
+
+					auto compareTail = [pattern, mask, &entry](const UByte* candidate) {
+						return Compare(candidate, pattern, entry.mSize, mask);
+						};
+
+					return Pattern::Find(pattern, mask, entry.mSize, GetPlan(entry), start, windowEnd, entry.mPaddedSize, [pattern, mask, &entry](const UByte* candidate) {
+						return ComparePadded(candidate, pattern, mask, entry.mPaddedSize);
+						}, compareTail, [i, &entry, &onMatch](const UByte* found) {
+						return onMatch((size_t)i, (Pattern::Result)(found - entry.mTrimmDisp));
+						});
+					};
+
+				return Pattern::MultiMatcher::Sweep(GetTables(), start, end, limit, verify, solo);
 			}
 
-			inline DescriptionBuilder Clone() const
+			template<typename OnMatchT>
+			inline bool Scan(const UByte* start, const UByte* end, OnMatchT&& onMatch) const
 			{
-				return DescriptionBuilder(*this);
+				return Scan(start, end, end, onMatch);
 			}
 
-			inline Description Build()
+		private:
+			/*
+				Validates every offset & plan of the image at `data`, Scan(), AddTo() & accessors trust them after
+			*/
+			inline bool Attach(const void* data, size_t size)
 			{
-				if (!(mRawPattern && mRawMask) && Pattern::Valid(mPattern) == false)
+				if (((UPtr)data % ALIGNMENT) != 0 || size < sizeof(Header))
+					return false;
+
+				const UByte* bytes = (const UByte*)data;
+				const Header& header = *(const Header*)bytes;
+
+				if (header.mMagic != MAGIC || header.mVersion != VERSION || header.mFileSize > size)
+					return false;
+
+				const auto fits = [&header](U64 offset, U64 len) {
+					return offset <= header.mFileSize && len <= header.mFileSize - offset;
+					};
+
+				if (!fits(header.mEntriesOffset, (U64)header.mEntryCount * sizeof(Entry)) || header.mEntriesOffset % alignof(Entry))
+					return false;
+
+				const Entry* entries = (const Entry*)(bytes + header.mEntriesOffset);
+
+				for (U32 i = 0; i < header.mEntryCount; i++)
 				{
-					static SharedDescription nullSharedDesc(EScan::SCAN_ALL);
-					static Description nullDescription(nullSharedDesc, "", 0, 0, {}, "");
-					return nullDescription;
-				}
+					const Entry& entry = entries[i];
 
-				if (mSharedDescriptions.find(mUID) == mSharedDescriptions.end())
-					mSharedDescriptions[mUID] = UniquePtr<SharedDescription>(new SharedDescription(mScanType));
+					if (!fits(entry.mUIDOffset, entry.mUIDSize) ||
+						entry.mSize == 0 || entry.mPaddedSize < entry.mSize || entry.mPaddedSize % ALIGNMENT ||
+						entry.mPatternOffset % ALIGNMENT || entry.mMaskOffset % ALIGNMENT ||
+						!fits(entry.mPatternOffset, entry.mPaddedSize) || !fits(entry.mMaskOffset, entry.mPaddedSize) ||
+						entry.mVerifyOrderOffset % alignof(U32) || !fits(entry.mVerifyOrderOffset, (U64)entry.mVerifyOrderCount * sizeof(U32)) ||
+						(entry.mSkip && !fits(entry.mSkipShiftOffset, 256)))
+						return false;
 
-				if (mRawPattern && mRawMask)
-					return Description(*mSharedDescriptions[mUID], mUID, mScanStart, mScanEnd, mTransformers, mRawPattern, mRawMask);
+					// At this point, every part is in the image, the plan must stay within the pattern
 
-				return Description(*mSharedDescriptions[mUID], mUID, mScanStart, mScanEnd, mTransformers, mPattern);
-			}
+					if ((U64)entry.mTrimmDisp + entry.mSize > ~U32(0) ||
+						entry.mAnchor >= entry.mSize || entry.mAnchor2 >= entry.mSize ||
+						entry.mVerifyOrderCount > entry.mSize)
+						return false;
 
-		private:
-			UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY>& mSharedDescriptions;
-			EScan mScanType;
-			String<> mPattern;
-			const void* mRawPattern;
-			const char* mRawMask;
-			String<> mUID;
-			const UByte* mScanStart;
-			const UByte* mScanEnd;
-			Vector<ResultTransformer> mTransformers;
-		};
-	}
+					const U32* verifyOrder = (const U32*)(bytes + entry.mVerifyOrderOffset);
 
-	template<U64 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE, U64 DESCS_CAPACITY = SHAREDDESCS_CAPACITY * 2>
-	struct State {
+					for (U32 k = 0; k < entry.mVerifyOrderCount; k++)
+					{
+						if (verifyOrder[k] >= entry.mSize)
+							return false;
+					}
 
-		using DescriptionBuilderT = Pattern::DescriptionBuilder<SHAREDDESCS_CAPACITY>;
+					if (!entry.mSkip)
+						continue;
 
-		inline State()
-			: State(nullptr, nullptr)
-		{}
+					// Horspool shifts of 0 would never advance, longer ones would skip matches
 
-		template<typename T, typename K>
-		inline State(T defScanStart = (T)0, K defScanEnd = (K)0)
-			: mDefaultScanStart((const UByte*)defScanStart)
-			, mDefaultScanEnd((const UByte*)defScanEnd)
-		{}
+					if (entry.mSkipLen == 0 || entry.mSkipLen > Pattern::Plan::SKIP_MAX_LEN || (U64)entry.mSkipStart + entry.mSkipLen > entry.mSize)
+						return false;
 
-		inline State& AddPattern(Pattern::Description&& pattern)
-		{
-			mDescriptionts.emplace_back(pattern);
-			return *this;
-		}
+					const UByte* shifts = bytes + entry.mSkipShiftOffset;
 
-		inline DescriptionBuilderT PatternBuilder()
-		{
-			return DescriptionBuilderT(mSharedDescriptions)
-				.setScanStart(mDefaultScanStart)
-				.setScanEnd(mDefaultScanEnd);
-		}
+					for (size_t c = 0; c < 256; c++)
+					{
+						if (shifts[c] == 0 || shifts[c] > entry.mSkipLen)
+							return false;
+					}
+				}
 
-		inline Pattern::SharedResultAccesor operator[](const String<>& uid) const
-		{
-			if (mSharedDescriptions.find(uid) != mSharedDescriptions.end())
-				return *(mSharedDescriptions.at(uid));
+				if (!fits(header.mMatcherOffset, sizeof(Matcher)) || header.mMatcherOffset % alignof(Matcher))
+					return false;
+
+				// At this point, the matcher is in the image, so must be its lists & the entries they refer to
 
-			static Pattern::SharedDescription nullSharedDesc(Pattern::EScan::SCAN_ALL);
+				const Matcher& matcher = *(const Matcher*)(bytes + header.mMatcherOffset);
 
-			return nullSharedDesc;
-		}
+				const auto entryList = [&](U32 offset, U64 count) {
+					if (offset % alignof(U32) || !fits(offset, count * sizeof(U32)))
+						return false;
 
-		const UByte* mDefaultScanStart;
-		const UByte* mDefaultScanEnd;
-		UMap<String<>, UniquePtr<Pattern::SharedDescription>, SHAREDDESCS_CAPACITY> mSharedDescriptions;
-		Vector<Pattern::Description, DESCS_CAPACITY> mDescriptionts;
-	};
+					const U32* list = (const U32*)(bytes + offset);
 
-	template<typename StateT>
-	static bool Scan(StateT& state)
-	{
-		USet<Pattern::Description*> doneSearchingDescs;
+					for (U64 k = 0; k < count; k++)
+					{
+						if (list[k] >= header.mEntryCount)
+							return false;
+					}
 
-#ifdef TBS_MT
-		std::mutex doneSearchingDescsMtx;
-#endif
+					return true;
+					};
 
-		while (doneSearchingDescs.size() < state.mDescriptionts.size())
-		{
-#ifdef TBS_MT
-			Thread::Pool threadPool;
-#endif
-			for (Pattern::Description& _description : state.mDescriptionts)
-			{
-				Pattern::Description* description = &_description;
+				if (matcher.mFingerprintLen > Matcher::FINGERPRINT_MAX_LEN || matcher.mBucketStarts[0] != 0)
+					return false;
 
+				for (size_t bucket = 0; bucket < Matcher::BUCKETS; bucket++)
 				{
-#ifdef TBS_MT
-					std::lock_guard<std::mutex> lck(doneSearchingDescsMtx);
-#endif
-
-					if (doneSearchingDescs.find(description) != doneSearchingDescs.end())
-						continue;
+					if (matcher.mBucketStarts[bucket] > matcher.mBucketStarts[bucket + 1])
+						return false;
 				}
-#ifdef TBS_MT
-				threadPool.enqueue(
-					[&doneSearchingDescs, &doneSearchingDescsMtx](Pattern::Description* description)
+
+				if (!entryList(matcher.mBucketEntriesOffset, matcher.mBucketStarts[Matcher::BUCKETS]) ||
+					!entryList(matcher.mSoloOffset, matcher.mSoloCount))
+					return false;
+
+				if (matcher.mKeySlotCount)
+				{
+					// Slot() of any key must land in [0, mKeySlotCount - 1)
+
+					const U32 slotBits = 32 - matcher.mKeyShift;
+
+					if (matcher.mKeyShift < 32 - Pattern::MultiMatcher::KEY_SLOT_MAX_BITS || matcher.mKeyShift > 31 || matcher.mKeySlotCount != (U32(1) << slotBits) + 1 ||
+						matcher.mKeyBitsOffset % alignof(U64) || !fits(matcher.mKeyBitsOffset, Matcher::KEY_BITS_SIZE) ||
+						matcher.mKeySlotsOffset % alignof(U32) || !fits(matcher.mKeySlotsOffset, (U64)matcher.mKeySlotCount * sizeof(U32)) ||
+						!entryList(matcher.mKeyEntriesOffset, matcher.mKeyEntryCount))
+						return false;
+
+					const U32* slots = (const U32*)(bytes + matcher.mKeySlotsOffset);
+
+					if (slots[0] != 0 || slots[matcher.mKeySlotCount - 1] != matcher.mKeyEntryCount)
+						return false;
+
+					for (U32 slot = 0; slot + 1 < matcher.mKeySlotCount; slot++)
 					{
-#endif
-						if (Pattern::Scan(*description) == false)
-						{
-#ifdef TBS_MT
-							std::lock_guard<std::mutex> lck(doneSearchingDescsMtx);
-#endif
-							doneSearchingDescs.insert(description);
-						}
+						if (slots[slot] > slots[slot + 1])
+							return false;
+					}
+				}
 
-#ifdef TBS_MT
-					}, description);
-#endif
+				mData = bytes;
+				mSize = size;
+
+				return true;
 			}
-		}
 
-		state.mDescriptionts.clear();
+			struct alignas(ALIGNMENT) PaddedBlock {
+				UByte mBytes[ALIGNMENT];
+			};
 
-		bool bAllFoundAny = true;
+			inline const Header& GetHeader() const
+			{
+				return *(const Header*)mData;
+			}
 
-		for (auto& sharedDescKv : state.mSharedDescriptions)
-			bAllFoundAny = bAllFoundAny && sharedDescKv.second->mResult.empty() == false;
+			inline const Entry& GetEntry(size_t i) const
+			{
+				return ((const Entry*)(mData + GetHeader().mEntriesOffset))[i];
+			}
 
-		return bAllFoundAny;
-	}
+			inline EntryPlan GetPlan(const Entry& entry) const
+			{
+				return EntryPlan{
+					entry.mAnchor, entry.mAnchor2, entry.mSolidAnchor != 0,
+					EntryPlan::Order{ (const U32*)(mData + entry.mVerifyOrderOffset), entry.mVerifyOrderCount },
+					entry.mSkip != 0, entry.mSkipStart, entry.mSkipLen, mData + entry.mSkipShiftOffset
+				};
+			}
 
-	template<typename K, U64 SHAREDDESCS_CAPACITY = TBS_CONTAINER_MAX_SIZE, U64 DESCS_CAPACITY = SHAREDDESCS_CAPACITY * 2>
-	static bool ScanOne(K start, K end, const String<>& pattern, Pattern::Result& outResult)
-	{
-		outResult = Pattern::Result{};
+			inline Matcher::Tables GetTables() const
+			{
+				const Matcher& matcher = *(const Matcher*)(mData + GetHeader().mMatcherOffset);
+
+				return Matcher::Tables{
+					matcher.mLo, matcher.mHi, matcher.mFingerprintLen,
+					matcher.mBucketStarts, (const U32*)(mData + matcher.mBucketEntriesOffset),
+					matcher.mKeySlotCount ? (const U64*)(mData + matcher.mKeyBitsOffset) : nullptr,
+					(const U32*)(mData + matcher.mKeySlotsOffset), (const U32*)(mData + matcher.mKeyEntriesOffset), matcher.mKeyShift,
+					(const U32*)(mData + matcher.mSoloOffset), matcher.mSoloCount
+				};
+			}
 
-		State<SHAREDDESCS_CAPACITY, DESCS_CAPACITY> state(start, end);
+			const UByte* mData;
+			size_t mSize;
+			bool mbMapped;
+			Vector<PaddedBlock> mOwned;
+		};
+	}
 
-		state.AddPattern(
-			state.PatternBuilder()
-			.setPattern(pattern)
-			.stopOnFirstMatch()
-			.Build()
-		);
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	namespace Pattern {
+		/*
+			String literal usable as template argument
+		*/
+		template<size_t LEN>
+		struct Literal {
+			constexpr Literal(const char(&str)[LEN])
+			{
+				for (size_t i = 0; i < LEN; i++)
+					mStr[i] = str[i];
+			}
 
-		if (!Scan(state))
-			return false;
+			char mStr[LEN] = {};
+		};
 
-		outResult = state[pattern];
+		template<Literal PATTERN>
+		struct CompiledOf {
+			static constexpr auto value = Compile<Compiler::CountBytes(PATTERN.mStr)>(PATTERN.mStr);
 
-		return true;
+			static_assert(value.mParseSuccess, "TBS: Invalid compiled pattern");
+		};
 	}
 
+	/*
+		TBS::CompiledPattern<"48 8B 05 ?? ?? ?? ??">, parsed at compile time
+	*/
+	template<Pattern::Literal PATTERN>
+	inline constexpr const auto& CompiledPattern = Pattern::CompiledOf<PATTERN>::value;
+#endif
+
+/*
+	C++17 counterpart of TBS::CompiledPattern, TBS_COMPILED_PATTERN("48 8B 05 ?? ?? ?? ??")
+*/
+#define TBS_COMPILED_PATTERN(pattern) ([] { \
+		constexpr auto compiled = ::TBS::Pattern::Compile<::TBS::Pattern::Compiler::CountBytes(pattern)>(pattern); \
+		static_assert(compiled.mParseSuccess, "TBS: Invalid compiled pattern " pattern); \
+		return compiled; }())
+
 	namespace Light {
 		template<typename T>
 		inline bool Scan(T _start, T _end, Pattern::Results& results, const Pattern::ParseResult& _parsed)
 		{
-			auto& parsed = const_cast<Pattern::ParseResult&>(_parsed);
+			const Pattern::ParseResult& parsed = _parsed;
 
 			results.clear();
 
@@ -1245,29 +7283,10 @@ namespace TBS {
 			if (start >= end)
 				return false;
 
-			const auto patternSize = parsed.getTrimmedSize();
-
-			const UByte* found = start - 1; // Minus one to bootstrap it with the next()
-
-			auto next = [&found, &end, &parsed] {
-				if (!parsed.TrimmedIsFirstTrullySolid()) // If solid is not solid, lets simply return [found + 1]
-				{
-					found++;
-					return;
-				}
-
-				found = SearchFirst(found + 1, end, parsed.getTrimmedPattern()[0]);
-				};
-
-			for (next(); found && found + patternSize - 1 < end; next())
-			{
-				if (Compare(found, parsed.getTrimmedPattern(), patternSize,
-					parsed.getTrimmedCompareMask()
-				) == false)
-					continue;
-
+			Pattern::Find(parsed, start, end, [&results, &parsed](const UByte* found) {
 				results.push_back((Pattern::Result)(found - parsed.mTrimmDisp));
-			}
+				return true;
+				});
 
 			return results.empty() == false;
 		}
@@ -1296,43 +7315,45 @@ namespace TBS {
 			return Scan<T>(_start, _end, results, parse);
 		}
 
-		template<typename T>
-		inline bool ScanOne(T _start, T _end, Pattern::Result& result, const Pattern::ParseResult& _parsed)
+		template<typename T, size_t N>
+		inline bool Scan(T _start, T _end, Pattern::Results& results, const Pattern::Compiled<N>& compiled)
 		{
-			auto& parsed = const_cast<Pattern::ParseResult&>(_parsed);
+			results.clear();
 
 			const UByte* start = (decltype(start))_start;
 			const UByte* end = (decltype(end))_end;
 
-			if (start >= end)
+			if (start >= end || !compiled)
 				return false;
 
-			const auto patternSize = parsed.getTrimmedSize();
+			Pattern::Find(compiled, start, end, [&results, &compiled](const UByte* found) {
+				results.push_back((Pattern::Result)(found - compiled.mTrimmDisp));
+				return true;
+				});
 
-			const UByte* found = start - 1; // Minus one to bootstrap it with the next()
+			return results.empty() == false;
+		}
 
-			auto next = [&found, &end, &parsed] {
-				if (!parsed.TrimmedIsFirstTrullySolid()) // If solid is not solid, lets simply return [found + 1]
-				{
-					found++;
-					return;
-				}
+		template<typename T>
+		inline bool ScanOne(T _start, T _end, Pattern::Result& result, const Pattern::ParseResult& _parsed)
+		{
+			const Pattern::ParseResult& parsed = _parsed;
 
-				found = Memory::SearchFirst(found + 1, end, parsed.getTrimmedPattern()[0]);
-				};
+			const UByte* start = (decltype(start))_start;
+			const UByte* end = (decltype(end))_end;
 
-			for (next(); found && found + patternSize - 1 < end; next())
-			{
-				if (Compare(found, parsed.getTrimmedPattern(), patternSize,
-					parsed.getTrimmedCompareMask()
-				) == false)
-					continue;
+			if (start >= end)
+				return false;
 
+			bool bFound = false;
+
+			Pattern::Find(parsed, start, end, [&result, &bFound, &parsed](const UByte* found) {
 				result = (Pattern::Result)(found - parsed.mTrimmDisp);
-				return true;
-			}
+				bFound = true;
+				return false;
+				});
 
-			return false;
+			return bFound;
 		}
 
 		template<typename T>
@@ -1359,5 +7380,314 @@ namespace TBS {
 			return ScanOne<T>(_start, _end, result, parse);
 		}
 
+		template<typename T, size_t N>
+		inline bool ScanOne(T _start, T _end, Pattern::Result& result, const Pattern::Compiled<N>& compiled)
+		{
+			const UByte* start = (decltype(start))_start;
+			const UByte* end = (decltype(end))_end;
+
+			if (start >= end || !compiled)
+				return false;
+
+			bool bFound = false;
+
+			Pattern::Find(compiled, start, end, [&result, &bFound, &compiled](const UByte* found) {
+				result = (Pattern::Result)(found - compiled.mTrimmDisp);
+				bFound = true;
+				return false;
+				});
+
+			return bFound;
+		}
+
 	}
+
+	/*
+		Scans input handed over piece by piece (read(), pipes, sockets, decompressor output...)
+		with a fixed memory footprint. The last longest trimmed pattern size - 1 bytes
+		of every piece are carried into the next one, so matches straddling pieces are found,
+		reported with their absolute stream offset. Single patterns go through Pattern::Find,
+		several ones through a Pattern::MultiMatcher sweep. Under TBS_MT big pieces are
+		split in slices scanned in parallel, matches are still reported in stream order.
+	*/
+	struct StreamScanner {
+		inline StreamScanner()
+			: mOffset(0)
+			, mMaxPatternSize(0)
+			, mbCompiled(false)
+		{}
+
+		/*
+			The matcher points into mPatterns
+		*/
+		StreamScanner(const StreamScanner&) = delete;
+		StreamScanner& operator=(const StreamScanner&) = delete;
+		StreamScanner(StreamScanner&&) = default;
+		StreamScanner& operator=(StreamScanner&&) = default;
+
+		/*
+			Returns the index matches of `parsed` are reported with
+		*/
+		inline size_t AddPattern(const Pattern::ParseResult& parsed)
+		{
+			mPatterns.push_back(parsed);
+			mResults.emplace_back();
+			mbCompiled = false;
+
+			if (parsed.mParseSuccess && parsed.getTrimmedSize() > mMaxPatternSize)
+				mMaxPatternSize = parsed.getTrimmedSize();
+
+			return mPatterns.size() - 1;
+		}
+
+		inline size_t AddPattern(const String<>& pattern)
+		{
+			Pattern::ParseResult parsed;
+			Pattern::Parse(pattern, parsed);
+
+			return AddPattern(parsed);
+		}
+
+		template<size_t N>
+		inline size_t AddPattern(const Pattern::Compiled<N>& compiled)
+		{
+			return AddPattern(compiled.ToParseResult());
+		}
+
+		/*
+			Scans the next `len` bytes of the stream, reporting `onMatch(patternIndex, offset)`
+			for every match ending within them, ascending by offset then pattern index.
+			The piece is swept whole before reporting, since leading wildcards shift
+			matches backwards by a per pattern amount. `onMatch` returning false aborts,
+			the piece is still accounted for, so feeding can go on.
+		*/
+		template<typename OnMatchT>
+		inline bool Feed(const void* _data, size_t len, OnMatchT&& onMatch)
+		{
+			const UByte* data = (const UByte*)_data;
+
+			Compile();
+
+			const size_t carryMax = mMaxPatternSize ? mMaxPatternSize - 1 : 0;
+			const size_t carried = mCarry.size();
+			const U64 carryOffset = mOffset - carried;
+
+			mMatches.clear();
+
+			auto report = [&](size_t idx, U64 trimmedOffset) {
+				// Leading wildcards need bytes before the trimmed start
+
+				if (trimmedOffset >= mPatterns[idx].mTrimmDisp)
+					mMatches.push_back({ trimmedOffset - mPatterns[idx].mTrimmDisp, idx });
+
+				return true;
+				};
+
+			// Seam, matches starting in the carried bytes whose end didnt fit last time
+
+			if (carried && len)
+			{
+				const size_t seamLen = len < carryMax ? len : carryMax;
+
+				mSeam.assign(mCarry.begin(), mCarry.end());
+				mSeam.insert(mSeam.end(), data, data + seamLen);
+
+				const UByte* seam = mSeam.data();
+
+				ScanRange(seam, seam + carried, seam + mSeam.size(), [&](size_t idx, const UByte* found) {
+					if (found + mPatterns[idx].getTrimmedSize() <= seam + carried)
+						return true;
+
+					return report(idx, carryOffset + (found - seam));
+					});
+			}
+
+			// Piece itself, in place
+
+			if (len)
+				ScanPiece(data, len, [&](size_t idx, const UByte* found) {
+				return report(idx, mOffset + (found - data));
+					});
+
+			// At this point, carrying the tail, it might start a match ending in the next piece
+
+			if (len >= carryMax)
+				mCarry.assign(data + len - carryMax, data + len);
+			else
+			{
+				mCarry.insert(mCarry.end(), data, data + len);
+
+				if (mCarry.size() > carryMax)
+					mCarry.erase(mCarry.begin(), mCarry.begin() + (mCarry.size() - carryMax));
+			}
+
+			mOffset += len;
+
+			// At this point, the piece is accounted for, only reporting is left
+
+			std::sort(mMatches.begin(), mMatches.end(), [](const Match& a, const Match& b) {
+				return a.mOffset != b.mOffset ? a.mOffset < b.mOffset : a.mPatternIndex < b.mPatternIndex;
+				});
+
+			for (const Match& match : mMatches)
+			{
+				if (!onMatch(match.mPatternIndex, match.mOffset))
+					return false;
+			}
+
+			return true;
+		}
+
+		/*
+			Collects the matches into Results(patternIndex)
+		*/
+		inline void Feed(const void* data, size_t len)
+		{
+			Feed(data, len, [this](size_t idx, U64 offset) {
+				mResults[idx].push_back((Pattern::Result)offset);
+				return true;
+				});
+		}
+
+		inline const Pattern::Results& Results(size_t patternIndex) const
+		{
+			return mResults[patternIndex];
+		}
+
+		/*
+			Bytes fed so far
+		*/
+		inline U64 Offset() const
+		{
+			return mOffset;
+		}
+
+		/*
+			Back to the stream start, patterns are kept
+		*/
+		inline void Reset()
+		{
+			mOffset = 0;
+			mCarry.clear();
+
+			for (auto& results : mResults)
+				results.clear();
+		}
+
+	private:
+		struct Hit {
+			size_t mPatternIndex;
+			const UByte* mFound;
+		};
+
+		struct Match {
+			U64 mOffset;
+			size_t mPatternIndex;
+		};
+
+		inline void Compile()
+		{
+			if (mbCompiled)
+				return;
+
+			// At this point, patterns are stable in memory
+
+			mMatcher = Pattern::MultiMatcher();
+
+			for (const Pattern::ParseResult& parsed : mPatterns)
+				mMatcher.Add(parsed);
+
+			mMatcher.Compile();
+			mbCompiled = true;
+		}
+
+		/*
+			Reports through `onHit(patternIndex, found)` trimmed starts in [start, end) fitting before `limit`
+		*/
+		template<typename OnHitT>
+		inline bool ScanRange(const UByte* start, const UByte* end, const UByte* limit, OnHitT&& onHit) const
+		{
+			if (mPatterns.size() != 1)
+				return mMatcher.Scan(start, end, limit, onHit);
+
+			const Pattern::ParseResult& parsed = mPatterns[0];
+
+			if (!parsed.mParseSuccess)
+				return true;
+
+			const size_t reach = parsed.getTrimmedSize() - 1;
+			const UByte* windowEnd = (size_t)(limit - end) > reach ? end + reach : limit;
+
+			return Pattern::Find(parsed, start, windowEnd, [&onHit](const UByte* found) {
+				return onHit(0, found);
+				});
+		}
+
+		template<typename OnHitT>
+		inline bool ScanPiece(const UByte* data, size_t len, OnHitT&& onHit)
+		{
+#ifdef TBS_MT
+			if (len >= PATTERN_SEARCH_SLICE_SIZE * 2 && Thread::Pool::Instance().WorkerCount())
+			{
+				struct SliceTask : Thread::TaskOf<SliceTask> {
+					inline SliceTask(const StreamScanner& scanner, const UByte* start, const UByte* end, const UByte* limit)
+						: mScanner(&scanner)
+						, mStart(start)
+						, mEnd(end)
+						, mLimit(limit)
+					{}
+
+					inline void Run()
+					{
+						mScanner->ScanRange(mStart, mEnd, mLimit, [this](size_t idx, const UByte* found) {
+							mHits.push_back({ idx, found });
+							return true;
+							});
+					}
+
+					const StreamScanner* mScanner;
+					const UByte* mStart;
+					const UByte* mEnd;
+					const UByte* mLimit;
+					Vector<Hit> mHits;
+				};
+
+				Vector<SliceTask> tasks;
+
+				for (const UByte* slice = data; slice < data + len; slice += PATTERN_SEARCH_SLICE_SIZE)
+				{
+					const UByte* sliceEnd = (size_t)(data + len - slice) > PATTERN_SEARCH_SLICE_SIZE ? slice + PATTERN_SEARCH_SLICE_SIZE : data + len;
+					tasks.emplace_back(*this, slice, sliceEnd, data + len);
+				}
+
+				Thread::Run(tasks.data(), tasks.size());
+
+				// At this point, slices are in stream order, so are their hits
+
+				for (const SliceTask& task : tasks)
+				{
+					for (const Hit& hit : task.mHits)
+					{
+						if (!onHit(hit.mPatternIndex, hit.mFound))
+							return false;
+					}
+				}
+
+				return true;
+			}
+#endif
+
+			return ScanRange(data, data + len, data + len, onHit);
+		}
+
+		Vector<Pattern::ParseResult> mPatterns;
+		Vector<Pattern::Results> mResults;
+		Pattern::MultiMatcher mMatcher;
+		Vector<UByte> mCarry;
+		Vector<UByte> mSeam;
+		Vector<Match> mMatches;
+		U64 mOffset;
+		size_t mMaxPatternSize;
+		bool mbCompiled;
+	};
 }
@@ -24,4 +24,117 @@ TEST_CASE("Memory Searching First")
 
 	result = SearchFirst(result + 1, testCase + sizeof(testCase), toFind);
 	CHECK(result == testCase + 31);
-}
\ No newline at end of file
+}
+TEST_CASE("Memory Searching Anchors")
+{
+	// Small alphabet, plenty of single anchor hits but few dual ones
+
+	UByte testCase[300];
+	U32 seed = 0xABCDEF;
+	for (auto& b : testCase)
+	{
+		seed = seed * 1103515245 + 12345;
+		b = UByte((seed >> 16) & 0x07);
+	}
+
+	const size_t off1 = 3, off2 = 11;
+	const UByte byte1 = 0x05, byte2 = 0x02;
+	const UByte* end = testCase + sizeof(testCase) - off2;
+
+	std::vector<const UByte*> expected;
+	Memory::SearchAnchors(testCase, end, off1, byte1, off2, byte2, [&](const UByte* i) { expected.push_back(i); return true; });
+	CHECK(expected.size() > 0);
+
+	for (const UByte* i : expected)
+		CHECK((i[off1] == byte1 && i[off2] == byte2));
+
+	std::vector<const UByte*> found;
+	Memory::SIMD::SSE2::SearchAnchors(testCase, end, off1, byte1, off2, byte2, [&](const UByte* i) { found.push_back(i); return true; });
+	CHECK(found == expected);
+
+	if (Memory::SIMD::AVX2::Supported())
+	{
+		found.clear();
+		Memory::SIMD::AVX2::SearchAnchors(testCase, end, off1, byte1, off2, byte2, [&](const UByte* i) { found.push_back(i); return true; });
+		CHECK(found == expected);
+	}
+
+	// Aborting stops at the very first candidate
+
+	found.clear();
+	CHECK_FALSE(Memory::SIMD::SSE2::SearchAnchors(testCase, end, off1, byte1, off2, byte2, [&](const UByte* i) { found.push_back(i); return false; }));
+	CHECK_EQ(found.size(), 1);
+	CHECK(found[0] == expected[0]);
+}
+
+TEST_CASE("Memory Comparing Masked SIMD")
+{
+	UByte chunk[77], pattern[77], mask[77];
+
+	for (size_t i = 0; i < sizeof(chunk); i++)
+	{
+		chunk[i] = UByte(i * 7);
+		pattern[i] = UByte(i % 3 ? i * 7 : 0xEE);
+		mask[i] = i % 3 ? 0xFF : 0x00;
+	}
+
+	CHECK(Memory::Compare(chunk, pattern, sizeof(chunk), mask));
+	CHECK(Memory::SIMD::SSE2::Compare(chunk, pattern, sizeof(chunk), mask));
+
+	if (Memory::SIMD::AVX::Supported())
+		CHECK(Memory::SIMD::AVX::Compare(chunk, pattern, sizeof(chunk), mask));
+
+	if (Memory::SIMD::AVX2::Supported())
+		CHECK(Memory::SIMD::AVX2::Compare(chunk, pattern, sizeof(chunk), mask));
+
+	// Single difference in every possible position, vector & tail parts
+
+	for (size_t i = 1; i < sizeof(chunk); i += 3)
+	{
+		chunk[i] ^= 0x10;
+
+		CHECK_FALSE(Memory::SIMD::SSE2::Compare(chunk, pattern, sizeof(chunk), mask));
+
+		if (Memory::SIMD::AVX::Supported())
+			CHECK_FALSE(Memory::SIMD::AVX::Compare(chunk, pattern, sizeof(chunk), mask));
+
+		if (Memory::SIMD::AVX2::Supported())
+			CHECK_FALSE(Memory::SIMD::AVX2::Compare(chunk, pattern, sizeof(chunk), mask));
+
+		chunk[i] ^= 0x10;
+	}
+}
+
+TEST_CASE("Memory Comparing Padded SIMD")
+{
+	UByte chunk[64];
+	alignas(32) UByte pattern[64], mask[64];
+
+	for (size_t i = 0; i < sizeof(chunk); i++)
+	{
+		chunk[i] = UByte(i * 5);
+		pattern[i] = UByte(i < 40 && i % 4 ? i * 5 : 0x00);
+		mask[i] = i < 40 && i % 4 ? 0xFF : 0x00; // 40 bytes pattern, zero padded up to 64
+	}
+
+	CHECK(Memory::SIMD::SSE2::ComparePadded(chunk, pattern, mask, sizeof(chunk)));
+
+	if (Memory::SIMD::AVX2::Supported())
+		CHECK(Memory::SIMD::AVX2::ComparePadded(chunk, pattern, mask, sizeof(chunk)));
+
+	// Differences under the padding never count, within the pattern always do
+
+	for (size_t i = 0; i < sizeof(chunk); i++)
+	{
+		chunk[i] ^= 0x01;
+
+		const bool bExpected = mask[i] == 0x00;
+
+		CHECK_EQ(Memory::SIMD::SSE2::ComparePadded(chunk, pattern, mask, sizeof(chunk)), bExpected);
+
+		if (Memory::SIMD::AVX2::Supported())
+			CHECK_EQ(Memory::SIMD::AVX2::ComparePadded(chunk, pattern, mask, sizeof(chunk)), bExpected);
+
+		chunk[i] ^= 0x01;
+	}
+}
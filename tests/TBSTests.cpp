@@ -1,5 +1,9 @@
 #include <doctest/doctest.h>
 #include <iostream>
+#include <atomic>
+#include <map>
+#include <set>
+#include <thread>
 
 #include <TBS/TBS.hpp>
 
@@ -44,6 +48,18 @@ TEST_CASE("Pattern Parsing") {
 	CHECK_EQ(res.mCompareMask.size(), 3 /*Just 3 valid bytes*/);
 	CHECK(memcmp(res.mCompareMask.data(), "\xFF\x00\xFF", 3) == 0);
 	CHECK(res.mTrimmDisp == 0);
+
+	CHECK_FALSE(Pattern::Parse("AA 4G ? BB", res)); // Non hex digits
+	CHECK_EQ(res.mPattern.size(), 1);
+	CHECK_FALSE(Pattern::Parse("AA ?x", res));
+	CHECK_FALSE(Pattern::Parse("G", res));
+
+	CHECK(Pattern::Valid("AA ?? B? ?C d ?"));
+	CHECK(Pattern::Valid("  ?? ??  "));
+	CHECK_FALSE(Pattern::Valid(""));
+	CHECK_FALSE(Pattern::Valid("   "));
+	CHECK_FALSE(Pattern::Valid("AA 4G"));
+	CHECK_FALSE(Pattern::Valid("AA ???"));
 	
 
 	const char testRawPattern[] = "\x10\xFF\x30\x40\xFF\x60";
@@ -191,28 +207,43 @@ TEST_CASE("Pattern Sliced Scan Test")
 	Pattern::Description& pattern1 = state.mDescriptionts[0];
 	Pattern::Description& pattern2 = state.mDescriptionts[1];
 
+	Pattern::Description::Cursor cursor1(pattern1);
+	Pattern::Description::Cursor cursor2(pattern2);
+
 	auto pattern1Size = pattern1.mParsed.mPattern.size();
 	auto pattern2Size = pattern2.mParsed.mPattern.size();
 
 	// Expected to be at the beginning
-	CHECK(pattern1.mLastSearchPos == buff);
-	CHECK(pattern2.mLastSearchPos == buff);
+	CHECK(cursor1.mLastSearchPos == buff);
+	CHECK(cursor2.mLastSearchPos == buff);
 
 	// Expected the pattern to keep wanting to find more (in subsecuent slices of search range)
-	CHECK(Pattern::Scan(pattern1));
-	CHECK(Pattern::Scan(pattern2));
+	CHECK(Pattern::Scan(pattern1, cursor1));
+	CHECK(Pattern::Scan(pattern2, cursor2));
 
 	// Expected first slice scan exausted and .mLastSearchPosition to be = buff + PATTERN_SEARCH_SLICE_SIZE - patternXSize aka at the end of first slice
-	CHECK_EQ(pattern1.mLastSearchPos, PatternScanSliceBase(buff, 1) - pattern1Size);
-	CHECK_EQ(pattern2.mLastSearchPos, PatternScanSliceBase(buff, 1) - pattern2Size);
+	CHECK_EQ(cursor1.mLastSearchPos, PatternScanSliceBase(buff, 1) - pattern1Size);
+	CHECK_EQ(cursor2.mLastSearchPos, PatternScanSliceBase(buff, 1) - pattern2Size);
 
 	// Same Again..., now we expect a false, since we will consume second and last scanning slice
-	CHECK_FALSE(Pattern::Scan(pattern1));
-	CHECK_FALSE(Pattern::Scan(pattern2));
+	CHECK_FALSE(Pattern::Scan(pattern1, cursor1));
+	CHECK_FALSE(Pattern::Scan(pattern2, cursor2));
 
 	// Now at the end of second slice
-	CHECK_EQ(pattern1.mLastSearchPos, PatternScanSliceBase(buff, 2) - pattern1Size);
-	CHECK_EQ(pattern2.mLastSearchPos, PatternScanSliceBase(buff, 2) - pattern2Size);
+	CHECK_EQ(cursor1.mLastSearchPos, PatternScanSliceBase(buff, 2) - pattern1Size);
+	CHECK_EQ(cursor2.mLastSearchPos, PatternScanSliceBase(buff, 2) - pattern2Size);
+
+	// Descriptions are left untouched, a fresh cursor starts over
+	Pattern::Description::Cursor restart(pattern1);
+	CHECK(restart.mLastSearchPos == buff);
+	CHECK(Pattern::Scan(pattern1, restart));
+
+	// Without a cursor, the one each description carries moves along
+	CHECK(Pattern::Scan(pattern2));
+	CHECK_EQ(pattern2.mCursor.mLastSearchPos, PatternScanSliceBase(buff, 1) - pattern2Size);
+	CHECK_FALSE(Pattern::Scan(pattern2));
+	CHECK_EQ(pattern2.mCursor.mLastSearchPos, PatternScanSliceBase(buff, 2) - pattern2Size);
+	CHECK_FALSE(Pattern::Scan(pattern2));
 
 	// Sanity Checks, expecting TBS::Scan to return false (patterns already at end and didnt found anything)
 	CHECK_FALSE(Scan(state));
@@ -260,10 +291,10 @@ TEST_CASE("Pattern Scan #1")
 		.PatternBuilder()
 		.setPattern("AA ? BB ? CC ? DD ? EE ? FF")
 		.setUID("TestUID")
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 			return U64(((*(U32*)(res + 6))) & 0x00FF00FFull); // Just Picking 0xEE and 0xFF
 			})
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 				// expected to be 0xXXEEXXDD comming from previous transform
 				CHECK(res == 0x00EE00DDull);
 				return res | 0xFF00FF00ull; // expected to be 0xFFEEFFDD
@@ -339,10 +370,10 @@ TEST_CASE("Pattern Scan #2")
 			.setPattern("? 04 ? ?? ?7 0?")
 			.setScanStart(buffer1)
 			.setScanEnd(buffer1 + sizeof(buffer1))
-			.AddTransformer([](auto& desc, U64 res) {
+			.AddTransformer([](auto&, U64 res) {
 				return res + pattern1TostrRelOff1;
 			})
-			.AddTransformer([](auto& desc, U64 res) {
+			.AddTransformer([](auto&, U64 res) {
 				return res + *(size_t*)res;
 			})
 			.Build()
@@ -354,10 +385,10 @@ TEST_CASE("Pattern Scan #2")
 			.setPattern("4? ? ?8 49 ? 4B 4?")
 			.setScanStart(buffer2)
 			.setScanEnd(buffer2 + sizeof(buffer2))
-			.AddTransformer([](auto& desc, U64 res) {
+			.AddTransformer([](auto&, U64 res) {
 				return res + pattern2TostrRelOff2;
 			})
-			.AddTransformer([](auto& desc, U64 res) {
+			.AddTransformer([](auto&, U64 res) {
 				return res + *(size_t*)res;
 			})
 			.Build()
@@ -393,10 +424,10 @@ TEST_CASE("Pattern Scan #3")
 		.setPatternRaw("\xAA\x00\xBB\x00\xCC\x00\xDD\x00\xEE\x00\xFF")
 		.setMask("x?x?x?x?x?x")
 		.setUID("TestUID")
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 			return U64(((*(U32*)(res + 6))) & 0x00FF00FFull); // Just Picking 0xEE and 0xFF
 			})
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 				// expected to be 0xXXEEXXDD comming from previous transform
 				CHECK(res == 0x00EE00DDull);
 				return res | 0xFF00FF00ull; // expected to be 0xFFEEFFDD
@@ -420,10 +451,10 @@ TEST_CASE("Pattern Scan #4")
 	auto builder = state
 		.PatternBuilder()
 		.setUID("TestUID")
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 		return U64(((*(U32*)(res + 6))) & 0x00FF00FFull); // Just Picking 0xEE and 0xFF
 			})
-		.AddTransformer([](Pattern::Description& desc, U64 res) -> U64 {
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
 				// expected to be 0xXXEEXXDD comming from previous transform
 				CHECK(res == 0x00EE00DDull);
 				return res | 0xFF00FF00ull; // expected to be 0xFFEEFFDD
@@ -482,4 +513,1945 @@ TEST_CASE("Pattern Scan #5")
 	auto tstCase0Addr = &testCase[0];
 	CHECK_EQ(tstCase0Addr, (decltype(tstCase0Addr))(TBS::Pattern::Result)state["TestUID1"]);
 	CHECK_EQ(tstCase0Addr, (decltype(tstCase0Addr))(TBS::Pattern::Result)state["TestUID2"]);
-}
\ No newline at end of file
+}
+TEST_CASE("Multi Pattern Scan")
+{
+	// Random buffer spanning several slices, so grouped slicing & slice boundaries get exercised
+
+	constexpr auto TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 3 + 123;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x1234567;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte(seed >> 16);
+	}
+
+	// Plant some matches right at the slice boundaries & at the very end
+
+	memcpy(buff + PATTERN_SEARCH_SLICE_SIZE - 2, "\x48\x8B\x05\x11\x22\x33\x44", 7);
+	memcpy(buff + PATTERN_SEARCH_SLICE_SIZE * 2 - 1, "\xE8\x10\x20\x30\x40\xC3", 6);
+	memcpy(buff + TESTBUFF_SIZE - 4, "\xDE\xAD\xBE\xEF", 4);
+
+	const char* patterns[] = {
+		"48 8B 05 ? ? ? ?",
+		"E8 ? ? ? ? C3",
+		"DE AD BE EF",
+		"? ? DE AD",
+		"4? 8B",
+		"?B",
+		"C3",
+		"AA BB CC DD EE FF 00 11", // Guaranteed not to be found
+	};
+
+	State<> state(buff, buff + TESTBUFF_SIZE);
+	state.setMultiPattern();
+
+	for (const char* pattern : patterns)
+		state.AddPattern(state.PatternBuilder().setPattern(pattern).Build());
+
+	// Single pass should be shared by all patterns, yet behave like a scan per pattern
+
+	CHECK_FALSE(Scan(state)); // Last one is never found
+
+	for (const char* pattern : patterns)
+	{
+		Pattern::Results expected;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, expected, pattern);
+
+		Pattern::Results results = state[pattern].ResultsGet();
+		std::sort(results.begin(), results.end());
+
+		CHECK_EQ(results.size(), expected.size());
+		CHECK(results == expected);
+	}
+
+	CHECK(state["48 8B 05 ? ? ? ?"].ResultsGet().size() >= 1);
+	CHECK(state["E8 ? ? ? ? C3"].ResultsGet().size() >= 1);
+	CHECK_EQ((const UByte*)(Pattern::Result)state["DE AD BE EF"], buff + TESTBUFF_SIZE - 4);
+}
+
+TEST_CASE("Multi Pattern Scan First")
+{
+	UByte testCase[] = {
+		0xCC, 0x00, 0x11, 0x22, 0xCC, 0x00, 0x11, 0x22
+	};
+
+	State<> state(testCase, testCase + sizeof(testCase));
+	state.setMultiPattern();
+
+	state.AddPattern(
+		state
+		.PatternBuilder()
+		.stopOnFirstMatch()
+		.setUID("First")
+		.setPattern("CC ? 11")
+		.Build()
+	);
+
+	state.AddPattern(
+		state
+		.PatternBuilder()
+		.setUID("All")
+		.setPattern("CC 00")
+		.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
+			return res + 1;
+			})
+		.Build()
+	);
+
+	CHECK(Scan(state));
+	CHECK(state["First"].ResultsGet().size() == 1);
+	CHECK_EQ(state["All"].ResultsGet().size(), 2);
+	CHECK_EQ((UByte*)(Pattern::Result)state["First"], &testCase[0]);
+	CHECK_EQ((UByte*)(Pattern::Result)state["All"], &testCase[1]);
+}
+
+TEST_CASE("Multi Pattern Saturated Scan")
+{
+	// Hundreds of patterns saturate the fingerprint, so they get keyed by their
+	// leading bytes, wildcarded leads still fingerprinted or searched one by one
+
+	constexpr auto TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 2 + 77;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0xBADC0DE;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte(seed >> 16);
+	}
+
+	std::vector<std::string> patterns;
+
+	for (size_t i = 0; i < 300; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		const size_t at = (seed >> 8) % (TESTBUFF_SIZE - 8);
+
+		char text[64];
+		snprintf(text, sizeof(text), "%02X %02X %02X ? %02X %02X", buff[at], buff[at + 1], buff[at + 2], buff[at + 4], buff[at + 5]);
+
+		if (i % 5 == 1)
+			text[3] = '?';			// Nibble wildcarded 2nd byte, still keyed
+		else if (i % 5 == 2)
+			text[3] = text[4] = '?';	// Wildcarded 2nd byte, cant be keyed
+
+		patterns.push_back(text);
+	}
+
+	patterns.push_back("C3");
+	patterns.push_back("? ? DE AD");
+
+	Pattern::MultiMatcher matcher;
+	std::vector<Pattern::ParseResult> parsed(patterns.size());
+
+	for (size_t i = 0; i < patterns.size(); i++)
+	{
+		CHECK(Pattern::Parse(patterns[i].c_str(), parsed[i]));
+		matcher.Add(parsed[i]);
+	}
+
+	matcher.Compile();
+
+	CHECK_FALSE(matcher.mKeyPatterns.empty());
+	CHECK_FALSE(matcher.mSolo.empty());
+
+	for (int multiPattern = 0; multiPattern < 2; multiPattern++)
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern(multiPattern != 0);
+
+		for (const auto& pattern : patterns)
+			state.AddPattern(state.PatternBuilder().setPattern(pattern.c_str()).Build());
+
+		Scan(state);
+
+		for (const auto& pattern : patterns)
+		{
+			Pattern::Results expected;
+			Light::Scan(buff, buff + TESTBUFF_SIZE, expected, pattern.c_str());
+
+			Pattern::Results results = state[pattern.c_str()].ResultsGet();
+			std::sort(results.begin(), results.end());
+
+			CHECK(results == expected);
+		}
+	}
+
+	// Same tables compiled into a database image, scanned in place
+
+	Database::Writer writer;
+
+	for (const auto& pattern : patterns)
+		CHECK(writer.Add(pattern.c_str(), pattern.c_str()));
+
+	Vector<UByte> image;
+	writer.Serialize(image);
+
+	struct alignas(Database::ALIGNMENT) Block {
+		UByte mBytes[Database::ALIGNMENT];
+	};
+
+	std::unique_ptr<Block[]> aligned(new Block[image.size() / sizeof(Block) + 1]);
+	memcpy(aligned.get(), image.data(), image.size());
+
+	Database::Reader reader;
+	REQUIRE(reader.Open(aligned.get(), image.size()));
+
+	const Database::Matcher& tables = *(const Database::Matcher*)(image.data() + ((const Database::Header*)image.data())->mMatcherOffset);
+	CHECK(tables.mKeySlotCount);
+	CHECK(tables.mSoloCount);
+
+	std::map<std::string, Pattern::Results> found;
+
+	CHECK(reader.Scan(buff, buff + TESTBUFF_SIZE, [&](size_t entry, Pattern::Result result) {
+		const StringView uid = reader.UID(entry);
+		found[std::string(uid.data(), uid.size())].push_back(result);
+		return true;
+		}));
+
+	for (const auto& pattern : patterns)
+	{
+		Pattern::Results expected;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, expected, pattern.c_str());
+
+		// Patterns drawn twice are two entries under the same UID
+
+		Pattern::Results& results = found[pattern];
+		std::sort(results.begin(), results.end());
+		results.erase(std::unique(results.begin(), results.end()), results.end());
+
+		CHECK(results == expected);
+	}
+}
+
+TEST_CASE("Pattern Planning")
+{
+	Pattern::ParseResult res;
+
+	// 48 & 8B are everywhere in x86 code, 05 is expected to anchor
+
+	CHECK(Pattern::Parse("48 8B 05 ? ? ? ?", res));
+	CHECK(res.mPlan.mSolidAnchor);
+	CHECK_EQ(res.mPlan.mAnchor, 2);
+	CHECK(res.mPlan.HasSecondAnchor());
+	CHECK_EQ(res.mPlan.mVerifyOrder.size(), 1);
+
+	// Offsets are relative to the trimmed pattern, wildcards are never verified
+
+	CHECK(Pattern::Parse("? ? 00 ? 9A 4?", res));
+	CHECK_EQ(res.mTrimmDisp, 2);
+	CHECK_EQ(res.mPlan.mAnchor, 2);
+	CHECK_EQ(res.mPlan.mAnchor2, 0);
+	CHECK_EQ(res.mPlan.mVerifyOrder.size(), 1);
+	CHECK_EQ(res.mPlan.mVerifyOrder[0], 3);
+
+	// Nothing solid to anchor on
+
+	CHECK(Pattern::Parse("4? ?5", res));
+	CHECK_FALSE(res.mPlan.mSolidAnchor);
+	CHECK_EQ(res.mPlan.mVerifyOrder.size(), 2);
+
+	// Sampled distribution overrides the default one
+
+	UByte data[0x400];
+	memset(data, 0x17, sizeof(data));
+	memcpy(data + 0x200, "\x17\x17\x48\x17", 4);
+
+	CHECK(Pattern::Parse("17 17 48 17", res));
+	CHECK_EQ(res.mPlan.mAnchor, 0);
+
+	Pattern::BuildPlan(res, Pattern::Histogram().Sample(data, data + sizeof(data)));
+	CHECK_EQ(res.mPlan.mAnchor, 2);
+
+	Pattern::Results results;
+	CHECK(Light::Scan(data, data + sizeof(data), results, res));
+	CHECK_EQ(results.size(), 1);
+	CHECK_EQ((UByte*)results[0], data + 0x200);
+}
+
+TEST_CASE("Planned Scan Equivalence")
+{
+	// Planned search must report exactly what a naive byte by byte search does
+
+	constexpr size_t TESTBUFF_SIZE = 0x4000;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0xC0FFEE;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F); // Small alphabet, so there are plenty of hits
+	}
+
+	const char* patterns[] = {
+		"01 02",
+		"0? 03 ? 04",
+		"? ? 05 ? ?6 07",
+		"00 00 00",
+		"?1 ?2",
+		"0A ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? 0B",
+	};
+
+	for (const char* pattern : patterns)
+	{
+		Pattern::ParseResult parsed;
+		CHECK(Pattern::Parse(pattern, parsed));
+
+		Pattern::Results expected;
+		for (size_t i = 0; i + parsed.mPattern.size() <= TESTBUFF_SIZE; i++)
+		{
+			if (Memory::Compare(buff + i, parsed.mPattern.data(), parsed.mPattern.size(), parsed.mCompareMask.data()))
+				expected.push_back((Pattern::Result)(buff + i));
+		}
+
+		Pattern::Results results;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, results, parsed);
+		CHECK(results == expected);
+
+		Pattern::BuildPlan(parsed, Pattern::Histogram().Sample(buff, buff + TESTBUFF_SIZE));
+		Light::Scan(buff, buff + TESTBUFF_SIZE, results, parsed);
+		CHECK(results == expected);
+
+		Pattern::Result first = 0;
+		CHECK_EQ(Light::ScanOne(buff, buff + TESTBUFF_SIZE, first, parsed), !expected.empty());
+		CHECK((expected.empty() || first == expected[0]));
+	}
+}
+
+TEST_CASE("Compiled Pattern")
+{
+	constexpr auto compiled = TBS_COMPILED_PATTERN("? 48 8B 0? ?5 ?? 11");
+
+	static_assert(compiled.SIZE == 7, "Byte count");
+	static_assert(compiled.mTrimmDisp == 1, "Leading wildcard trimmed");
+	static_assert(compiled.mPattern[1] == 0x48 && compiled.mCompareMask[1] == 0xFF, "Solid byte");
+	static_assert(compiled.mPattern[3] == 0x00 && compiled.mCompareMask[3] == 0xF0, "Low nibble wildcard");
+	static_assert(compiled.mPattern[4] == 0x05 && compiled.mCompareMask[4] == 0x0F, "High nibble wildcard");
+	static_assert(compiled.mCompareMask[5] == 0x00 && compiled.mCompareMask[7] == 0x00, "Wildcard & padding");
+	static_assert(!Pattern::Compile<Pattern::Compiler::CountBytes("48 XY")>("48 XY"), "Non hex rejected");
+	static_assert(!Pattern::Compile<Pattern::Compiler::CountBytes("48 123")>("48 123"), "Long token rejected");
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+	static_assert(TBS::CompiledPattern<"? 48 8B 0? ?5 ?? 11">.mPattern == compiled.mPattern, "Same as macro");
+#endif
+
+	// Same layout as the runtime parse
+
+	Pattern::ParseResult parsed = compiled.ToParseResult();
+	Pattern::ParseResult expected;
+	CHECK(Pattern::Parse("? 48 8B 0? ?5 ?? 11", expected));
+	CHECK(parsed.mPattern == expected.mPattern);
+	CHECK(parsed.mCompareMask == expected.mCompareMask);
+	CHECK_EQ(parsed.mTrimmDisp, expected.mTrimmDisp);
+	CHECK_EQ(parsed.mPlan.mAnchor, expected.mPlan.mAnchor);
+
+	// Same results as the runtime parsed scan, also for matches right at the end,
+	// where there is no room for a whole vector load
+
+	constexpr size_t TESTBUFF_SIZE = 0x4000;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0xBADF00D;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F);
+	}
+
+	constexpr auto shortPattern = TBS_COMPILED_PATTERN("0B ?2 0C");
+	constexpr auto longPattern = TBS_COMPILED_PATTERN("0A ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? 0B ? 0C");
+
+	memcpy(buff + TESTBUFF_SIZE - 23, "\x0A", 1);
+	memcpy(buff + TESTBUFF_SIZE - 3, "\x0B\x02\x0C", 3);
+
+	auto checkEquivalent = [buff](const auto& compiledPattern, const char* pattern) {
+		Pattern::Results expected, results;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, expected, pattern);
+		CHECK(Light::Scan(buff, buff + TESTBUFF_SIZE, results, compiledPattern));
+		CHECK(results == expected);
+		CHECK_EQ(results.back(), (Pattern::Result)(buff + TESTBUFF_SIZE - compiledPattern.SIZE));
+
+		Pattern::Result first = 0;
+		CHECK(Light::ScanOne(buff, buff + TESTBUFF_SIZE, first, compiledPattern));
+		CHECK_EQ(first, expected[0]);
+		};
+
+	checkEquivalent(shortPattern, "0B ?2 0C");
+	checkEquivalent(longPattern, "0A ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? 0B ? 0C");
+
+	// Plans built at compile time make the same choices as the runtime ones
+
+	auto checkSamePlan = [](const auto& compiledPattern) {
+		const Pattern::ParseResult runtime = compiledPattern.ToParseResult();
+		const auto& plan = compiledPattern.mPlan;
+
+		CHECK_EQ(plan.mSolidAnchor, runtime.mPlan.mSolidAnchor);
+		CHECK_EQ(plan.mAnchor, runtime.mPlan.mAnchor);
+		CHECK_EQ(plan.mAnchor2, runtime.mPlan.mAnchor2);
+		CHECK_EQ(plan.mVerifyOrder.size(), runtime.mPlan.mVerifyOrder.size());
+
+		for (size_t i = 0; i < plan.mVerifyOrder.size() && i < runtime.mPlan.mVerifyOrder.size(); i++)
+			CHECK_EQ(plan.mVerifyOrder[i], runtime.mPlan.mVerifyOrder[i]);
+
+		CHECK_EQ(plan.UseSkip(), runtime.mPlan.UseSkip());
+		CHECK_EQ(plan.mSkipLen != 0, runtime.mPlan.mSkipLen != 0);
+		};
+
+	checkSamePlan(compiled);
+	checkSamePlan(shortPattern);
+	checkSamePlan(longPattern);
+	checkSamePlan(TBS_COMPILED_PATTERN("48 89 5C 24 08 48 89 74 24 10 57 48 83 EC 20 48 8B F9 48 8B 0D"));
+
+	// Through the State builder, UID defaults to the pattern text
+
+	State<> state(buff, buff + TESTBUFF_SIZE);
+
+	state.AddPattern(
+		state
+		.PatternBuilder()
+		.setPattern(shortPattern)
+		.Build()
+	);
+
+	CHECK(Scan(state));
+
+	Pattern::Results expectedShort;
+	Light::Scan(buff, buff + TESTBUFF_SIZE, expectedShort, "0B ?2 0C");
+	CHECK(state["0B ?2 0C"].ResultsGet() == expectedShort);
+
+	// Many leading wildcards, vector loads must still stay within the padded pattern,
+	// whole byte values around the match, so reading past it would show
+
+	constexpr auto leadingWildcards = TBS_COMPILED_PATTERN("?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? 01 02 03 04 05 06 07 08 09 0A");
+
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte(seed >> 16);
+	}
+
+	memcpy(buff + 0x100, "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A", 10);
+	memcpy(buff + TESTBUFF_SIZE - 10, "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A", 10);
+
+	checkEquivalent(leadingWildcards, "?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? 01 02 03 04 05 06 07 08 09 0A");
+	checkSamePlan(leadingWildcards);
+}
+
+TEST_CASE("Padded Pattern Storage")
+{
+	Pattern::ParseResult parsed;
+	CHECK(Pattern::Parse("? ? 48 8B ?? 0? 05", parsed));
+
+	CHECK(parsed.IsPadded());
+	CHECK_EQ(parsed.getPaddedSize(), PATTERN_PADDING);
+	CHECK_EQ((UPtr)parsed.getPaddedPattern() % PATTERN_PADDING, 0);
+	CHECK_EQ((UPtr)parsed.getPaddedCompareMask() % PATTERN_PADDING, 0);
+	CHECK(memcmp(parsed.getPaddedPattern(), "\x48\x8B\x00\x00\x05", 5) == 0);
+	CHECK(memcmp(parsed.getPaddedCompareMask(), "\xFF\xFF\x00\xF0\xFF", 5) == 0);
+
+	for (size_t i = parsed.getTrimmedSize(); i < parsed.getPaddedSize(); i++)
+		CHECK_EQ(parsed.getPaddedCompareMask()[i], 0x00);
+
+	// Matches within a vector of the region end go through the tail compare,
+	// every region length must report the same as a naive search
+
+	UByte buff[96];
+	memset(buff, 0x48, sizeof(buff));
+
+	for (size_t i = 0; i + 5 <= sizeof(buff); i += 7)
+		memcpy(buff + i, "\x48\x8B\xAA\x0B\x05", 5);
+
+	for (size_t len = 0; len <= sizeof(buff); len++)
+	{
+		Pattern::Results expected, results;
+
+		for (size_t i = 0; i + parsed.getTrimmedSize() <= len; i++)
+		{
+			if (Memory::Compare(buff + i, parsed.getTrimmedPattern(), parsed.getTrimmedSize(), parsed.getTrimmedCompareMask()))
+				expected.push_back((Pattern::Result)(buff + i - parsed.mTrimmDisp));
+		}
+
+		Light::Scan(buff, buff + len, results, parsed);
+		CHECK(results == expected);
+	}
+}
+
+TEST_CASE("Skipping Scan")
+{
+	constexpr size_t TESTBUFF_SIZE = 0x10000;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x5EED;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte(seed >> 16);
+	}
+
+	// Long signatures, wildcards & nibbles within, planted a few times with the wildcarded parts varying
+
+	String<> patterns[3];
+
+	for (size_t p = 0; p < 3; p++)
+	{
+		const size_t len = 40 + p * 70;
+
+		for (size_t i = 0; i < len; i++)
+		{
+			char byteStr[4];
+			snprintf(byteStr, sizeof(byteStr), "%02X", buff[0x100 * (p + 1) + i]);
+
+			if (i)
+				patterns[p] += " ";
+
+			if (i % 23 == 5)
+				patterns[p] += "??";
+			else if (i % 31 == 7)
+				patterns[p] += String<>("?") + byteStr[1];
+			else
+				patterns[p] += byteStr;
+		}
+
+		for (size_t k = 1; k < 6; k++)
+		{
+			UByte* at = buff + k * (TESTBUFF_SIZE / 6) + p * 0x400;
+			memcpy(at, buff + 0x100 * (p + 1), len);
+			at[5] ^= 0x5A;
+			at[7] ^= 0x30;
+		}
+	}
+
+	// Run is the longest stretch without full byte wildcards
+
+	Pattern::ParseResult parsed;
+	CHECK(Pattern::Parse("11 22 ?? 33 ?4 55 66 77 88 99 AA BB CC DD EE FF 10 20 30 ?? 40", parsed));
+	CHECK_EQ(parsed.mPlan.mSkipStart, 3);
+	CHECK_EQ(parsed.mPlan.mSkipLen, 16);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0xFF], 3);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0x20], 1);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0x34], 14);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0xF4], 14);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0x33], 15);
+	CHECK_EQ(parsed.mPlan.mSkipShift[0x01], 16);
+
+	for (const auto& pattern : patterns)
+	{
+		CHECK(Pattern::Parse(pattern, parsed));
+
+		Pattern::Results expected;
+		for (size_t i = 0; i + parsed.mPattern.size() <= TESTBUFF_SIZE; i++)
+		{
+			if (Memory::Compare(buff + i, parsed.mPattern.data(), parsed.mPattern.size(), parsed.mCompareMask.data()))
+				expected.push_back((Pattern::Result)(buff + i));
+		}
+
+		CHECK_EQ(expected.size(), 6);
+
+		Pattern::Results results;
+
+		parsed.mPlan.mSkip = false;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, results, parsed);
+		CHECK(results == expected);
+
+		parsed.mPlan.mSkip = true;
+		Light::Scan(buff, buff + TESTBUFF_SIZE, results, parsed);
+		CHECK(results == expected);
+
+		Pattern::Result first = 0;
+		CHECK(Light::ScanOne(buff, buff + TESTBUFF_SIZE, first, parsed));
+		CHECK((expected.empty() || first == expected[0]));
+	}
+}
+
+TEST_CASE("Forced Kernels")
+{
+	constexpr size_t TESTBUFF_SIZE = 0x20000;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0xC0DE;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x1F);
+	}
+
+	// Short, nibble wildcarded, skip planned & multi pattern, same results whatever the kernel
+
+	const char* patterns[] = {
+		"01 02 ?3",
+		"?? 1A 0B ?? 0C",
+		"10 11 12 13 14 15 16 17 18 19 1A 1B 1C 1D 1E 1F 00 01",
+	};
+
+	memcpy(buff + 0x1234, "\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1A\x1B\x1C\x1D\x1E\x1F\x00\x01", 18);
+
+	CHECK(KernelAvailable(Kernel::Scalar));
+	CHECK_EQ(GetKernel(), Kernel::Auto);
+
+	Pattern::Results expected[3];
+
+	for (size_t i = 0; i < 3; i++)
+		CHECK(Light::Scan(buff, buff + TESTBUFF_SIZE, expected[i], patterns[i]));
+
+	const Kernel kernels[] = { Kernel::Scalar, Kernel::Platform, Kernel::SSE2, Kernel::AVX2 };
+
+	for (Kernel kernel : kernels)
+	{
+		if (!SetKernel(kernel))
+		{
+			CHECK_FALSE(KernelAvailable(kernel));
+			CHECK_EQ(GetKernel(), Kernel::Auto);
+			continue;
+		}
+
+		CHECK_EQ(GetKernel(), kernel);
+
+		// Resolved selection follows the forced kernel
+
+		CHECK_EQ(Dispatch::UseAVX2(), kernel == Kernel::AVX2);
+		CHECK_FALSE(Dispatch::UseAVX());
+		CHECK_EQ(Dispatch::UseSSE2(), kernel == Kernel::SSE2);
+		CHECK_EQ(Dispatch::UsePlatform(), kernel == Kernel::Platform);
+
+		for (size_t i = 0; i < 3; i++)
+		{
+			Pattern::Results results;
+			Light::Scan(buff, buff + TESTBUFF_SIZE, results, patterns[i]);
+
+			CHECK(results == expected[i]);
+		}
+
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern();
+
+		for (const char* pattern : patterns)
+			state.AddPattern(state.PatternBuilder().setUID(pattern).setPattern(pattern).Build());
+
+		CHECK(Scan(state));
+
+		for (size_t i = 0; i < 3; i++)
+			CHECK(state[patterns[i]].ResultsGet() == expected[i]);
+
+		CHECK(SetKernel(Kernel::Auto));
+	}
+
+#ifdef TBS_STATS
+	Stats::Reset();
+
+	Pattern::Results results;
+	Light::Scan(buff, buff + TESTBUFF_SIZE, results, patterns[2]);
+
+	const Stats::Counters counters = Stats::Get();
+
+	CHECK_EQ(counters.mMatches, results.size());
+	CHECK(counters.mCompares >= counters.mMatches);
+	CHECK(counters.mCandidates >= counters.mCompares);
+	CHECK(counters.mBytes >= TESTBUFF_SIZE - 17);
+#endif
+}
+
+TEST_CASE("Bulk Pattern Loading")
+{
+	Pattern::ParseResult res;
+
+	// Views need not be terminated, trailing spaces add no byte
+
+	CHECK(Pattern::Parse(StringView("AA B? CC", 5), res));
+	CHECK_EQ(res.mPattern.size(), 2);
+	CHECK(memcmp(res.mCompareMask.data(), "\xFF\xF0", 2) == 0);
+
+	CHECK(Pattern::Parse("  ?? ?5 DD  ", res));
+	CHECK_EQ(res.mPattern.size(), 3);
+	CHECK(memcmp(res.mPattern.data(), "\x00\x05\xDD", 3) == 0);
+	CHECK(memcmp(res.mCompareMask.data(), "\x00\x0F\xFF", 3) == 0);
+	CHECK_EQ(res.mTrimmDisp, 1);
+
+	// Reusing the result keeps its storage
+
+	const UByte* storage = res.mPattern.data();
+	CHECK(Pattern::Parse("11 22", res));
+	CHECK_EQ(res.mPattern.data(), storage);
+	CHECK_EQ(res.mTrimmDisp, 0);
+
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 2;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	memset(buff, 0, TESTBUFF_SIZE);
+	memcpy(buff + 0x100, "\x48\x8B\x05", 3);
+	memcpy(buff + PATTERN_SEARCH_SLICE_SIZE + 0x10, "\xE8\x11\x22", 3);
+
+	const Vector<Pattern::Source> sources = {
+		{ "Load", "48 8B 05" },
+		{ "Call", "E8 ?? 22" },
+		{ "", "DE AD" },
+		{ "Bad", "48 8B0 05" },
+		{ "NonHex", "48 8G 05" },
+	};
+
+	for (bool bMultiPattern : { false, true })
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern(bMultiPattern);
+
+		CHECK_EQ(state.AddPatterns(sources), 3);
+		CHECK_EQ(state.mDescriptionts.size(), 3);
+		CHECK_EQ(state.mSharedDescriptions.size(), 3);
+		CHECK(state.mSharedDescriptions.find("DE AD") != state.mSharedDescriptions.end());
+		CHECK(state.mSharedDescriptions.find("Bad") == state.mSharedDescriptions.end());
+		CHECK(state.mSharedDescriptions.find("NonHex") == state.mSharedDescriptions.end());
+
+		CHECK_FALSE(Scan(state));
+
+		CHECK_EQ((Pattern::Result)state["Load"], (Pattern::Result)(UPtr)(buff + 0x100));
+		CHECK_EQ((Pattern::Result)state["Call"], (Pattern::Result)(UPtr)(buff + PATTERN_SEARCH_SLICE_SIZE + 0x10));
+		CHECK(state["DE AD"].ResultsGet().empty());
+	}
+}
+
+TEST_CASE("Signature Database")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 3;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0xDB;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F);
+	}
+
+	struct Signature {
+		const char* mUID;
+		const char* mPattern;
+	};
+
+	const Signature signatures[] = {
+		{ "Pair", "01 02 ?? 03" },
+		{ "Byte", "05 ?? 0? 06" },
+		{ "Wild", "?? ?7 08 09" },
+		{ "Single", "0C" },
+		{ "Long", "0A 0B ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? ?? 0C" },
+		{ "Byte", "03 ?? 04" },
+	};
+
+	Database::Writer writer;
+
+	for (const Signature& signature : signatures)
+		CHECK(writer.Add(signature.mUID, signature.mPattern));
+
+	CHECK_FALSE(writer.Add("Invalid", "0AB"));
+	CHECK_EQ(writer.size(), 6);
+
+	const String<> path = "tbs_test.tbsdb";
+	REQUIRE(writer.Write(path));
+
+	Database::Reader reader;
+	REQUIRE(reader.Open(path));
+	REQUIRE_EQ(reader.size(), 6);
+
+	// Sorted by UID, repeated ones next to each other
+
+	CHECK_EQ(reader.UID(0), "Byte");
+	CHECK_EQ(reader.UID(1), "Byte");
+	CHECK_EQ(reader.Find("Byte"), 0);
+	CHECK_EQ(reader.UID(reader.Find("Wild")), "Wild");
+	CHECK_EQ(reader.Find("Missing"), Database::NOT_FOUND);
+
+	for (const Signature& signature : signatures)
+	{
+		Pattern::ParseResult expected;
+		REQUIRE(Pattern::Parse(signature.mPattern, expected));
+
+		bool bAnyEqual = false;
+
+		for (size_t i = reader.Find(signature.mUID); i < reader.size() && reader.UID(i) == signature.mUID; i++)
+		{
+			const Pattern::ParseResult stored = reader.ToParseResult(i);
+
+			bAnyEqual = bAnyEqual || (
+				stored.mPattern == expected.mPattern &&
+				stored.mCompareMask == expected.mCompareMask &&
+				stored.mTrimmDisp == expected.mTrimmDisp &&
+				stored.mPlan.mAnchor == expected.mPlan.mAnchor &&
+				stored.mPlan.mAnchor2 == expected.mPlan.mAnchor2 &&
+				stored.mPlan.mVerifyOrder == expected.mPlan.mVerifyOrder &&
+				stored.IsPadded());
+		}
+
+		CHECK(bAnyEqual);
+	}
+
+	// In place scan against the same signatures through a State
+
+	State<> state(buff, buff + TESTBUFF_SIZE);
+
+	for (const Signature& signature : signatures)
+		state.AddPattern(state.PatternBuilder().setUID(signature.mUID).setPattern(signature.mPattern).Build());
+
+	Scan(state);
+
+	std::map<String<>, std::set<Pattern::Result>> found;
+
+	CHECK(reader.Scan(buff, buff + TESTBUFF_SIZE, [&](size_t entry, Pattern::Result result) {
+		const StringView uid = reader.UID(entry);
+		found[String<>(uid.data(), uid.size())].insert(result);
+		return true;
+		}));
+
+	for (const char* uid : { "Pair", "Byte", "Wild", "Single", "Long" })
+	{
+		const Pattern::Results& expected = state[uid].ResultsGet();
+
+		CHECK_FALSE(expected.empty());
+		CHECK_EQ(found[uid], std::set<Pattern::Result>(expected.begin(), expected.end()));
+	}
+
+	State<> fromDatabase(buff, buff + TESTBUFF_SIZE);
+	reader.AddTo(fromDatabase).setMultiPattern();
+	Scan(fromDatabase);
+
+	for (const char* uid : { "Pair", "Byte", "Wild", "Single", "Long" })
+	{
+		Pattern::Results expected = state[uid].ResultsGet();
+		Pattern::Results results = fromDatabase[uid].ResultsGet();
+
+		std::sort(expected.begin(), expected.end());
+		std::sort(results.begin(), results.end());
+
+		CHECK_EQ(results, expected);
+	}
+
+	// Images get validated before use
+
+	Vector<UByte> image;
+	writer.Serialize(image);
+
+	struct alignas(Database::ALIGNMENT) Block {
+		UByte mBytes[Database::ALIGNMENT];
+	};
+
+	std::unique_ptr<Block[]> aligned(new Block[image.size() / sizeof(Block) + 1]);
+	UByte* copy = (UByte*)aligned.get();
+	memcpy(copy, image.data(), image.size());
+
+	Database::Reader inMemory;
+	CHECK(inMemory.Open(copy, image.size()));
+	CHECK_EQ(inMemory.size(), 6);
+	CHECK_FALSE(inMemory.Open(copy, image.size() - 1));
+	CHECK_FALSE(inMemory.Open(copy + 4, image.size() - 4));
+
+	((Database::Header*)copy)->mEntryCount = 1000;
+	CHECK_FALSE(inMemory.Open(copy, image.size()));
+
+	// Plans pointing outside their pattern
+
+	// Scalar skips over shorter runs than the vector kernels
+
+	REQUIRE(SetKernel(Kernel::Scalar));
+
+	Database::Writer skipWriter;
+	REQUIRE(skipWriter.Add("Run", "E1 E2 E3 E4 E5 E6 E7 E8 E9 EA EB EC ED EE EF F0"));
+
+	SetKernel(Kernel::Auto);
+
+	Vector<UByte> skipImage;
+	skipWriter.Serialize(skipImage);
+
+	std::unique_ptr<Block[]> skipAligned(new Block[skipImage.size() / sizeof(Block) + 1]);
+
+	const auto corrupted = [&inMemory](const Vector<UByte>& source, UByte* bytes, auto&& corrupt) {
+		memcpy(bytes, source.data(), source.size());
+		corrupt(*(Database::Entry*)(bytes + ((const Database::Header*)bytes)->mEntriesOffset), bytes);
+
+		return inMemory.Open(bytes, source.size());
+		};
+
+	UByte* skipCopy = (UByte*)skipAligned.get();
+
+	CHECK(corrupted(image, copy, [](Database::Entry&, UByte*) {}));
+	CHECK_FALSE(corrupted(image, copy, [](Database::Entry& entry, UByte*) { entry.mAnchor = entry.mSize; }));
+	CHECK_FALSE(corrupted(image, copy, [](Database::Entry& entry, UByte*) { entry.mAnchor2 = 0x7FFFFFFF; }));
+	CHECK_FALSE(corrupted(image, copy, [](Database::Entry& entry, UByte*) { entry.mVerifyOrderCount = entry.mSize + 1; }));
+	CHECK_FALSE(corrupted(image, copy, [](Database::Entry& entry, UByte* bytes) { ((U32*)(bytes + entry.mVerifyOrderOffset))[0] = entry.mSize; }));
+	CHECK_FALSE(corrupted(image, copy, [](Database::Entry& entry, UByte*) { entry.mTrimmDisp = ~U32(0); }));
+
+	// Matcher lists referring to missing entries
+
+	const auto matcherOf = [](UByte* bytes) -> Database::Matcher& {
+		return *(Database::Matcher*)(bytes + ((const Database::Header*)bytes)->mMatcherOffset);
+		};
+
+	CHECK_FALSE(corrupted(image, copy, [&](Database::Entry&, UByte* bytes) { matcherOf(bytes).mFingerprintLen = 4; }));
+	CHECK_FALSE(corrupted(image, copy, [&](Database::Entry&, UByte* bytes) { matcherOf(bytes).mBucketStarts[1] = 1000; }));
+	CHECK_FALSE(corrupted(image, copy, [&](Database::Entry&, UByte* bytes) { ((U32*)(bytes + matcherOf(bytes).mBucketEntriesOffset))[0] = 6; }));
+
+	CHECK(corrupted(skipImage, skipCopy, [](Database::Entry& entry, UByte*) { REQUIRE(entry.mSkip); }));
+	CHECK_FALSE(corrupted(skipImage, skipCopy, [](Database::Entry& entry, UByte*) { entry.mSkipStart = entry.mSize; }));
+	CHECK_FALSE(corrupted(skipImage, skipCopy, [](Database::Entry& entry, UByte*) { entry.mSkipLen = entry.mSize + 1; }));
+	CHECK_FALSE(corrupted(skipImage, skipCopy, [](Database::Entry& entry, UByte*) { entry.mSkipLen = 0; }));
+	CHECK_FALSE(corrupted(skipImage, skipCopy, [](Database::Entry& entry, UByte* bytes) { bytes[entry.mSkipShiftOffset + 0x42] = 0; }));
+
+	remove(path.c_str());
+}
+
+TEST_CASE("Incremental Rescan")
+{
+	constexpr size_t TESTBUFF_SIZE = PG_SIZE * 24 + 77;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x1AC;
+	auto next = [&seed] {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) & 0x7FFF;
+	};
+
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+		buff[i] = UByte(next() & 0x0F);
+
+	// Every kernel hashes the same, any byte changes it
+
+	for (size_t len : { (size_t)0, (size_t)1, (size_t)31, (size_t)32, (size_t)33, (size_t)PG_SIZE, TESTBUFF_SIZE })
+	{
+		const U64 expected = Memory::Hash(buff, len);
+
+		for (Kernel kernel : { Kernel::Scalar, Kernel::Platform, Kernel::SSE2, Kernel::AVX2 })
+		{
+			if (!SetKernel(kernel))
+				continue;
+
+			CHECK_EQ(Hash(buff, len), expected);
+		}
+
+		SetKernel(Kernel::Auto);
+	}
+
+	for (size_t at : { (size_t)0, (size_t)31, (size_t)1000, (size_t)PG_SIZE - 1 })
+	{
+		const U64 before = Hash(buff, PG_SIZE);
+		buff[at] ^= 0x40;
+		CHECK_NE(Hash(buff, PG_SIZE), before);
+		buff[at] ^= 0x40;
+		CHECK_EQ(Hash(buff, PG_SIZE), before);
+	}
+
+	// Stripes moved around change it too, whatever the kernel
+
+	for (size_t other : { (size_t)1, (size_t)7, (size_t)(PG_SIZE / 32 - 1) })
+	{
+		UByte swapped[PG_SIZE];
+		memcpy(swapped, buff, PG_SIZE);
+		std::swap_ranges(swapped, swapped + 32, swapped + other * 32);
+
+		for (Kernel kernel : { Kernel::Scalar, Kernel::SSE2, Kernel::AVX2 })
+		{
+			if (SetKernel(kernel))
+				CHECK_NE(Hash(swapped, PG_SIZE), Hash(buff, PG_SIZE));
+		}
+
+		SetKernel(Kernel::Auto);
+	}
+
+	const UByte dead[] = { 0xDE, 0xAD, 0x55, 0xBE, 0xEF };
+	const UByte cafe[] = { 0xCA, 0xFE };
+
+	auto addPatterns = [](State<>& state) {
+		state.AddPattern(state.PatternBuilder().setUID("Dead").setPattern("DE AD ?? BE EF").addOffset(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Cafe").setPattern("CA FE").stopOnFirstMatch().Build());
+	};
+
+	auto results = [](State<>& state, const char* uid) {
+		const Pattern::Results& res = state[uid].ResultsGet();
+		return std::vector<Pattern::Result>(res.begin(), res.end());
+	};
+
+	auto checkAgainstFull = [&](State<>& incremental) {
+		State<> full(buff, buff + TESTBUFF_SIZE);
+		addPatterns(full);
+
+		CHECK_EQ(Scan(incremental), Scan(full));
+		CHECK(results(incremental, "Dead") == results(full, "Dead"));
+		CHECK(results(incremental, "Cafe") == results(full, "Cafe"));
+	};
+
+	memcpy(buff + 100, dead, sizeof(dead));
+	memcpy(buff + PG_SIZE * 3 - 2, dead, sizeof(dead));	// Straddling pages
+	memcpy(buff + PG_SIZE * 10, cafe, sizeof(cafe));
+
+	State<> state(buff, buff + TESTBUFF_SIZE);
+	state.setIncremental();
+	addPatterns(state);
+
+	checkAgainstFull(state);
+	CHECK(results(state, "Dead") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + 101), (Pattern::Result)(buff + PG_SIZE * 3 - 1) });
+	CHECK_EQ(state.mDescriptionts.size(), 2);
+
+#ifdef TBS_STATS
+	const U64 firstBytes = state.GetStats().mTotal.mBytes;
+
+	CHECK_EQ(state.GetStats().mPagesHashed, 25);
+	CHECK_EQ(state.GetStats().mPagesDirty, 25);
+#endif
+
+	// Nothing changed, nothing searched
+
+	checkAgainstFull(state);
+
+#ifdef TBS_STATS
+	CHECK_EQ(state.GetStats().mTotal.mBytes, firstBytes);
+	CHECK_EQ(state.GetStats().mPagesHashed, 50);
+	CHECK_EQ(state.GetStats().mPagesDirty, 25);
+#endif
+
+	// Breaking a straddling match from its second page only
+
+	buff[PG_SIZE * 3 + 1] = 0x00;
+	checkAgainstFull(state);
+	CHECK_EQ(results(state, "Dead").size(), 1);
+
+#ifdef TBS_STATS
+	CHECK_EQ(state.GetStats().mPagesDirty, 26);
+	CHECK(state.GetStats().mTotal.mBytes - firstBytes <= 2 * (PG_SIZE + 2 * (sizeof(dead) - 1)));	// A page & its overlaps per description
+#endif
+
+	// Losing the first SCAN_FIRST match falls back to the next one, a lower one takes over
+
+	memcpy(buff + PG_SIZE * 20, cafe, sizeof(cafe));
+	checkAgainstFull(state);
+	CHECK(results(state, "Cafe") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + PG_SIZE * 10) });
+
+	buff[PG_SIZE * 10] = 0x00;
+	checkAgainstFull(state);
+	CHECK(results(state, "Cafe") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + PG_SIZE * 20) });
+
+	memcpy(buff + 5, cafe, sizeof(cafe));
+	checkAgainstFull(state);
+	CHECK(results(state, "Cafe") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + 5) });
+
+	// Random patching, matches planted & broken anywhere, range end included
+
+	for (size_t round = 0; round < 40; round++)
+	{
+		for (size_t edit = 0, edits = 1 + next() % 4; edit < edits; edit++)
+		{
+			const size_t at = (size_t)next() * (size_t)next() % (TESTBUFF_SIZE - sizeof(dead) + 1);
+
+			if (next() % 3 == 0)
+				buff[at] = UByte(next() & 0x0F);
+			else if (next() % 2)
+				memcpy(buff + at, dead, sizeof(dead));
+			else
+				memcpy(buff + at, cafe, sizeof(cafe));
+		}
+
+		checkAgainstFull(state);
+	}
+
+	// Patterns added since get searched whole, resetting searches everything again
+
+	state.AddPattern(state.PatternBuilder().setUID("Nibbles").setPattern("0? 0? 0F 0F 0F").Build());
+
+	State<> full(buff, buff + TESTBUFF_SIZE);
+	full.AddPattern(full.PatternBuilder().setUID("Nibbles").setPattern("0? 0? 0F 0F 0F").Build());
+	Scan(full);
+
+	Scan(state);
+	CHECK(results(state, "Nibbles") == results(full, "Nibbles"));
+
+	const auto deadBefore = results(state, "Dead");
+	state.ResetIncremental();
+	Scan(state);
+	CHECK(results(state, "Dead") == deadBefore);
+
+	// Swapping two stripes of a page moves a match within it
+
+	const UByte beef[] = { 0xB0, 0x0B, 0xBE, 0xEF };
+	memset(buff + PG_SIZE * 22, 0, PG_SIZE);
+	memcpy(buff + PG_SIZE * 22 + 4, beef, sizeof(beef));
+
+	State<> swapped(buff, buff + TESTBUFF_SIZE);
+	swapped.setIncremental();
+	swapped.AddPattern(swapped.PatternBuilder().setUID("Beef").setPattern("B0 0B BE EF").Build());
+	Scan(swapped);
+	CHECK(results(swapped, "Beef") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + PG_SIZE * 22 + 4) });
+
+	std::swap_ranges(buff + PG_SIZE * 22, buff + PG_SIZE * 22 + 32, buff + PG_SIZE * 22 + 64);
+	Scan(swapped);
+	CHECK(results(swapped, "Beef") == std::vector<Pattern::Result>{ (Pattern::Result)(buff + PG_SIZE * 22 + 68) });
+
+	// Transformers reading another page see its latest content, the match page untouched
+
+	UByte* const pointee = buff + PG_SIZE * 2;
+
+	State<> deref(buff + PG_SIZE * 22, buff + PG_SIZE * 23);
+	deref.setIncremental();
+	deref.AddPattern(deref.PatternBuilder().setUID("Beef").setPattern("B0 0B BE EF").AddTransformer([pointee](Pattern::Description&, Pattern::Result) {
+		return (Pattern::Result)*pointee;
+		}).Build());
+
+	*pointee = 0x11;
+	Scan(deref);
+	CHECK(results(deref, "Beef") == std::vector<Pattern::Result>{ 0x11 });
+
+	*pointee = 0x22;
+	Scan(deref);
+	CHECK(results(deref, "Beef") == std::vector<Pattern::Result>{ 0x22 });
+}
+
+TEST_CASE("Reusable State")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 4;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x2E5;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F);
+	}
+
+	const UByte dead[] = { 0xDE, 0xAD, 0xBE, 0xEF };
+	const size_t deadAt[] = { 10, PATTERN_SEARCH_SLICE_SIZE - 2, PATTERN_SEARCH_SLICE_SIZE * 2 + 7, TESTBUFF_SIZE - sizeof(dead) };
+
+	for (size_t at : deadAt)
+		memcpy(buff + at, dead, sizeof(dead));
+
+	auto results = [](const Pattern::SharedResultAccesor& accesor) {
+		const Pattern::Results& res = accesor.ResultsGet();
+		return std::vector<Pattern::Result>(res.begin(), res.end());
+	};
+
+	std::vector<Pattern::Result> expectedDead, expectedFirst;
+
+	for (size_t at : deadAt)
+		expectedDead.push_back((Pattern::Result)(buff + at + 1));
+
+	expectedFirst.push_back((Pattern::Result)(buff + deadAt[0]));
+
+	for (bool bMultiPattern : { false, true })
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setReusable().setMultiPattern(bMultiPattern);
+
+		state.AddPattern(state.PatternBuilder().setUID("Dead").setPattern("DE AD BE EF").addOffset(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("First").setPattern("DE AD ?? EF").stopOnFirstMatch().Build());
+
+		// Scanned twice in place, accumulating until reset
+
+		CHECK(Scan(state));
+		CHECK(results(state["Dead"]) == expectedDead);
+		CHECK(results(state["First"]) == expectedFirst);
+
+		CHECK(Scan(state));
+		CHECK_EQ(results(state["Dead"]).size(), expectedDead.size() * 2);
+		CHECK(results(state["First"]) == expectedFirst);
+
+		state.ResetResults();
+		CHECK(results(state["Dead"]).empty());
+
+		CHECK(Scan(state));
+		CHECK(results(state["Dead"]) == expectedDead);
+		CHECK_EQ(state.mDescriptionts.size(), 2);
+
+#ifdef TBS_STATS
+		CHECK_EQ(state.GetStats().mGroupsCompiled, bMultiPattern ? 1 : 0);	// Kept compiled across scans
+#endif
+
+		// Separate results, the State ones stay as they are
+
+		State<>::ScanResults separate(state);
+
+		CHECK(Scan(state, separate));
+		CHECK(results(separate["Dead"]) == expectedDead);
+		CHECK(results(separate["First"]) == expectedFirst);
+		CHECK(results(separate["Unknown"]).empty());
+		CHECK(results(state["Dead"]) == expectedDead);
+
+		CHECK(Scan(state, separate));
+		CHECK_EQ(results(separate["Dead"]).size(), expectedDead.size() * 2);
+
+		// Other ranges, boundaries included
+
+		separate.Reset();
+		CHECK(Scan(state, separate, buff + PATTERN_SEARCH_SLICE_SIZE, buff + TESTBUFF_SIZE));
+		CHECK(results(separate["Dead"]) == std::vector<Pattern::Result>(expectedDead.begin() + 2, expectedDead.end()));
+		CHECK(results(separate["First"]) == std::vector<Pattern::Result>{ (Pattern::Result)(buff + deadAt[2]) });
+
+		separate.Reset();
+		CHECK_FALSE(Scan(state, separate, buff + 11, buff + PATTERN_SEARCH_SLICE_SIZE + 1));
+		CHECK(results(separate["Dead"]).empty());
+
+		separate.Reset();
+		CHECK(Scan(state, separate, buff, buff + PATTERN_SEARCH_SLICE_SIZE + 2));
+		CHECK(results(separate["Dead"]) == std::vector<Pattern::Result>(expectedDead.begin(), expectedDead.begin() + 2));
+
+		separate.Reset();
+		CHECK(Scan(state, separate, buff + PATTERN_SEARCH_SLICE_SIZE, buff + TESTBUFF_SIZE));
+		CHECK(results(separate["Dead"]) == std::vector<Pattern::Result>(expectedDead.begin() + 2, expectedDead.end()));
+
+#ifdef TBS_STATS
+		CHECK_EQ(state.GetStats().mGroupsCompiled, bMultiPattern ? 4 : 0);	// One per range
+#endif
+
+		// Patterns added after a scan get their own results too
+
+		state.AddPattern(state.PatternBuilder().setUID("Beef").setPattern("BE EF").Build());
+
+		separate.Reset();
+		CHECK(Scan(state, separate));
+		CHECK_EQ(results(separate["Beef"]).size(), expectedDead.size());
+
+		// Concurrent scans, each into its own results
+
+		std::vector<std::unique_ptr<State<>::ScanResults>> perThread;
+		std::vector<std::thread> threads;
+		std::atomic<size_t> mismatches(0);
+
+		for (size_t t = 0; t < 4; t++)
+			perThread.emplace_back(new State<>::ScanResults(state));
+
+		for (size_t t = 0; t < 4; t++)
+		{
+			threads.emplace_back([&, t] {
+				for (size_t round = 0; round < 8; round++)
+				{
+					State<>::ScanResults& mine = perThread[t]->Reset();
+
+					if (!Scan(state, mine) || results(mine["Dead"]) != expectedDead || results(mine["First"]) != expectedFirst)
+						mismatches++;
+				}
+				});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		CHECK_EQ(mismatches.load(), 0);
+		CHECK(results(state["Dead"]) == expectedDead);
+
+#ifdef TBS_STATS
+		CHECK_EQ(state.GetStats().mGroupsCompiled, bMultiPattern ? 5 : 0);	// Recompiled once with the new pattern
+#endif
+	}
+}
+
+TEST_CASE("Result Steps & Batch Transformers")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 3;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	memset(buff, 0xCC, TESTBUFF_SIZE);
+
+	const UByte call[] = { 0xE8, 0x50, 0x00, 0x00, 0x00 };						// call +0x50
+	const UByte movRip[] = { 0x48, 0x8B, 0x05, 0x00, 0xFF, 0xFF, 0xFF };		// mov rax, [rip-0x100]
+	const UByte jmpShort[] = { 0xEB, 0xFE };									// jmp $
+	const UByte movField[] = { 0x48, 0x8B, 0x81, 0xA8, 0x01, 0x00, 0x00 };	// mov rax, [rcx+0x1A8]
+	const UByte movStack[] = { 0x8B, 0x44, 0x24, 0x18 };						// mov eax, [rsp+0x18]
+	const UByte movLocal[] = { 0x8B, 0x45, 0xF8 };								// mov eax, [rbp-8]
+	const UByte ptrTag[] = { 0x11, 0x22, 0x33, 0x44 };
+
+	memcpy(buff + 0x100, call, sizeof(call));
+	memcpy(buff + PATTERN_SEARCH_SLICE_SIZE + 0x200, movRip, sizeof(movRip));
+	memcpy(buff + 0x300, jmpShort, sizeof(jmpShort));
+	memcpy(buff + 0x400, movField, sizeof(movField));
+	memcpy(buff + 0x500, movStack, sizeof(movStack));
+	memcpy(buff + 0x600, movLocal, sizeof(movLocal));
+	memcpy(buff + 0x700, ptrTag, sizeof(ptrTag));
+
+	const Pattern::Result pointee = (Pattern::Result)(UPtr)(buff + 0x10);
+	memcpy(buff + 0x704, &pointee, sizeof(pointee));
+
+	for (bool bMultiPattern : { false, true })
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern(bMultiPattern);
+
+		size_t batchCount = 0;
+
+		state.AddPattern(state.PatternBuilder().setUID("Call").setPattern("E8 ?? ?? ?? ?? CC").resolveRel32(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Rip").setPattern("48 8B 05 ?? ?? ?? ??").resolveRel32(3).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Jmp").setPattern("EB ??").resolveRel8(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Field").setPattern("48 8B 81").modRMDisp(2).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Stack").setPattern("8B 44 24").modRMDisp(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Local").setPattern("8B 45 F8").modRMDisp(1).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Deref").setPattern("11 22 33 44").addOffset(4).deref().addOffset(-0x10)
+			.AddBatchTransformer([&batchCount](Pattern::Result* results, size_t count) {
+				batchCount += count;
+
+				for (size_t i = 0; i < count; i++)
+					results[i] += 1;
+			}).Build());
+
+		CHECK(Scan(state));
+
+		CHECK_EQ((Pattern::Result)state["Call"], (Pattern::Result)(UPtr)(buff + 0x100 + 5 + 0x50));
+		CHECK_EQ((Pattern::Result)state["Rip"], (Pattern::Result)(UPtr)(buff + PATTERN_SEARCH_SLICE_SIZE + 0x200 + 7 - 0x100));
+		CHECK_EQ((Pattern::Result)state["Jmp"], (Pattern::Result)(UPtr)(buff + 0x300));
+		CHECK_EQ((Pattern::Result)state["Field"], 0x1A8);
+		CHECK_EQ((Pattern::Result)state["Stack"], 0x18);
+		CHECK_EQ((Pattern::Result)state["Local"], (Pattern::Result)-8);
+		CHECK_EQ((Pattern::Result)state["Deref"], (Pattern::Result)(UPtr)buff + 1);
+		CHECK_EQ(batchCount, 1);
+
+		// Results of a previous Scan are never transformed twice
+
+		state.AddPattern(state.PatternBuilder().setUID("Deref").setPattern("11 22 33 44").Build());
+		CHECK(Scan(state));
+
+		CHECK_EQ(batchCount, 2);
+		REQUIRE_EQ(state["Deref"].ResultsGet().size(), 2);
+		CHECK_EQ(state["Deref"].ResultsGet()[0], state["Deref"].ResultsGet()[1]);
+	}
+
+	Pattern::Result results[] = { (Pattern::Result)(UPtr)(buff + 0x400), (Pattern::Result)(UPtr)(buff + 0x4FF) };
+	Pattern::ApplySteps({ Pattern::ResultStep::Add(1), Pattern::ResultStep::ModRMDisp(1) }, results, 2);
+
+	CHECK_EQ(results[0], 0x1A8);
+	CHECK_EQ(results[1], 0x18);
+}
+
+#ifdef TBS_STATS
+TEST_CASE("Scan Statistics")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 6;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x57A7;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F);
+	}
+
+	for (bool bMultiPattern : { false, true })
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern(bMultiPattern);
+
+		state.AddPattern(state.PatternBuilder().setUID("Common").setPattern("01 02").Build());
+		state.AddPattern(state.PatternBuilder().setUID("Transformed").setPattern("0A 0B 0C")
+			.AddTransformer([](Pattern::Description&, Pattern::Result res) { return res + 1; }).Build());
+		state.AddPattern(state.PatternBuilder().setUID("Missing").setPattern("FF FF").Build());
+
+		CHECK_FALSE(Scan(state));
+
+		const Stats::StateStats& stats = state.GetStats();
+		const auto& common = state.GetStats("Common");
+		const auto& missing = state.GetStats("Missing");
+
+		CHECK_EQ(stats.mScans, 1);
+		CHECK(stats.mScanNs > 0);
+		CHECK(stats.mSlices >= 6);
+		CHECK(stats.mTotal.mBytes >= TESTBUFF_SIZE);
+		CHECK(stats.mTotal.mCandidates >= stats.mTotal.mMatches);
+		CHECK(stats.mTotal.mTransformNs > 0);
+
+		CHECK_EQ(common.mMatches, state["Common"].ResultsGet().size());
+		CHECK_EQ(state.GetStats("Transformed").mMatches, state["Transformed"].ResultsGet().size());
+		CHECK_EQ(missing.mMatches, 0);
+		CHECK(common.mBytes >= TESTBUFF_SIZE);
+		CHECK_EQ(common.mSlices, 6);
+
+		if (!bMultiPattern)
+		{
+			CHECK(common.mCandidates >= common.mMatches);
+			CHECK(common.mCompares >= common.mMatches);
+			CHECK(state.GetStats("Transformed").mTransformNs > 0);
+		}
+
+		U64 tasks = 0;
+
+		for (const auto& worker : stats.mWorkers)
+			tasks += worker.mTasks;
+
+		CHECK_EQ(tasks, stats.mSlices);
+		CHECK_EQ(state.GetStats("Unknown").mSlices, 0);
+
+		state.ResetStats();
+
+		CHECK_EQ(state.GetStats().mScans, 0);
+		CHECK_EQ(state.GetStats("Common").mMatches, 0);
+	}
+}
+#endif
+
+#ifdef TBS_TRACE
+TEST_CASE("Scan Trace")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 4;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	memset(buff, 0, TESTBUFF_SIZE);
+
+	const String<> previousOutput = Trace::GetOutput();
+	const String<> output = "tbs_test_trace.json";
+
+	Trace::SetOutput(output);
+
+	for (bool bMultiPattern : { false, true })
+	{
+		State<> state(buff, buff + TESTBUFF_SIZE);
+		state.setMultiPattern(bMultiPattern);
+
+		state.AddPattern(state.PatternBuilder().setUID("Quoted \"UID\"").setPattern("01 02").Build());
+		state.AddPattern(state.PatternBuilder().setUID("Other").setPattern("03 04").Build());
+
+		Scan(state);
+
+		FILE* file = fopen(output.c_str(), "rb");
+		REQUIRE(file != nullptr);
+
+		std::string json;
+		char chunk[4096];
+
+		for (size_t read; (read = fread(chunk, 1, sizeof(chunk), file)) > 0; )
+			json.append(chunk, read);
+
+		fclose(file);
+
+		CHECK(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+		CHECK(json.find("\"thread_name\"") != std::string::npos);
+		CHECK(json.find("\"name\":\"Scan\"") != std::string::npos);
+		CHECK(json.find("\"name\":\"Merge\"") != std::string::npos);
+		CHECK(json.find("\"name\":\"Quoted \\\"UID\\\"\"") != std::string::npos);
+		CHECK(json.find(bMultiPattern ? "\"cat\":\"group\"" : "\"cat\":\"chunk\"") != std::string::npos);
+		CHECK(json.find("\"bytes\":40960") != std::string::npos);
+		CHECK(json.find("\"droppedEvents\":0}}") != std::string::npos);
+
+		// Every Scan flushes, the previous one's events are gone
+
+		CHECK((json.find("\"cat\":\"chunk\"") == std::string::npos) == bMultiPattern);
+	}
+
+	remove(output.c_str());
+	Trace::SetOutput(previousOutput);
+}
+#endif
+
+#ifdef TBS_MT
+TEST_CASE("Work Stealing Thread Pool")
+{
+	struct CountTask : Thread::TaskOf<CountTask> {
+		inline void Run()
+		{
+			mCounter->fetch_add(mValue);
+		}
+
+		std::atomic<U64>* mCounter;
+		U64 mValue;
+	};
+
+	// More tasks than a deque holds, so the submitter has to help while pushing
+
+	constexpr size_t TASKS = 10000;
+	Vector<CountTask> tasks(TASKS);
+	std::atomic<U64> counter(0);
+
+	for (size_t i = 0; i < TASKS; i++)
+	{
+		tasks[i].mCounter = &counter;
+		tasks[i].mValue = i + 1;
+	}
+
+	Thread::Pool pool(4);
+	CHECK_EQ(pool.WorkerCount(), 4);
+
+	for (int round = 0; round < 10; round++)
+	{
+		counter = 0;
+		pool.Run(tasks.data(), tasks.size());
+		CHECK_EQ(counter.load(), U64(TASKS * (TASKS + 1) / 2));
+	}
+
+	// Several submitters at once, plus nested submissions from inside tasks
+
+	struct NestingTask : Thread::TaskOf<NestingTask> {
+		inline void Run()
+		{
+			mPool->Run(mInner, 8);
+		}
+
+		Thread::Pool* mPool;
+		CountTask* mInner;
+	};
+
+	counter = 0;
+
+	Vector<NestingTask> nesting(64);
+	Vector<CountTask> inner(64 * 8);
+
+	for (size_t i = 0; i < inner.size(); i++)
+	{
+		inner[i].mCounter = &counter;
+		inner[i].mValue = 1;
+	}
+
+	for (size_t i = 0; i < nesting.size(); i++)
+	{
+		nesting[i].mPool = &pool;
+		nesting[i].mInner = &inner[i * 8];
+	}
+
+	Vector<CountTask> perSubmitter[3] = { tasks, tasks, tasks };
+	std::thread submitters[3];
+
+	for (size_t i = 0; i < 3; i++)
+		submitters[i] = std::thread([&pool, &perSubmitter, i] { pool.Run(perSubmitter[i].data(), perSubmitter[i].size()); });
+
+	pool.Run(nesting.data(), nesting.size());
+
+	for (auto& submitter : submitters)
+		submitter.join();
+
+	CHECK_EQ(counter.load(), U64(3 * TASKS * (TASKS + 1) / 2 + 64 * 8));
+}
+#endif
+
+TEST_CASE("Partitioned Scan")
+{
+	// One pattern over many chunks, planted straddling every chunk boundary at every possible offset
+
+	constexpr size_t CHUNKS = 16;
+	constexpr auto TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * CHUNKS;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	memset(buff, 0x00, TESTBUFF_SIZE);
+
+	const UByte needle[] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+	for (size_t chunk = 1; chunk < CHUNKS; chunk++)
+	{
+		const size_t delta = chunk % sizeof(needle);
+		memcpy(buff + chunk * PATTERN_SEARCH_SLICE_SIZE - delta, needle, sizeof(needle));
+	}
+
+	memcpy(buff, needle, sizeof(needle));
+	memcpy(buff + TESTBUFF_SIZE - sizeof(needle), needle, sizeof(needle));
+
+	State<> state(buff, buff + TESTBUFF_SIZE);
+
+	state.AddPattern(
+		state
+		.PatternBuilder()
+		.setUID("Needle")
+		.setPattern("? 22 33 ? 55 66")
+		.Build()
+	);
+
+	CHECK(Scan(state));
+
+	Pattern::Results expected;
+	Light::Scan(buff, buff + TESTBUFF_SIZE, expected, "? 22 33 ? 55 66");
+	CHECK_EQ(expected.size(), CHUNKS + 1);
+
+	CHECK(state["Needle"].ResultsGet() == expected); // Merged in address order
+}
+
+TEST_CASE("Merged Results")
+{
+	// Same UID over overlapping ranges, overlap matches are expected once, all of them address sorted
+
+	constexpr auto TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 8;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x5EED;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte(seed >> 16);
+	}
+
+	const char* pattern = "E8 ? ? ? ?";
+
+	Pattern::Results expected;
+	Light::Scan(buff, buff + TESTBUFF_SIZE, expected, pattern);
+	CHECK(expected.size() > 100);
+
+	for (int round = 0; round < 3; round++)
+	{
+		State<> state;
+
+		auto builder = state
+			.PatternBuilder()
+			.setUID("Calls")
+			.setPattern(pattern);
+
+		state.AddPattern(builder.Clone().setScanStart(buff + TESTBUFF_SIZE / 4).setScanEnd(buff + TESTBUFF_SIZE).Build());
+		state.AddPattern(builder.Clone().setScanStart(buff).setScanEnd(buff + TESTBUFF_SIZE * 3 / 4).Build());
+
+		if (round == 2)
+			state.setMultiPattern();
+
+		CHECK(Scan(state));
+		CHECK(state["Calls"].ResultsGet() == expected);
+	}
+}
+
+TEST_CASE("Lowest Address Scan First")
+{
+	constexpr size_t CHUNKS = 32;
+	constexpr auto TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * CHUNKS;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	memset(buff, 0x00, TESTBUFF_SIZE);
+
+	// Lowest one planted in the middle, plenty of higher ones all around
+
+	for (size_t chunk = 7; chunk < CHUNKS; chunk += 2)
+		memcpy(buff + chunk * PATTERN_SEARCH_SLICE_SIZE + 100, "\xAB\xCD\xEF", 3);
+
+	memcpy(buff + PATTERN_SEARCH_SLICE_SIZE * 7 + 50, "\xAB\xCD\xEF", 3);
+
+	for (int multiPattern = 0; multiPattern < 2; multiPattern++)
+	{
+		for (int round = 0; round < 20; round++)
+		{
+			static std::atomic<int> transforms;
+			transforms = 0;
+
+			State<> state(buff, buff + TESTBUFF_SIZE);
+			state.setMultiPattern(multiPattern != 0);
+
+			state.AddPattern(
+				state
+				.PatternBuilder()
+				.setUID("First")
+				.setPattern("AB CD EF")
+				.stopOnFirstMatch()
+				.AddTransformer([](Pattern::Description&, U64 res) -> U64 {
+					transforms++;
+					return res;
+					})
+				.Build()
+			);
+
+			CHECK(Scan(state));
+			CHECK_EQ(state["First"].ResultsGet().size(), 1);
+			CHECK_EQ((UByte*)(Pattern::Result)state["First"], buff + PATTERN_SEARCH_SLICE_SIZE * 7 + 50);
+
+#ifndef TBS_MT
+			// Chunks above the first match are never scanned
+			CHECK_EQ(transforms.load(), 1);
+#endif
+		}
+	}
+}
+
+TEST_CASE("Region Provider Scan")
+{
+	// In memory provider, 3 blocks long with an unreadable page within the 2nd block
+
+	struct TestProvider : Process::RegionProvider {
+		TestProvider()
+			: mBytes(Process::BLOCK_SIZE * 3, 0x00)
+			, mUnreadable(0x40000000 + Process::BLOCK_SIZE + PG_SIZE * 7)
+		{}
+
+		bool Regions(Vector<Process::Region>& regions) override
+		{
+			regions.push_back({ 0x10000000, 0x10001000, Process::Region::READ | Process::Region::EXEC, "/lib/other.so" });
+			regions.push_back({ 0x40000000, 0x40000000 + mBytes.size(), Process::Region::READ | Process::Region::WRITE, "[heap]" });
+			return true;
+		}
+
+		size_t Read(UPtr address, UByte* out, size_t len) override
+		{
+			if (address < 0x40000000)
+				return 0;
+
+			size_t read = 0;
+
+			for (; read < len && address + read != mUnreadable; read++)
+				out[read] = mBytes[address + read - 0x40000000];
+
+			return read;
+		}
+
+		std::vector<UByte> mBytes;
+		UPtr mUnreadable;
+	} provider;
+
+	auto plant = [&provider](size_t at) {
+		memcpy(provider.mBytes.data() + at, "\xDE\xAD\xBE\xEF\x13\x37", 6);
+		return (Pattern::Result)(0x40000000 + at);
+		};
+
+	Pattern::Results expected = {
+		plant(0x100),
+		plant(Process::BLOCK_SIZE - 3), // Straddles 1st & 2nd block
+		plant(Process::BLOCK_SIZE * 2 - 2), // Straddles 2nd & 3rd block
+		plant(Process::BLOCK_SIZE * 3 - 6),
+	};
+
+	plant(Process::BLOCK_SIZE + PG_SIZE * 7 - 2); // Straddles the unreadable page, never reported
+
+	Pattern::Results results;
+	CHECK(Process::Scan(provider, Process::RegionFilter().setModule("heap"), results, "DE AD BE EF 13 37"));
+	CHECK(results == expected);
+
+	CHECK_FALSE(Process::Scan(provider, Process::RegionFilter().setProt(Process::Region::EXEC), results, "DE AD BE EF 13 37"));
+
+	// Ranges clamp the regions, matches crossing the range bounds arent reported
+
+	CHECK(Process::Scan(provider, Process::RegionFilter().setRange(expected[1] + 1, expected[3] + 6), results, "DE AD BE EF 13 37"));
+	CHECK(results == Pattern::Results{ expected[2], expected[3] });
+
+	CHECK(Process::Scan(provider, Process::RegionFilter().setRange(expected[0], expected[2] + 5), results, "DE AD BE EF 13 37"));
+	CHECK(results == Pattern::Results{ expected[0], expected[1] });
+
+	Pattern::ParseResult parsed;
+	CHECK(Pattern::Parse("? DE AD ? EF", parsed));
+	Pattern::Result first = 0;
+	CHECK(Process::ScanOne(provider, Process::RegionFilter(), first, parsed));
+	CHECK_EQ(first, 0x40000000 + 0x100 - 1);
+}
+
+#if defined(__linux__)
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE("Linux Process Scan")
+{
+	// Only the child writes the signature, parent memory never holds it
+
+	std::vector<UByte> buffer(PG_SIZE * 64, 0x00);
+	const UByte* target = buffer.data() + PG_SIZE * 40 + 13;
+	int ready[2];
+	REQUIRE(pipe(ready) == 0);
+
+	pid_t child = fork();
+	REQUIRE(child >= 0);
+
+	if (child == 0)
+	{
+		const UByte key[] = { 0x95, 0xAA, 0xBB, 0x40, 0x35, 0x58 };
+
+		for (size_t i = 0; i < sizeof(key); i++)
+			buffer[target - buffer.data() + i] = key[i] ^ 0x55;
+
+		write(ready[1], "R", 1);
+		pause();
+		_exit(0);
+	}
+
+	char signal = 0;
+	CHECK(read(ready[0], &signal, 1) == 1);
+
+	Process::LinuxProvider provider(child);
+	Pattern::Results results;
+
+	// Bounded to the buffer, whole address space scans would walk sanitizer shadow mappings
+
+	Process::RegionFilter filter;
+	filter.setProt(Process::Region::READ | Process::Region::WRITE).setRange(buffer.data(), buffer.data() + buffer.size());
+
+	CHECK(Process::Scan(provider, filter, results, "C0 FF EE 15 60 0D"));
+	CHECK(results == Pattern::Results{ (Pattern::Result)target });
+
+	CHECK_FALSE(Process::Scan(provider, filter.setProt(Process::Region::EXEC), results, "C0 FF EE 15 60 0D"));
+
+	Pattern::Results local;
+	CHECK_FALSE(Light::Scan(buffer.data(), buffer.data() + buffer.size(), local, "C0 FF EE 15 60 0D"));
+
+	kill(child, SIGKILL);
+	waitpid(child, nullptr, 0);
+	close(ready[0]);
+	close(ready[1]);
+}
+TEST_CASE("Safe Self Scan")
+{
+	// Unreadable page in the middle of the scanned range
+
+	UByte* pages = (UByte*)mmap(nullptr, PG_SIZE * 3, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	REQUIRE(pages != MAP_FAILED);
+
+	memset(pages, 0x00, PG_SIZE * 3);
+	memcpy(pages + 0x10, "\x7A\x11\x7A\x22", 4);
+	memcpy(pages + PG_SIZE * 2 + 0x20, "\x7A\x11\x7A\x22", 4);
+	REQUIRE(mprotect(pages + PG_SIZE, PG_SIZE, PROT_NONE) == 0);
+
+	Process::Self::Instance().Refresh();
+
+	for (int multiPattern = 0; multiPattern < 2; multiPattern++)
+	{
+		State<> state(pages, pages + PG_SIZE * 3);
+		state.setSafeScan().setMultiPattern(multiPattern != 0);
+
+		state.AddPattern(
+			state
+			.PatternBuilder()
+			.setPattern("7A 11 7A 22")
+			.Build()
+		);
+
+		CHECK(Scan(state));
+		CHECK(state["7A 11 7A 22"].ResultsGet() == Pattern::Results{ (Pattern::Result)(pages + 0x10), (Pattern::Result)(pages + PG_SIZE * 2 + 0x20) });
+	}
+
+#if !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+	// Whole address space in a single State, sanitizer shadow mappings would take too long
+
+	std::vector<UByte> buffer(0x100, 0x00);
+	for (size_t i = 0; i < 6; i++)
+		buffer[0x40 + i] = UByte(0x90 + i * 0x11);
+
+	State<> state(nullptr, (void*)~UPtr(0));
+	state.setSafeScan();
+
+	state.AddPattern(
+		state
+		.PatternBuilder()
+		.setUID("Whole")
+		.setPattern("90 A1 B2 C3 D4 E5")
+		.Build()
+	);
+
+	CHECK(Scan(state));
+
+	const auto& results = state["Whole"].ResultsGet();
+	CHECK(std::find(results.begin(), results.end(), (Pattern::Result)(buffer.data() + 0x40)) != results.end());
+#endif
+
+	// Unmapped since the spans got cached, no Refresh()
+
+	munmap(pages, PG_SIZE * 3);
+
+	{
+		State<> state(pages, pages + PG_SIZE * 3);
+		state.setSafeScan();
+
+		state.AddPattern(
+			state
+			.PatternBuilder()
+			.setPattern("7A 11 7A 22")
+			.Build()
+		);
+
+		CHECK_FALSE(Scan(state));
+		CHECK(state["7A 11 7A 22"].ResultsGet().empty());
+	}
+
+	Process::Self::Instance().Refresh();
+}
+#endif
+
+TEST_CASE("Stream Scanner")
+{
+	constexpr size_t TESTBUFF_SIZE = PATTERN_SEARCH_SLICE_SIZE * 12;
+	std::unique_ptr<UByte[]> buffSmart = std::make_unique<UByte[]>(TESTBUFF_SIZE);
+	auto buff = buffSmart.get();
+
+	U32 seed = 0x57AE;
+	for (size_t i = 0; i < TESTBUFF_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buff[i] = UByte((seed >> 16) & 0x0F);
+	}
+
+	memcpy(buff, "\x01\x02\x03", 3); // Leading wildcard match would start before the stream
+
+	const char* patterns[] = {
+		"? 01 02 03",
+		"0A 0B ? 0C 0D",
+		"0? 05 06 07 ?8 09 0A 0B 0C 0D 0E",
+		"? ? ? ? ? ? ? ? ? ? ? ? ? ? ? ? 0A 0B ? 0C 0D", // Same trimmed hits as [1], reported 16 earlier
+	};
+
+	Pattern::Results expected[4];
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		Light::Scan(buff, buff + TESTBUFF_SIZE, expected[i], patterns[i]);
+
+		expected[i].erase(std::remove_if(expected[i].begin(), expected[i].end(), [buff](Pattern::Result found) {
+			return found < (Pattern::Result)buff;
+			}), expected[i].end());
+
+		for (auto& found : expected[i])
+			found -= (Pattern::Result)buff;
+	}
+
+	CHECK_FALSE(expected[0].empty());
+	CHECK_FALSE(expected[1].empty());
+
+	// Single & multi pattern, tiny pieces straddling everything & big ones split in slices
+
+	for (size_t count = 1; count <= 4; count += 3)
+	{
+		StreamScanner scanner;
+
+		for (size_t i = 0; i < count; i++)
+			CHECK_EQ(scanner.AddPattern(patterns[i]), i);
+
+		for (size_t at = 0; at < TESTBUFF_SIZE;)
+		{
+			seed = seed * 1103515245 + 12345;
+
+			size_t len = (seed >> 16) % 7 == 0 ? PATTERN_SEARCH_SLICE_SIZE * 3 : (seed >> 16) % 64;
+			len = len < TESTBUFF_SIZE - at ? len : TESTBUFF_SIZE - at;
+
+			scanner.Feed(buff + at, len);
+			at += len;
+		}
+
+		CHECK_EQ(scanner.Offset(), TESTBUFF_SIZE);
+
+		for (size_t i = 0; i < count; i++)
+			CHECK(scanner.Results(i) == expected[i]);
+
+		// Reported ascending across patterns trimmed differently, aborting stops the piece
+
+		scanner.Reset();
+
+		U64 last = 0;
+		size_t lastIdx = 0;
+		size_t reported = 0;
+		bool bAscending = true;
+
+		CHECK(scanner.Feed(buff, TESTBUFF_SIZE, [&](size_t idx, U64 offset) {
+			bAscending = bAscending && (reported == 0 || offset > last || (offset == last && idx > lastIdx));
+			last = offset;
+			lastIdx = idx;
+			reported++;
+			return true;
+			}));
+
+		CHECK(bAscending);
+		CHECK_EQ(reported, expected[0].size() + (count > 1 ? expected[1].size() + expected[2].size() + expected[3].size() : 0));
+
+		scanner.Reset();
+		reported = 0;
+
+		CHECK_FALSE(scanner.Feed(buff, TESTBUFF_SIZE, [&](size_t, U64) {
+			return ++reported < 5;
+			}));
+
+		CHECK_EQ(reported, 5);
+	}
+
+	StreamScanner compiled;
+	compiled.AddPattern(TBS_COMPILED_PATTERN("0A 0B ? 0C 0D"));
+	compiled.Feed(buff, TESTBUFF_SIZE / 2);
+	compiled.Feed(buff + TESTBUFF_SIZE / 2, TESTBUFF_SIZE / 2);
+	CHECK(compiled.Results(0) == expected[1]);
+}